@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "eid-benchmarks/png-generator.hpp"
+
+namespace benchmarks
+{
+/*!
+ * BenchmarkCase
+ *
+ * One synthetic image to decode over and over.
+ *
+ * spec: The case written as color:bit_depth:WIDTHxHEIGHT:filter_types:compression_level:noise
+ * (e.g. rgba:8:1024x1024:all:6:16), it's what's stored in the results to rerun the same case later.
+*/
+struct BenchmarkCase
+{
+    std::string spec {};
+    PNGGeneratorOptions generator_options {};
+}; // struct BenchmarkCase
+
+/*!
+ * BenchmarkOptions
+ *
+ * warmup: Decodes made before measuring, to warm the caches, page cache and allocator up.
+ * repetitions: Decodes measured, the statistics are computed from them.
+ * work_directory: Where the generated images are written to, the decoder only reads from files.
+*/
+struct BenchmarkOptions
+{
+    uint32_t warmup { 2 };
+    uint32_t repetitions { 10 };
+    uint64_t seed { 0x5EED };
+    std::filesystem::path work_directory { std::filesystem::temp_directory_path() };
+}; // struct BenchmarkOptions
+
+/*!
+ * StageResult
+ *
+ * Statistics of one stage across all repetitions.
+ *
+ * bytes: Bytes the stage processed in one decode, throughput is bytes / time.
+ * MB are 10⁶ bytes, p99 is the 99th percentile of the time (nearest rank),
+ * so its throughputs are the slow end of the measurements.
+*/
+struct StageResult
+{
+    std::string stage {};
+    uint64_t bytes { 0 };
+    std::chrono::nanoseconds median { 0 };
+    std::chrono::nanoseconds p99 { 0 };
+    double median_mb_per_s { 0.0 };
+    double p99_mb_per_s { 0.0 };
+    double median_images_per_s { 0.0 };
+    double p99_images_per_s { 0.0 };
+}; // struct StageResult
+
+/*!
+ * CaseResult
+ *
+ * file_bytes: Size of the generated png.
+ * peak_memory_bytes: Highest amount of memory the decoder held at once, conversion caches included.
+*/
+struct CaseResult
+{
+    std::string spec {};
+    uint64_t file_bytes { 0 };
+    uint64_t peak_memory_bytes { 0 };
+    std::vector<StageResult> stages {};
+}; // struct CaseResult
+
+/*!
+ * parseBenchmarkCase
+ *
+ * @param spec: See BenchmarkCase, the noise field is optional.
+ * @param seed: Seed of the generator.
+ * @return: The case described by spec.
+ * @throw runtime_error if spec is malformed.
+*/
+[[nodiscard]] BenchmarkCase parseBenchmarkCase(const std::string& spec, uint64_t seed);
+
+/*!
+ * defaultBenchmarkCases
+ *
+ * @param seed: Seed of the generator.
+ * @return: Every color type and bit depth at 1024x1024, plus each filter type and compression extremes alone.
+*/
+[[nodiscard]] std::vector<BenchmarkCase> defaultBenchmarkCases(uint64_t seed);
+
+/*!
+ * runBenchmarkCase
+ *
+ * Generates the image, checks the decoder outputs exactly the generated raw data
+ * and then measures warmup + repetitions decodes.
+ *
+ * The stages measured are end_to_end (opening the file to the rgba data, as seen by the caller),
+ * decode (the decoder constructor), io, crc, inflate, defilter, rgb_conversion and rgba_conversion,
+ * the last two only when the image isn't already in that color type.
+ *
+ * @param benchmark_case: Case to run.
+ * @param options: How many times to run it.
+ * @return: The statistics of each stage.
+ * @throw runtime_error if the decoded data differs from the generated one.
+*/
+[[nodiscard]] CaseResult runBenchmarkCase(const BenchmarkCase& benchmark_case, const BenchmarkOptions& options);
+
+/*!
+ * writeResultsJSON
+ *
+ * @param stream: Where the JSON is written to.
+ * @param options: Options the cases were run with.
+ * @param results: Results of every case.
+ * @return
+*/
+void writeResultsJSON(std::ostream& stream, const BenchmarkOptions& options, const std::vector<CaseResult>& results);
+
+/*!
+ * writeResultsTable
+ *
+ * Human readable version of the results.
+ *
+ * @param stream: Where the table is written to.
+ * @param results: Results of every case.
+ * @return
+*/
+void writeResultsTable(std::ostream& stream, const std::vector<CaseResult>& results);
+} // namespace benchmarks
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "eid-benchmarks/benchmark.hpp"
+
+namespace benchmarks
+{
+/*!
+ * BenchmarkResults
+ *
+ * The options and results stored by writeResultsJSON.
+*/
+struct BenchmarkResults
+{
+    BenchmarkOptions options {};
+    std::vector<CaseResult> results {};
+}; // struct BenchmarkResults
+
+/*!
+ * RegressionThresholds
+ *
+ * How much worse than the baseline a metric may get before it counts as a regression,
+ * as a fraction (0.1 = 10%), so run to run noise doesn't fail the comparison.
+ *
+ * stages: Median MB/s of each stage checked, stages not in it are reported but never fail.
+ * peak_memory: Peak memory of each case.
+*/
+struct RegressionThresholds
+{
+    std::map<std::string, double> stages
+    {
+        { "end_to_end", 0.10 },
+        { "decode", 0.10 },
+        { "rgb_conversion", 0.10 },
+        { "rgba_conversion", 0.10 }
+    };
+
+    double peak_memory { 0.05 };
+}; // struct RegressionThresholds
+
+/*!
+ * readResultsJSON
+ *
+ * @param filepath: File written by writeResultsJSON.
+ * @return: The options and results it holds.
+ * @throw runtime_error if the file can't be read or isn't in the expected format.
+*/
+[[nodiscard]] BenchmarkResults readResultsJSON(const std::filesystem::path& filepath);
+
+/*!
+ * parseRegressionThreshold
+ *
+ * @param threshold: METRIC=PERCENT, where METRIC is a stage name or peak_memory (e.g. decode=15).
+ * @param thresholds: Where the threshold is set.
+ * @return
+ * @throw runtime_error if threshold is malformed.
+*/
+void parseRegressionThreshold(const std::string& threshold, RegressionThresholds& thresholds);
+
+/*!
+ * compareResults
+ *
+ * Writes how each metric changed from baseline to current, cases are matched by their spec.
+ *
+ * @param stream: Where the report is written to.
+ * @param baseline: Results to compare against.
+ * @param current: Results of this run.
+ * @param thresholds: How much each metric may get worse.
+ * @return: True if any checked metric regressed beyond its threshold.
+*/
+[[nodiscard]] bool compareResults
+(
+    std::ostream& stream,
+    const std::vector<CaseResult>& baseline,
+    const std::vector<CaseResult>& current,
+    const RegressionThresholds& thresholds
+);
+} // namespace benchmarks
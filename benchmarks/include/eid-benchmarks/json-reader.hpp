@@ -0,0 +1,58 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace benchmarks
+{
+/*!
+ * JSONValue
+ *
+ * Just enough JSON to read back the results written by writeResultsJSON,
+ * numbers are always doubles, and objects keep their keys sorted.
+*/
+struct JSONValue
+{
+    using Array = std::vector<JSONValue>;
+    using Object = std::map<std::string, JSONValue>;
+
+    std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value { nullptr };
+
+    /*!
+     * at
+     *
+     * @param key: Key of a member of this object.
+     * @return: The member.
+     * @throw runtime_error if this isn't an object or if there's no such member.
+    */
+    [[nodiscard]] const JSONValue& at(const std::string& key) const;
+
+    /*!
+     * contains
+     *
+     * @param key: Key of a member of this object.
+     * @return: True if this is an object and has the member.
+    */
+    [[nodiscard]] bool contains(const std::string& key) const noexcept;
+
+    /*!
+     * Accessors throwing runtime_error if the value isn't of the requested type.
+    */
+    [[nodiscard]] double asNumber() const;
+    [[nodiscard]] const std::string& asString() const;
+    [[nodiscard]] const Array& asArray() const;
+    [[nodiscard]] const Object& asObject() const;
+}; // struct JSONValue
+
+/*!
+ * parseJSON
+ *
+ * @param text: JSON document.
+ * @return: The parsed document.
+ * @throw runtime_error if text isn't valid JSON.
+*/
+[[nodiscard]] JSONValue parseJSON(const std::string& text);
+} // namespace benchmarks
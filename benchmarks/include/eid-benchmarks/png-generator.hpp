@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/typings.hpp"
+
+namespace benchmarks
+{
+/*!
+ * PNGFilterType
+ *
+ * The filter types a scanline can be filtered with, in the order of their PNG filter type byte.
+*/
+enum class PNGFilterType : uint8_t
+{
+    NONE,
+    SUB,
+    UP,
+    AVERAGE,
+    PAETH,
+}; // enum class PNGFilterType
+
+constexpr std::size_t NUMBER_OF_PNG_FILTER_TYPES { 5 };
+
+/*!
+ * PNGGeneratorOptions
+ *
+ * Describes a synthetic PNG image, the same options (seed included) always generate the same bytes.
+*/
+struct PNGGeneratorOptions
+{
+    uint32_t width { 1024 };
+    uint32_t height { 1024 };
+    utils::typings::ImageColorType color_type { utils::typings::RGBA_COLOR_TYPE };
+    uint8_t bit_depth { 8 };
+
+    /*!
+     * Filter types the scanlines may use, when more than one is enabled
+     * each scanline picks one of them at random (seeded).
+    */
+    std::array<bool, NUMBER_OF_PNG_FILTER_TYPES> filter_types { true, true, true, true, true };
+
+    /*!
+     * Zlib compression level, 0 (stored) to 9 (best compression).
+    */
+    int compression_level { 6 };
+
+    /*!
+     * How much random noise is added on top of the gradients, 0 (smooth, compresses a lot)
+     * to 255 (pure noise, barely compresses).
+    */
+    uint8_t noise { 16 };
+
+    /*!
+     * Maximum size of each IDAT chunk, the compressed stream is split among as many as needed.
+    */
+    uint32_t idat_chunk_size { 8192 };
+
+    uint64_t seed { 0x5EED };
+}; // struct PNGGeneratorOptions
+
+/*!
+ * GeneratedPNG
+ *
+ * png: The encoded file.
+ * raw_data: The scanlines without their filter type byte, what a decoder must output
+ * before any conversion (16 bit samples in network byte order, low bit depths packed).
+*/
+struct GeneratedPNG
+{
+    std::vector<uint8_t> png {};
+    std::vector<uint8_t> raw_data {};
+}; // struct GeneratedPNG
+
+/*!
+ * generatePNG
+ *
+ * @param options: The image to generate.
+ * @return: The generated png and its raw data.
+ * @throw runtime_error if the color type and bit depth combination isn't valid or if zlib fails.
+*/
+[[nodiscard]] GeneratedPNG generatePNG(const PNGGeneratorOptions& options);
+
+/*!
+ * parseFilterTypes
+ *
+ * @param filter_types: Filter types joined by '+' (none+sub+up+average+paeth) or "all".
+ * @return: Which filter types are enabled.
+ * @throw runtime_error if a filter type name is unknown.
+*/
+[[nodiscard]] std::array<bool, NUMBER_OF_PNG_FILTER_TYPES> parseFilterTypes(const std::string& filter_types);
+
+/*!
+ * filterTypesToString
+ *
+ * @param filter_types: Which filter types are enabled.
+ * @return: The enabled filter types joined by '+', or "all".
+*/
+[[nodiscard]] std::string filterTypesToString(const std::array<bool, NUMBER_OF_PNG_FILTER_TYPES>& filter_types);
+
+/*!
+ * parseColorType
+ *
+ * @param color_type: One of gray, rgb, indexed, gray-alpha or rgba.
+ * @return: The color type.
+ * @throw runtime_error if the name is unknown.
+*/
+[[nodiscard]] utils::typings::ImageColorType parseColorType(const std::string& color_type);
+
+/*!
+ * colorTypeToString
+ *
+ * @param color_type: A valid color type.
+ * @return: Its name as accepted by parseColorType.
+*/
+[[nodiscard]] std::string colorTypeToString(utils::typings::ImageColorType color_type);
+} // namespace benchmarks
@@ -0,0 +1,393 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+#include "eid-benchmarks/benchmark.hpp"
+#include "image-decoder/image-decoder.hpp"
+
+namespace benchmarks
+{
+namespace
+{
+/*!
+ * StageSamples
+ *
+ * Time of a stage in each repetition, and how many bytes it processed (the same in every repetition).
+*/
+struct StageSamples
+{
+    const char* stage { nullptr };
+    uint64_t bytes { 0 };
+    std::vector<std::chrono::nanoseconds> times {};
+}; // struct StageSamples
+
+std::vector<std::string> splitString(const std::string& string, char delimiter)
+{
+    std::vector<std::string> fields;
+    std::size_t begin { 0 };
+
+    while (true)
+    {
+        const std::size_t end { string.find(delimiter, begin) };
+
+        fields.push_back(string.substr(begin, end - begin));
+
+        if (end == std::string::npos) { break; }
+
+        begin = end + 1;
+    }
+
+    return fields;
+} // splitString
+
+uint32_t parseUnsigned(const std::string& field, const char* what)
+{
+    std::size_t parsed { 0 };
+    unsigned long value { 0 };
+
+    try
+    {
+        value = std::stoul(field, &parsed);
+    } catch (const std::exception&)
+    {
+        parsed = 0;
+    }
+
+    if (not parsed or parsed != field.size() or value > UINT32_MAX)
+    {
+        throw std::runtime_error(__func__ + std::string("\nInvalid ") + what + ": " + field + "\n");
+    }
+
+    return static_cast<uint32_t>(value);
+} // parseUnsigned
+
+std::string benchmarkCaseSpec(const PNGGeneratorOptions& generator_options)
+{
+    return
+        colorTypeToString(generator_options.color_type)
+        + ":" + std::to_string(generator_options.bit_depth)
+        + ":" + std::to_string(generator_options.width) + "x" + std::to_string(generator_options.height)
+        + ":" + filterTypesToString(generator_options.filter_types)
+        + ":" + std::to_string(generator_options.compression_level)
+        + ":" + std::to_string(generator_options.noise);
+} // benchmarkCaseSpec
+
+/*!
+ * percentile
+ *
+ * Nearest rank percentile, times must be sorted.
+*/
+std::chrono::nanoseconds percentile(const std::vector<std::chrono::nanoseconds>& times, double fraction)
+{
+    const std::size_t rank { static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(times.size()))) };
+
+    return times[std::clamp<std::size_t>(rank, 1, times.size()) - 1];
+} // percentile
+
+double perSecond(double amount, std::chrono::nanoseconds time) noexcept
+{
+    if (time.count() <= 0) { return 0.0; }
+
+    return amount * 1e9 / static_cast<double>(time.count());
+} // perSecond
+
+StageResult computeStageResult(StageSamples& samples)
+{
+    std::sort(samples.times.begin(), samples.times.end());
+
+    StageResult stage_result {};
+
+    stage_result.stage = samples.stage;
+    stage_result.bytes = samples.bytes;
+    stage_result.median = percentile(samples.times, 0.5);
+    stage_result.p99 = percentile(samples.times, 0.99);
+    stage_result.median_mb_per_s = perSecond(static_cast<double>(samples.bytes) / 1e6, stage_result.median);
+    stage_result.p99_mb_per_s = perSecond(static_cast<double>(samples.bytes) / 1e6, stage_result.p99);
+    stage_result.median_images_per_s = perSecond(1.0, stage_result.median);
+    stage_result.p99_images_per_s = perSecond(1.0, stage_result.p99);
+
+    return stage_result;
+} // computeStageResult
+
+void verifyDecodedData(const std::filesystem::path& filepath, const GeneratedPNG& generated_png)
+{
+    image_decoder::ImageDecoder decoder(filepath);
+    const utils::typings::BytesView raw_data { decoder.getRawDataView() };
+
+    if
+    (
+        raw_data.size() != generated_png.raw_data.size()
+        or std::memcmp(raw_data.data(), generated_png.raw_data.data(), raw_data.size()) != 0
+    )
+    {
+        throw std::runtime_error
+        (
+            __func__ + std::string("\nDecoded data differs from the generated one: ") + filepath.string() + "\n"
+        );
+    }
+} // verifyDecodedData
+
+void writeJSONString(std::ostream& stream, const std::string& string)
+{
+    stream << '"';
+
+    for (const char character : string)
+    {
+        if (character == '"' or character == '\\') { stream << '\\'; }
+
+        stream << character;
+    }
+
+    stream << '"';
+} // writeJSONString
+} // namespace
+
+BenchmarkCase parseBenchmarkCase(const std::string& spec, uint64_t seed)
+{
+    const std::vector<std::string> fields { splitString(spec, ':') };
+
+    if (fields.size() != 5 and fields.size() != 6)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nExpected color:bit_depth:WIDTHxHEIGHT:filter_types:compression_level[:noise], got: ")
+            + spec + "\n"
+        );
+    }
+
+    const std::vector<std::string> dimensions { splitString(fields[2], 'x') };
+
+    if (dimensions.size() != 2)
+    {
+        throw std::runtime_error(__func__ + std::string("\nExpected WIDTHxHEIGHT, got: ") + fields[2] + "\n");
+    }
+
+    BenchmarkCase benchmark_case {};
+    PNGGeneratorOptions& generator_options { benchmark_case.generator_options };
+
+    generator_options.color_type = parseColorType(fields[0]);
+    generator_options.bit_depth = static_cast<uint8_t>(parseUnsigned(fields[1], "bit depth"));
+    generator_options.width = parseUnsigned(dimensions[0], "width");
+    generator_options.height = parseUnsigned(dimensions[1], "height");
+    generator_options.filter_types = parseFilterTypes(fields[3]);
+    generator_options.compression_level = static_cast<int>(parseUnsigned(fields[4], "compression level"));
+    generator_options.seed = seed;
+
+    if (fields.size() == 6)
+    {
+        generator_options.noise = static_cast<uint8_t>(std::min(255u, parseUnsigned(fields[5], "noise")));
+    }
+
+    benchmark_case.spec = benchmarkCaseSpec(generator_options);
+
+    return benchmark_case;
+} // parseBenchmarkCase
+
+std::vector<BenchmarkCase> defaultBenchmarkCases(uint64_t seed)
+{
+    const std::vector<std::string> specs
+    {
+        "gray:1:1024x1024:all:6",
+        "gray:8:1024x1024:all:6",
+        "gray:16:1024x1024:all:6",
+        "indexed:2:1024x1024:all:6",
+        "indexed:8:1024x1024:all:6",
+        "gray-alpha:8:1024x1024:all:6",
+        "rgb:8:1024x1024:all:6",
+        "rgb:16:1024x1024:all:6",
+        "rgba:8:1024x1024:all:6",
+        "rgba:16:1024x1024:all:6",
+        "rgba:8:1024x1024:none:6",
+        "rgba:8:1024x1024:sub:6",
+        "rgba:8:1024x1024:up:6",
+        "rgba:8:1024x1024:average:6",
+        "rgba:8:1024x1024:paeth:6",
+        "rgba:8:1024x1024:all:1",
+        "rgba:8:1024x1024:all:9"
+    };
+
+    std::vector<BenchmarkCase> benchmark_cases;
+
+    for (const auto& spec : specs) { benchmark_cases.push_back(parseBenchmarkCase(spec, seed)); }
+
+    return benchmark_cases;
+} // defaultBenchmarkCases
+
+CaseResult runBenchmarkCase(const BenchmarkCase& benchmark_case, const BenchmarkOptions& options)
+{
+    const GeneratedPNG generated_png { generatePNG(benchmark_case.generator_options) };
+
+    std::string filename { benchmark_case.spec };
+
+    std::replace(filename.begin(), filename.end(), ':', '_');
+
+    const std::filesystem::path filepath { options.work_directory / ("eid-benchmark-" + filename + ".png") };
+
+    {
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(generated_png.png.data()), static_cast<std::streamsize>(generated_png.png.size()));
+
+        if (not file.good())
+        {
+            throw std::runtime_error(__func__ + std::string("\nFailed to write: ") + filepath.string() + "\n");
+        }
+    }
+
+    verifyDecodedData(filepath, generated_png);
+
+    enum StageIndex
+    {
+        END_TO_END, DECODE, IO, CRC, INFLATE, DEFILTER, RGB_CONVERSION, RGBA_CONVERSION, NUMBER_OF_STAGES
+    };
+
+    std::array<StageSamples, NUMBER_OF_STAGES> samples
+    {
+        StageSamples { .stage = "end_to_end" },
+        StageSamples { .stage = "decode" },
+        StageSamples { .stage = "io" },
+        StageSamples { .stage = "crc" },
+        StageSamples { .stage = "inflate" },
+        StageSamples { .stage = "defilter" },
+        StageSamples { .stage = "rgb_conversion" },
+        StageSamples { .stage = "rgba_conversion" }
+    };
+
+    CaseResult case_result {};
+    utils::typings::DecodeOptions decode_options {};
+
+    decode_options.collect_decode_stats = true;
+    case_result.spec = benchmark_case.spec;
+    case_result.file_bytes = generated_png.png.size();
+
+    for (uint32_t i = 0; i < options.warmup + options.repetitions; ++i)
+    {
+        const auto start { std::chrono::steady_clock::now() };
+
+        image_decoder::ImageDecoder decoder(filepath, decode_options);
+        [[maybe_unused]] const utils::typings::BytesView rgba_data { decoder.getRawDataRGBAView() };
+
+        const auto end { std::chrono::steady_clock::now() };
+
+        // Out of the end to end time, its cost is recorded by the rgb_conversion stage.
+        [[maybe_unused]] const utils::typings::BytesView rgb_data { decoder.getRawDataRGBView() };
+
+        const utils::DecodeStats decode_stats { decoder.getDecodeStats() };
+
+        case_result.peak_memory_bytes = std::max(case_result.peak_memory_bytes, decoder.getMemoryStats().total.peak_bytes);
+
+        if (i < options.warmup) { continue; }
+
+        const std::array<std::pair<std::chrono::nanoseconds, uint64_t>, NUMBER_OF_STAGES> measurements
+        {
+            std::pair { std::chrono::duration_cast<std::chrono::nanoseconds>(end - start), uint64_t(decoder.getImageRGBAScanlinesSize()) },
+            std::pair { decode_stats.total_decode, decode_stats.defiltered_bytes },
+            std::pair { decode_stats.io, decode_stats.io_bytes },
+            std::pair { decode_stats.crc, decode_stats.crc_bytes },
+            std::pair { decode_stats.inflate, decode_stats.inflated_bytes },
+            std::pair { decode_stats.defilter, decode_stats.defiltered_bytes },
+            std::pair { decode_stats.rgb_conversion, decode_stats.rgb_converted_bytes },
+            std::pair { decode_stats.rgba_conversion, decode_stats.rgba_converted_bytes }
+        };
+
+        for (std::size_t stage = 0; stage < NUMBER_OF_STAGES; ++stage)
+        {
+            samples[stage].times.push_back(measurements[stage].first);
+            samples[stage].bytes = measurements[stage].second;
+        }
+    }
+
+    std::filesystem::remove(filepath);
+
+    for (auto& stage_samples : samples)
+    {
+        // A conversion to the color type the image already is in doesn't happen.
+        if (stage_samples.times.empty() or not stage_samples.bytes) { continue; }
+
+        case_result.stages.push_back(computeStageResult(stage_samples));
+    }
+
+    return case_result;
+} // runBenchmarkCase
+
+void writeResultsJSON(std::ostream& stream, const BenchmarkOptions& options, const std::vector<CaseResult>& results)
+{
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\n";
+    stream << "  \"warmup\": " << options.warmup << ",\n";
+    stream << "  \"repetitions\": " << options.repetitions << ",\n";
+    stream << "  \"seed\": " << options.seed << ",\n";
+    stream << "  \"cases\": [";
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const CaseResult& case_result { results[i] };
+
+        stream << (i ? ",\n" : "\n") << "    {\n";
+        stream << "      \"spec\": ";
+        writeJSONString(stream, case_result.spec);
+        stream << ",\n";
+        stream << "      \"file_bytes\": " << case_result.file_bytes << ",\n";
+        stream << "      \"peak_memory_bytes\": " << case_result.peak_memory_bytes << ",\n";
+        stream << "      \"stages\": {";
+
+        for (std::size_t j = 0; j < case_result.stages.size(); ++j)
+        {
+            const StageResult& stage_result { case_result.stages[j] };
+
+            stream << (j ? ",\n" : "\n") << "        ";
+            writeJSONString(stream, stage_result.stage);
+            stream
+            << ": {"
+            << "\"bytes\": " << stage_result.bytes
+            << ", \"median_ns\": " << stage_result.median.count()
+            << ", \"p99_ns\": " << stage_result.p99.count()
+            << ", \"median_mb_per_s\": " << stage_result.median_mb_per_s
+            << ", \"p99_mb_per_s\": " << stage_result.p99_mb_per_s
+            << ", \"median_images_per_s\": " << stage_result.median_images_per_s
+            << ", \"p99_images_per_s\": " << stage_result.p99_images_per_s
+            << "}";
+        }
+
+        stream << "\n      }\n    }";
+    }
+
+    stream << "\n  ]\n}\n";
+} // writeResultsJSON
+
+void writeResultsTable(std::ostream& stream, const std::vector<CaseResult>& results)
+{
+    stream << std::fixed << std::setprecision(1);
+
+    for (const CaseResult& case_result : results)
+    {
+        stream
+        << case_result.spec << " (" << case_result.file_bytes << " bytes file, "
+        << case_result.peak_memory_bytes << " bytes peak memory)\n";
+
+        stream
+        << "  " << std::left << std::setw(18) << "stage"
+        << std::right << std::setw(14) << "median MB/s"
+        << std::setw(14) << "p99 MB/s"
+        << std::setw(16) << "median img/s"
+        << std::setw(14) << "p99 img/s" << "\n";
+
+        for (const StageResult& stage_result : case_result.stages)
+        {
+            stream
+            << "  " << std::left << std::setw(18) << stage_result.stage
+            << std::right << std::setw(14) << stage_result.median_mb_per_s
+            << std::setw(14) << stage_result.p99_mb_per_s
+            << std::setw(16) << stage_result.median_images_per_s
+            << std::setw(14) << stage_result.p99_images_per_s << "\n";
+        }
+
+        stream << "\n";
+    }
+} // writeResultsTable
+} // namespace benchmarks
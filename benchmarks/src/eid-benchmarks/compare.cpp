@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "eid-benchmarks/compare.hpp"
+#include "eid-benchmarks/json-reader.hpp"
+
+namespace benchmarks
+{
+namespace
+{
+/*!
+ * Doubles hold integers exactly only up to 2⁵³.
+*/
+constexpr double MAX_EXACT_INTEGER { 9007199254740992.0 };
+
+uint64_t asUnsigned(const JSONValue& value, const char* what)
+{
+    const double number { value.asNumber() };
+
+    if (number < 0.0 or number > MAX_EXACT_INTEGER or number != static_cast<double>(static_cast<uint64_t>(number)))
+    {
+        throw std::runtime_error(std::string("readResultsJSON\nInvalid ") + what + ".\n");
+    }
+
+    return static_cast<uint64_t>(number);
+} // asUnsigned
+
+const StageResult* findStage(const CaseResult& case_result, const std::string& stage) noexcept
+{
+    const auto it
+    {
+        std::find_if
+        (
+            case_result.stages.begin(),
+            case_result.stages.end(),
+            [&](const StageResult& stage_result) { return stage_result.stage == stage; }
+        )
+    };
+
+    return (it == case_result.stages.end()) ? nullptr : &*it;
+} // findStage
+
+/*!
+ * writeComparison
+ *
+ * Writes one line of the report, change is positive when the metric got better
+ * (a negative zero would be printed as -0.0, so it's replaced by zero).
+*/
+void writeComparison
+(
+    std::ostream& stream,
+    const std::string& metric,
+    double baseline,
+    double current,
+    double change,
+    const char* status
+)
+{
+    stream
+    << "  " << std::left << std::setw(18) << metric
+    << std::right << std::setw(16) << baseline
+    << std::setw(16) << current
+    << std::setw(9) << std::showpos << ((change == 0.0) ? 0.0 : change * 100.0) << std::noshowpos << "%"
+    << "  " << status << "\n";
+} // writeComparison
+} // namespace
+
+BenchmarkResults readResultsJSON(const std::filesystem::path& filepath)
+{
+    std::ifstream file(filepath);
+
+    if (not file.is_open())
+    {
+        throw std::runtime_error(__func__ + std::string("\nFailed to open: ") + filepath.string() + "\n");
+    }
+
+    std::stringstream text;
+
+    text << file.rdbuf();
+
+    const JSONValue document { parseJSON(text.str()) };
+    BenchmarkResults benchmark_results {};
+
+    benchmark_results.options.warmup = static_cast<uint32_t>(asUnsigned(document.at("warmup"), "warmup"));
+    benchmark_results.options.repetitions = static_cast<uint32_t>(asUnsigned(document.at("repetitions"), "repetitions"));
+    benchmark_results.options.seed = asUnsigned(document.at("seed"), "seed");
+
+    for (const JSONValue& case_value : document.at("cases").asArray())
+    {
+        CaseResult case_result {};
+
+        case_result.spec = case_value.at("spec").asString();
+        case_result.file_bytes = asUnsigned(case_value.at("file_bytes"), "file_bytes");
+        case_result.peak_memory_bytes = asUnsigned(case_value.at("peak_memory_bytes"), "peak_memory_bytes");
+
+        for (const auto& [stage, stage_value] : case_value.at("stages").asObject())
+        {
+            StageResult stage_result {};
+
+            stage_result.stage = stage;
+            stage_result.bytes = asUnsigned(stage_value.at("bytes"), "bytes");
+            stage_result.median = std::chrono::nanoseconds(asUnsigned(stage_value.at("median_ns"), "median_ns"));
+            stage_result.p99 = std::chrono::nanoseconds(asUnsigned(stage_value.at("p99_ns"), "p99_ns"));
+            stage_result.median_mb_per_s = stage_value.at("median_mb_per_s").asNumber();
+            stage_result.p99_mb_per_s = stage_value.at("p99_mb_per_s").asNumber();
+            stage_result.median_images_per_s = stage_value.at("median_images_per_s").asNumber();
+            stage_result.p99_images_per_s = stage_value.at("p99_images_per_s").asNumber();
+
+            case_result.stages.push_back(std::move(stage_result));
+        }
+
+        benchmark_results.results.push_back(std::move(case_result));
+    }
+
+    return benchmark_results;
+} // readResultsJSON
+
+void parseRegressionThreshold(const std::string& threshold, RegressionThresholds& thresholds)
+{
+    const std::size_t separator { threshold.find('=') };
+    double percent { -1.0 };
+
+    if (separator != std::string::npos)
+    {
+        try
+        {
+            std::size_t parsed { 0 };
+            const std::string value { threshold.substr(separator + 1) };
+
+            percent = std::stod(value, &parsed);
+
+            if (parsed != value.size()) { percent = -1.0; }
+        } catch (const std::exception&)
+        {
+            percent = -1.0;
+        }
+    }
+
+    if (not separator or percent < 0.0)
+    {
+        throw std::runtime_error(__func__ + std::string("\nExpected METRIC=PERCENT, got: ") + threshold + "\n");
+    }
+
+    const std::string metric { threshold.substr(0, separator) };
+
+    if (metric == "peak_memory")
+    {
+        thresholds.peak_memory = percent / 100.0;
+
+        return;
+    }
+
+    thresholds.stages[metric] = percent / 100.0;
+} // parseRegressionThreshold
+
+bool compareResults
+(
+    std::ostream& stream,
+    const std::vector<CaseResult>& baseline,
+    const std::vector<CaseResult>& current,
+    const RegressionThresholds& thresholds
+)
+{
+    bool regressed { false };
+
+    stream << std::fixed << std::setprecision(1);
+
+    for (const CaseResult& current_case : current)
+    {
+        const auto baseline_case
+        {
+            std::find_if
+            (
+                baseline.begin(),
+                baseline.end(),
+                [&](const CaseResult& case_result) { return case_result.spec == current_case.spec; }
+            )
+        };
+
+        if (baseline_case == baseline.end())
+        {
+            stream << current_case.spec << ": not in the baseline, skipped.\n\n";
+            continue;
+        }
+
+        stream << current_case.spec << "\n";
+        stream
+        << "  " << std::left << std::setw(18) << "metric"
+        << std::right << std::setw(16) << "baseline"
+        << std::setw(16) << "current"
+        << std::setw(10) << "change" << "\n";
+
+        for (const StageResult& current_stage : current_case.stages)
+        {
+            const StageResult* baseline_stage { findStage(*baseline_case, current_stage.stage) };
+
+            if (not baseline_stage or baseline_stage->median_mb_per_s <= 0.0) { continue; }
+
+            // Throughput regresses when it goes down.
+            const double change { current_stage.median_mb_per_s / baseline_stage->median_mb_per_s - 1.0 };
+            const auto threshold { thresholds.stages.find(current_stage.stage) };
+            const char* status { "" };
+
+            if (threshold != thresholds.stages.end())
+            {
+                const bool stage_regressed { change < -threshold->second };
+
+                regressed = regressed or stage_regressed;
+                status = stage_regressed ? "REGRESSION" : "ok";
+            }
+
+            writeComparison
+            (
+                stream,
+                current_stage.stage + " MB/s",
+                baseline_stage->median_mb_per_s,
+                current_stage.median_mb_per_s,
+                change,
+                status
+            );
+        }
+
+        if (baseline_case->peak_memory_bytes)
+        {
+            // Memory regresses when it goes up, the change is negated so positive still means better.
+            const double change
+            {
+                static_cast<double>(current_case.peak_memory_bytes)
+                / static_cast<double>(baseline_case->peak_memory_bytes) - 1.0
+            };
+            const bool memory_regressed { change > thresholds.peak_memory };
+
+            regressed = regressed or memory_regressed;
+
+            writeComparison
+            (
+                stream,
+                "peak memory KiB",
+                static_cast<double>(baseline_case->peak_memory_bytes) / 1024.0,
+                static_cast<double>(current_case.peak_memory_bytes) / 1024.0,
+                -change,
+                memory_regressed ? "REGRESSION" : "ok"
+            );
+        }
+
+        stream << "\n";
+    }
+
+    return regressed;
+} // compareResults
+} // namespace benchmarks
@@ -0,0 +1,163 @@
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "eid-benchmarks/benchmark.hpp"
+#include "eid-benchmarks/compare.hpp"
+
+namespace
+{
+// Tells a regression apart from a failure to run the benchmarks (EXIT_FAILURE).
+constexpr int REGRESSION_EXIT_CODE { 2 };
+
+void printUsage(const char* program)
+{
+    std::cout
+    << "Usage: " << program << " [options]\n\n"
+    << "Decodes synthetic png images and reports the throughput of each decoding stage.\n\n"
+    << "Options:\n"
+    << "  --case SPEC             Case to run, can be repeated, replaces the default cases.\n"
+    << "                          SPEC is color:bit_depth:WIDTHxHEIGHT:filter_types:compression_level[:noise]\n"
+    << "                          color: gray, rgb, indexed, gray-alpha or rgba\n"
+    << "                          filter_types: all, or none, sub, up, average, paeth joined by '+'\n"
+    << "                          e.g. rgba:8:1024x1024:sub+paeth:6\n"
+    << "  --warmup N              Decodes made before measuring (default 2).\n"
+    << "  --repetitions N         Decodes measured (default 10).\n"
+    << "  --seed N                Seed of the image generator (default 24301).\n"
+    << "  --output FILE           Writes the results as JSON to FILE.\n"
+    << "  --work-directory DIR    Where the generated images are written to (default the temp directory).\n"
+    << "  --compare FILE          Reruns the cases of a JSON written by --output, with its seed, warmup and\n"
+    << "                          repetitions (unless given), and exits with 2 if any checked metric regressed.\n"
+    << "  --threshold METRIC=PCT  How many percent a metric may get worse before --compare fails, can be repeated.\n"
+    << "                          METRIC is a stage name (checks its median MB/s) or peak_memory.\n"
+    << "                          Defaults: end_to_end, decode, rgb_conversion and rgba_conversion 10, peak_memory 5.\n"
+    << "  --help                  Shows this message.\n";
+} // printUsage
+
+uint64_t parseNumber(const std::string& argument, const std::string& option)
+{
+    try
+    {
+        std::size_t parsed { 0 };
+        const uint64_t value { std::stoull(argument, &parsed) };
+
+        if (parsed == argument.size()) { return value; }
+    } catch (const std::exception&) {}
+
+    throw std::runtime_error("Invalid value for " + option + ": " + argument + "\n");
+} // parseNumber
+} // namespace
+
+int main(int argc, const char** argv)
+{
+    benchmarks::BenchmarkOptions options {};
+    benchmarks::RegressionThresholds thresholds {};
+    std::vector<std::string> specs;
+    std::string output_filepath;
+    std::string baseline_filepath;
+    std::optional<uint32_t> warmup;
+    std::optional<uint32_t> repetitions;
+    std::optional<uint64_t> seed;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string option { argv[i] };
+
+            if (option == "--help")
+            {
+                printUsage(argv[0]);
+
+                return EXIT_SUCCESS;
+            }
+
+            if (i + 1 >= argc) { throw std::runtime_error("Missing value for " + option + "\n"); }
+
+            const std::string argument { argv[++i] };
+
+            if (option == "--case")                 { specs.push_back(argument); }
+            else if (option == "--warmup")          { warmup = static_cast<uint32_t>(parseNumber(argument, option)); }
+            else if (option == "--repetitions")     { repetitions = static_cast<uint32_t>(parseNumber(argument, option)); }
+            else if (option == "--seed")            { seed = parseNumber(argument, option); }
+            else if (option == "--output")          { output_filepath = argument; }
+            else if (option == "--work-directory")  { options.work_directory = argument; }
+            else if (option == "--compare")         { baseline_filepath = argument; }
+            else if (option == "--threshold")       { benchmarks::parseRegressionThreshold(argument, thresholds); }
+            else { throw std::runtime_error("Unknown option: " + option + "\n"); }
+        }
+
+        benchmarks::BenchmarkResults baseline {};
+
+        if (not baseline_filepath.empty())
+        {
+            if (not specs.empty()) { throw std::runtime_error("--case can't be used with --compare.\n"); }
+
+            baseline = benchmarks::readResultsJSON(baseline_filepath);
+            options.warmup = baseline.options.warmup;
+            options.repetitions = baseline.options.repetitions;
+            options.seed = baseline.options.seed;
+
+            for (const auto& case_result : baseline.results) { specs.push_back(case_result.spec); }
+        }
+
+        options.warmup = warmup.value_or(options.warmup);
+        options.repetitions = repetitions.value_or(options.repetitions);
+        options.seed = seed.value_or(options.seed);
+
+        if (not options.repetitions) { throw std::runtime_error("At least one repetition is needed.\n"); }
+
+        std::vector<benchmarks::BenchmarkCase> benchmark_cases;
+
+        if (specs.empty() and baseline_filepath.empty())
+        {
+            benchmark_cases = benchmarks::defaultBenchmarkCases(options.seed);
+        } else
+        {
+            for (const auto& spec : specs) { benchmark_cases.push_back(benchmarks::parseBenchmarkCase(spec, options.seed)); }
+        }
+
+        std::vector<benchmarks::CaseResult> results;
+
+        for (const auto& benchmark_case : benchmark_cases)
+        {
+            results.push_back(benchmarks::runBenchmarkCase(benchmark_case, options));
+            benchmarks::writeResultsTable(std::cout, { results.back() });
+        }
+
+        if (not output_filepath.empty())
+        {
+            std::ofstream output(output_filepath, std::ios::trunc);
+
+            benchmarks::writeResultsJSON(output, options, results);
+
+            if (not output.good()) { throw std::runtime_error("Failed to write: " + output_filepath + "\n"); }
+        }
+
+        if (not baseline_filepath.empty())
+        {
+            std::cout << "Comparison against " << baseline_filepath << ":\n\n";
+
+            if (benchmarks::compareResults(std::cout, baseline.results, results, thresholds))
+            {
+                std::cout << "Regressions found.\n";
+
+                return REGRESSION_EXIT_CODE;
+            }
+
+            std::cout << "No regressions found.\n";
+        }
+    } catch (const std::exception& e)
+    {
+        std::cerr << e.what();
+        printUsage(argv[0]);
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
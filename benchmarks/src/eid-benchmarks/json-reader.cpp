@@ -0,0 +1,276 @@
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+
+#include "eid-benchmarks/json-reader.hpp"
+
+namespace benchmarks
+{
+namespace
+{
+/*!
+ * JSONParser
+ *
+ * Recursive descent parser, \u escapes outside of ASCII aren't supported,
+ * the results never contain them.
+*/
+class JSONParser
+{
+public:
+    explicit JSONParser(const std::string& text) noexcept : m_text(text) {}
+
+    JSONValue parseDocument()
+    {
+        JSONValue value { parseValue() };
+
+        skipWhitespace();
+
+        if (m_position != m_text.size()) { fail("Unexpected trailing characters"); }
+
+        return value;
+    }
+
+private:
+    [[noreturn]] void fail(const std::string& message) const
+    {
+        throw std::runtime_error
+        (
+            std::string("parseJSON\n") + message + " at offset " + std::to_string(m_position) + ".\n"
+        );
+    }
+
+    void skipWhitespace() noexcept
+    {
+        while (m_position < m_text.size() and std::isspace(static_cast<unsigned char>(m_text[m_position])))
+        {
+            ++m_position;
+        }
+    }
+
+    char peek()
+    {
+        skipWhitespace();
+
+        if (m_position >= m_text.size()) { fail("Unexpected end of document"); }
+
+        return m_text[m_position];
+    }
+
+    void expect(char character)
+    {
+        if (peek() != character) { fail(std::string("Expected '") + character + "'"); }
+
+        ++m_position;
+    }
+
+    bool consumeLiteral(const char* literal)
+    {
+        const std::string_view view { literal };
+
+        if (m_text.compare(m_position, view.size(), view) != 0) { return false; }
+
+        m_position += view.size();
+
+        return true;
+    }
+
+    JSONValue parseValue()
+    {
+        const char character { peek() };
+
+        if (character == '{') { return parseObject(); }
+        if (character == '[') { return parseArray(); }
+        if (character == '"') { return JSONValue { parseString() }; }
+        if (consumeLiteral("true")) { return JSONValue { true }; }
+        if (consumeLiteral("false")) { return JSONValue { false }; }
+        if (consumeLiteral("null")) { return JSONValue { nullptr }; }
+
+        return parseNumber();
+    }
+
+    JSONValue parseNumber()
+    {
+        const char* begin { m_text.c_str() + m_position };
+        char* end { nullptr };
+        const double number { std::strtod(begin, &end) };
+
+        if (end == begin) { fail("Expected a value"); }
+
+        m_position += static_cast<std::size_t>(end - begin);
+
+        return JSONValue { number };
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+
+        std::string string;
+
+        while (true)
+        {
+            if (m_position >= m_text.size()) { fail("Unterminated string"); }
+
+            const char character { m_text[m_position++] };
+
+            if (character == '"') { return string; }
+
+            if (character != '\\')
+            {
+                string += character;
+                continue;
+            }
+
+            if (m_position >= m_text.size()) { fail("Unterminated string"); }
+
+            const char escaped { m_text[m_position++] };
+
+            switch (escaped)
+            {
+                case '"':   string += '"';  break;
+                case '\\':  string += '\\'; break;
+                case '/':   string += '/';  break;
+                case 'b':   string += '\b'; break;
+                case 'f':   string += '\f'; break;
+                case 'n':   string += '\n'; break;
+                case 'r':   string += '\r'; break;
+                case 't':   string += '\t'; break;
+                case 'u':
+                {
+                    if (m_position + 4 > m_text.size()) { fail("Truncated \\u escape"); }
+
+                    const unsigned long code_point { std::stoul(m_text.substr(m_position, 4), nullptr, 16) };
+
+                    if (code_point > 0x7F) { fail("Non ASCII \\u escapes aren't supported"); }
+
+                    string += static_cast<char>(code_point);
+                    m_position += 4;
+
+                    break;
+                }
+                default: fail("Invalid escape");
+            }
+        }
+    }
+
+    JSONValue parseArray()
+    {
+        expect('[');
+
+        JSONValue::Array array;
+
+        if (peek() == ']')
+        {
+            ++m_position;
+
+            return JSONValue { std::move(array) };
+        }
+
+        while (true)
+        {
+            array.push_back(parseValue());
+
+            if (peek() == ']')
+            {
+                ++m_position;
+
+                return JSONValue { std::move(array) };
+            }
+
+            expect(',');
+        }
+    }
+
+    JSONValue parseObject()
+    {
+        expect('{');
+
+        JSONValue::Object object;
+
+        if (peek() == '}')
+        {
+            ++m_position;
+
+            return JSONValue { std::move(object) };
+        }
+
+        while (true)
+        {
+            if (peek() != '"') { fail("Expected a key"); }
+
+            std::string key { parseString() };
+
+            expect(':');
+            object.insert_or_assign(std::move(key), parseValue());
+
+            if (peek() == '}')
+            {
+                ++m_position;
+
+                return JSONValue { std::move(object) };
+            }
+
+            expect(',');
+        }
+    }
+
+private:
+    const std::string& m_text;
+    std::size_t m_position { 0 };
+}; // class JSONParser
+} // namespace
+
+const JSONValue& JSONValue::at(const std::string& key) const
+{
+    const Object& object { asObject() };
+    const auto it { object.find(key) };
+
+    if (it == object.end())
+    {
+        throw std::runtime_error(__func__ + std::string("\nMissing JSON member: ") + key + "\n");
+    }
+
+    return it->second;
+} // JSONValue::at
+
+bool JSONValue::contains(const std::string& key) const noexcept
+{
+    const Object* object { std::get_if<Object>(&value) };
+
+    return object and object->contains(key);
+} // JSONValue::contains
+
+double JSONValue::asNumber() const
+{
+    if (const double* number = std::get_if<double>(&value)) { return *number; }
+
+    throw std::runtime_error(__func__ + std::string("\nJSON value isn't a number.\n"));
+} // JSONValue::asNumber
+
+const std::string& JSONValue::asString() const
+{
+    if (const std::string* string = std::get_if<std::string>(&value)) { return *string; }
+
+    throw std::runtime_error(__func__ + std::string("\nJSON value isn't a string.\n"));
+} // JSONValue::asString
+
+const JSONValue::Array& JSONValue::asArray() const
+{
+    if (const Array* array = std::get_if<Array>(&value)) { return *array; }
+
+    throw std::runtime_error(__func__ + std::string("\nJSON value isn't an array.\n"));
+} // JSONValue::asArray
+
+const JSONValue::Object& JSONValue::asObject() const
+{
+    if (const Object* object = std::get_if<Object>(&value)) { return *object; }
+
+    throw std::runtime_error(__func__ + std::string("\nJSON value isn't an object.\n"));
+} // JSONValue::asObject
+
+JSONValue parseJSON(const std::string& text)
+{
+    return JSONParser(text).parseDocument();
+} // parseJSON
+} // namespace benchmarks
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <zlib.h>
+
+#include "eid-benchmarks/png-generator.hpp"
+
+namespace benchmarks
+{
+namespace
+{
+constexpr std::array<const char*, NUMBER_OF_PNG_FILTER_TYPES> FILTER_TYPE_NAMES
+{
+    "none",
+    "sub",
+    "up",
+    "average",
+    "paeth"
+};
+
+/*!
+ * SplitMix64
+ *
+ * Small deterministic pseudo random generator, std::mt19937 distributions aren't guaranteed
+ * to give the same numbers across standard libraries, this one is.
+*/
+class SplitMix64
+{
+public:
+    explicit SplitMix64(uint64_t seed) noexcept : m_state(seed) {}
+
+    uint64_t next() noexcept
+    {
+        uint64_t z { m_state += 0x9E3779B97F4A7C15ULL };
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+        return z ^ (z >> 31);
+    }
+
+    uint32_t nextBelow(uint32_t bound) noexcept
+    {
+        return static_cast<uint32_t>(next() % bound);
+    }
+
+private:
+    uint64_t m_state { 0 };
+}; // class SplitMix64
+
+uint8_t pngColorTypeCode(utils::typings::ImageColorType color_type)
+{
+    switch (color_type)
+    {
+        case utils::typings::GRAYSCALE_COLOR_TYPE:              return 0x0;
+        case utils::typings::RGB_COLOR_TYPE:                    return 0x2;
+        case utils::typings::INDEXED_COLOR_TYPE:                return 0x3;
+        case utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE:    return 0x4;
+        case utils::typings::RGBA_COLOR_TYPE:                   return 0x6;
+        default: break;
+    }
+
+    throw std::runtime_error(__func__ + std::string("\nInvalid color type.\n"));
+} // pngColorTypeCode
+
+uint8_t numberOfSamples(utils::typings::ImageColorType color_type) noexcept
+{
+    return
+        (color_type == utils::typings::RGB_COLOR_TYPE)                  ? 3 :
+        (color_type == utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE)  ? 2 :
+        (color_type == utils::typings::RGBA_COLOR_TYPE)                 ? 4 :
+                                                                          1 ;
+} // numberOfSamples
+
+void validateBitDepth(utils::typings::ImageColorType color_type, uint8_t bit_depth)
+{
+    bool valid { false };
+
+    switch (color_type)
+    {
+        case utils::typings::GRAYSCALE_COLOR_TYPE:
+            valid = bit_depth == 1 or bit_depth == 2 or bit_depth == 4 or bit_depth == 8 or bit_depth == 16;
+            break;
+        case utils::typings::INDEXED_COLOR_TYPE:
+            valid = bit_depth == 1 or bit_depth == 2 or bit_depth == 4 or bit_depth == 8;
+            break;
+        default:
+            valid = bit_depth == 8 or bit_depth == 16;
+            break;
+    }
+
+    if (not valid)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nBit depth ") + std::to_string(bit_depth)
+            + " not valid for color type " + colorTypeToString(color_type) + ".\n"
+        );
+    }
+} // validateBitDepth
+
+void appendUint32(std::vector<uint8_t>& dest, uint32_t value)
+{
+    dest.push_back(static_cast<uint8_t>(value >> 24));
+    dest.push_back(static_cast<uint8_t>(value >> 16));
+    dest.push_back(static_cast<uint8_t>(value >> 8));
+    dest.push_back(static_cast<uint8_t>(value));
+} // appendUint32
+
+void appendChunk(std::vector<uint8_t>& png, const char* type, const uint8_t* data, std::size_t size)
+{
+    appendUint32(png, static_cast<uint32_t>(size));
+
+    const std::size_t type_offset { png.size() };
+
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data, data + size);
+
+    // The crc covers the chunk type and data, not the length.
+    const uLong crc { crc32(0, png.data() + type_offset, static_cast<uInt>(png.size() - type_offset)) };
+
+    appendUint32(png, static_cast<uint32_t>(crc));
+} // appendChunk
+
+uint8_t paethPredictor(uint8_t a, uint8_t b, uint8_t c) noexcept
+{
+    const int p { a + b - c };
+    const int pa { std::abs(p - a) };
+    const int pb { std::abs(p - b) };
+    const int pc { std::abs(p - c) };
+
+    if (pa <= pb and pa <= pc) { return a; }
+    if (pb <= pc) { return b; }
+
+    return c;
+} // paethPredictor
+
+/*!
+ * filterScanline
+ *
+ * Writes the filter type byte followed by the filtered scanline, the reverse of what the decoder does.
+*/
+void filterScanline
+(
+    PNGFilterType filter_type,
+    const uint8_t* scanline,
+    const uint8_t* previous_scanline,
+    uint32_t scanline_size,
+    uint32_t bytes_per_pixel,
+    std::vector<uint8_t>& dest
+)
+{
+    dest.push_back(static_cast<uint8_t>(filter_type));
+
+    for (uint32_t i = 0; i < scanline_size; ++i)
+    {
+        const uint8_t a { (i >= bytes_per_pixel) ? scanline[i - bytes_per_pixel] : uint8_t(0) };
+        const uint8_t b { previous_scanline[i] };
+        const uint8_t c { (i >= bytes_per_pixel) ? previous_scanline[i - bytes_per_pixel] : uint8_t(0) };
+        uint8_t predictor { 0 };
+
+        switch (filter_type)
+        {
+            case PNGFilterType::NONE:       predictor = 0; break;
+            case PNGFilterType::SUB:        predictor = a; break;
+            case PNGFilterType::UP:         predictor = b; break;
+            case PNGFilterType::AVERAGE:    predictor = static_cast<uint8_t>((a + b) / 2); break;
+            case PNGFilterType::PAETH:      predictor = paethPredictor(a, b, c); break;
+        }
+
+        dest.push_back(static_cast<uint8_t>(scanline[i] - predictor));
+    }
+} // filterScanline
+
+/*!
+ * writeSample
+ *
+ * Writes a sample at the sample_index position of the scanline,
+ * packing it most significant bits first for bit depths lower than 8.
+*/
+void writeSample(uint8_t* scanline, uint32_t sample_index, uint8_t bit_depth, uint16_t sample) noexcept
+{
+    if (bit_depth == 16)
+    {
+        scanline[sample_index * 2] = static_cast<uint8_t>(sample >> 8);
+        scanline[sample_index * 2 + 1] = static_cast<uint8_t>(sample);
+
+        return;
+    }
+
+    if (bit_depth == 8)
+    {
+        scanline[sample_index] = static_cast<uint8_t>(sample);
+
+        return;
+    }
+
+    const uint32_t samples_per_byte { 8u / bit_depth };
+    const uint32_t shift { (samples_per_byte - 1 - (sample_index % samples_per_byte)) * bit_depth };
+
+    scanline[sample_index / samples_per_byte] |= static_cast<uint8_t>(sample << shift);
+} // writeSample
+} // namespace
+
+GeneratedPNG generatePNG(const PNGGeneratorOptions& options)
+{
+    validateBitDepth(options.color_type, options.bit_depth);
+
+    if (not options.width or not options.height)
+    {
+        throw std::runtime_error(__func__ + std::string("\nWidth and height must be greater than zero.\n"));
+    }
+
+    if (options.compression_level < 0 or options.compression_level > 9)
+    {
+        throw std::runtime_error(__func__ + std::string("\nCompression level must be between 0 and 9.\n"));
+    }
+
+    std::vector<PNGFilterType> filter_types;
+
+    for (std::size_t i = 0; i < NUMBER_OF_PNG_FILTER_TYPES; ++i)
+    {
+        if (options.filter_types[i]) { filter_types.push_back(static_cast<PNGFilterType>(i)); }
+    }
+
+    if (filter_types.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nAt least one filter type must be enabled.\n"));
+    }
+
+    SplitMix64 random { options.seed };
+    GeneratedPNG generated_png {};
+
+    const uint8_t number_of_samples { numberOfSamples(options.color_type) };
+    const uint32_t samples_per_scanline { options.width * number_of_samples };
+    const uint32_t scanline_size { (samples_per_scanline * options.bit_depth + 7) / 8 };
+    const uint32_t bytes_per_pixel { std::max(1u, (number_of_samples * options.bit_depth) / 8u) };
+    const uint32_t noise_amplitude { options.noise * 257u };
+
+    /*!
+     * Smooth gradients with some noise on top, each sample is first made as a 16 bit value
+     * and then its most significant bits are kept for lower bit depths.
+    */
+    generated_png.raw_data.resize(static_cast<std::size_t>(scanline_size) * options.height);
+
+    for (uint32_t row = 0; row < options.height; ++row)
+    {
+        uint8_t* scanline { generated_png.raw_data.data() + static_cast<std::size_t>(row) * scanline_size };
+        const uint32_t row_gradient { static_cast<uint32_t>(uint64_t(row) * 65535 / std::max(1u, options.height - 1)) };
+
+        for (uint32_t column = 0; column < options.width; ++column)
+        {
+            const uint32_t column_gradient
+            {
+                static_cast<uint32_t>(uint64_t(column) * 65535 / std::max(1u, options.width - 1))
+            };
+
+            for (uint32_t sample = 0; sample < number_of_samples; ++sample)
+            {
+                const uint32_t noise { noise_amplitude ? random.nextBelow(noise_amplitude + 1) : 0 };
+                const uint16_t value
+                {
+                    static_cast<uint16_t>(column_gradient * (sample + 1) + row_gradient * (3 - sample % 3) + noise)
+                };
+
+                writeSample
+                (
+                    scanline,
+                    column * number_of_samples + sample,
+                    options.bit_depth,
+                    static_cast<uint16_t>(value >> (16 - options.bit_depth))
+                );
+            }
+        }
+    }
+
+    std::vector<uint8_t> filtered_data;
+    const std::vector<uint8_t> zeroed_scanline(scanline_size, 0);
+
+    filtered_data.reserve(static_cast<std::size_t>(scanline_size + 1) * options.height);
+
+    for (uint32_t row = 0; row < options.height; ++row)
+    {
+        const uint8_t* scanline { generated_png.raw_data.data() + static_cast<std::size_t>(row) * scanline_size };
+        const uint8_t* previous_scanline { row ? scanline - scanline_size : zeroed_scanline.data() };
+        const PNGFilterType filter_type
+        {
+            (filter_types.size() == 1)
+            ? filter_types.front()
+            : filter_types[random.nextBelow(static_cast<uint32_t>(filter_types.size()))]
+        };
+
+        filterScanline(filter_type, scanline, previous_scanline, scanline_size, bytes_per_pixel, filtered_data);
+    }
+
+    uLongf compressed_size { compressBound(static_cast<uLong>(filtered_data.size())) };
+    std::vector<uint8_t> compressed_data(compressed_size);
+
+    if
+    (
+        compress2
+        (
+            compressed_data.data(),
+            &compressed_size,
+            filtered_data.data(),
+            static_cast<uLong>(filtered_data.size()),
+            options.compression_level
+        ) != Z_OK
+    )
+    {
+        throw std::runtime_error(__func__ + std::string("\nFailed to compress the scanlines.\n"));
+    }
+
+    compressed_data.resize(compressed_size);
+
+    std::vector<uint8_t>& png { generated_png.png };
+    constexpr std::array<uint8_t, 8> signature { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    png.reserve(compressed_data.size() + 1024);
+    png.insert(png.end(), signature.begin(), signature.end());
+
+    std::vector<uint8_t> ihdr;
+
+    appendUint32(ihdr, options.width);
+    appendUint32(ihdr, options.height);
+    ihdr.push_back(options.bit_depth);
+    ihdr.push_back(pngColorTypeCode(options.color_type));
+    ihdr.push_back(0); // compression method
+    ihdr.push_back(0); // filter method
+    ihdr.push_back(0); // interlace method
+
+    appendChunk(png, "IHDR", ihdr.data(), ihdr.size());
+
+    if (options.color_type == utils::typings::INDEXED_COLOR_TYPE)
+    {
+        const uint32_t palette_entries { 1u << options.bit_depth };
+        std::vector<uint8_t> palette(palette_entries * 3);
+
+        for (auto& byte : palette) { byte = static_cast<uint8_t>(random.next()); }
+
+        appendChunk(png, "PLTE", palette.data(), palette.size());
+    }
+
+    const std::size_t idat_chunk_size { std::max(1u, options.idat_chunk_size) };
+
+    for (std::size_t offset = 0; offset < compressed_data.size(); offset += idat_chunk_size)
+    {
+        appendChunk
+        (
+            png,
+            "IDAT",
+            compressed_data.data() + offset,
+            std::min(idat_chunk_size, compressed_data.size() - offset)
+        );
+    }
+
+    appendChunk(png, "IEND", nullptr, 0);
+
+    return generated_png;
+} // generatePNG
+
+std::array<bool, NUMBER_OF_PNG_FILTER_TYPES> parseFilterTypes(const std::string& filter_types)
+{
+    std::array<bool, NUMBER_OF_PNG_FILTER_TYPES> enabled_filter_types {};
+
+    if (filter_types == "all")
+    {
+        enabled_filter_types.fill(true);
+
+        return enabled_filter_types;
+    }
+
+    std::size_t begin { 0 };
+
+    while (begin <= filter_types.size())
+    {
+        const std::size_t end { std::min(filter_types.find('+', begin), filter_types.size()) };
+        const std::string name { filter_types.substr(begin, end - begin) };
+        const auto it { std::find(FILTER_TYPE_NAMES.begin(), FILTER_TYPE_NAMES.end(), name) };
+
+        if (it == FILTER_TYPE_NAMES.end())
+        {
+            throw std::runtime_error(__func__ + std::string("\nUnknown filter type: ") + name + "\n");
+        }
+
+        enabled_filter_types[static_cast<std::size_t>(it - FILTER_TYPE_NAMES.begin())] = true;
+        begin = end + 1;
+    }
+
+    return enabled_filter_types;
+} // parseFilterTypes
+
+std::string filterTypesToString(const std::array<bool, NUMBER_OF_PNG_FILTER_TYPES>& filter_types)
+{
+    if (std::all_of(filter_types.begin(), filter_types.end(), [](bool enabled) { return enabled; }))
+    {
+        return "all";
+    }
+
+    std::string names;
+
+    for (std::size_t i = 0; i < NUMBER_OF_PNG_FILTER_TYPES; ++i)
+    {
+        if (not filter_types[i]) { continue; }
+        if (not names.empty()) { names += "+"; }
+
+        names += FILTER_TYPE_NAMES[i];
+    }
+
+    return names;
+} // filterTypesToString
+
+utils::typings::ImageColorType parseColorType(const std::string& color_type)
+{
+    if (color_type == "gray")       { return utils::typings::GRAYSCALE_COLOR_TYPE; }
+    if (color_type == "rgb")        { return utils::typings::RGB_COLOR_TYPE; }
+    if (color_type == "indexed")    { return utils::typings::INDEXED_COLOR_TYPE; }
+    if (color_type == "gray-alpha") { return utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE; }
+    if (color_type == "rgba")       { return utils::typings::RGBA_COLOR_TYPE; }
+
+    throw std::runtime_error(__func__ + std::string("\nUnknown color type: ") + color_type + "\n");
+} // parseColorType
+
+std::string colorTypeToString(utils::typings::ImageColorType color_type)
+{
+    switch (color_type)
+    {
+        case utils::typings::GRAYSCALE_COLOR_TYPE:              return "gray";
+        case utils::typings::RGB_COLOR_TYPE:                    return "rgb";
+        case utils::typings::INDEXED_COLOR_TYPE:                return "indexed";
+        case utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE:    return "gray-alpha";
+        case utils::typings::RGBA_COLOR_TYPE:                   return "rgba";
+        default: break;
+    }
+
+    return "invalid";
+} // colorTypeToString
+} // namespace benchmarks
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <vector>
 
+#include "utils/aligned-buffer.hpp"
+#include "utils/decode-stats.hpp"
+#include "utils/memory-accounting.hpp"
 #include "utils/typings.hpp"
 
 namespace abstract_image_formats
@@ -20,14 +25,14 @@ public:
      *
      * @return: The size of all the scanlines.
     */
-    [[nodiscard]] virtual uint32_t getImageScanlinesSize() const = 0;
+    [[nodiscard]] virtual uint64_t getImageScanlinesSize() const = 0;
 
     /*!
      * getImageScanlineSize
      *
      * @return: The size of a single scanline.
     */
-    [[nodiscard]] virtual uint32_t getImageScanlineSize() const = 0;
+    [[nodiscard]] virtual uint64_t getImageScanlineSize() const = 0;
 
     /*!
      * getImageRGBScanlineSize
@@ -37,7 +42,7 @@ public:
      *
      * @return: The size of a single scanline for the image with three channels (red, green, blue).
     */
-    [[nodiscard]] virtual uint32_t getImageRGBScanlineSize() const = 0;
+    [[nodiscard]] virtual uint64_t getImageRGBScanlineSize() const = 0;
 
     /*!
      * getImageRGBScanlinesSize
@@ -47,7 +52,7 @@ public:
      *
      * @return: The size of the scanlines for the image with three channels (red, green, blue).
     */
-    [[nodiscard]] virtual uint32_t getImageRGBScanlinesSize() const = 0;
+    [[nodiscard]] virtual uint64_t getImageRGBScanlinesSize() const = 0;
 
     /*!
      * getImageRGBAScanlineSize
@@ -57,7 +62,7 @@ public:
      *
      * @return: The size of a single scanline for the image with four channels (red, green, blue, alpha).
     */
-    [[nodiscard]] virtual uint32_t getImageRGBAScanlineSize() const = 0;
+    [[nodiscard]] virtual uint64_t getImageRGBAScanlineSize() const = 0;
 
     /*!
      * getImageRGBAScanlinesSize
@@ -67,7 +72,15 @@ public:
      *
      * @return: The size of the scanlines for the image with four channels (red, green, blue, alpha).
     */
-    [[nodiscard]] virtual uint32_t getImageRGBAScanlinesSize() const = 0;
+    [[nodiscard]] virtual uint64_t getImageRGBAScanlinesSize() const = 0;
+
+    /*!
+     * getImagePlaneRowSize
+     *
+     * @return: The size of a row of each plane written by convertRawDataIntoPlanes,
+     * width samples of two bytes for 16 bit images and one byte otherwise.
+    */
+    [[nodiscard]] virtual uint64_t getImagePlaneRowSize() const = 0;
 
     /*!
      * getImageWidth
@@ -97,6 +110,14 @@ public:
     */
     [[nodiscard]] virtual utils::typings::ImageColorType getImageColorType() const = 0;
 
+    /*!
+     * getImageByteOrder
+     *
+     * @return: Byte order of the image's 16 bit samples, in the decoded data and every conversion of it,
+     * it changes with each swapBytesOrder call, images with less than 16 bits always report BIG.
+    */
+    [[nodiscard]] virtual utils::typings::ByteOrder getImageByteOrder() const = 0;
+
     /*!
      * getNumberOfChannels
      *
@@ -130,6 +151,8 @@ public:
      * getRawDataRGB
      *
      * @return: A copy for the internal raw data bytes using three channels (red, green, blue).
+     * @throw DecodeLimitExceeded if the conversion would go over the memory budget,
+     * runtime_error if the raw data was taken by takeRawData.
     */
     [[nodiscard]] virtual utils::typings::Bytes getRawDataRGB() = 0;
 
@@ -143,6 +166,8 @@ public:
      * @return: A pointer to the allocated memory and copied content of the internal raw data vector
      * using three channels (red, green, blue).
      * It's the caller responsability to deallocate this memory with delete[].
+     * @throw DecodeLimitExceeded if the conversion would go over the memory budget,
+     * runtime_error if the raw data was taken by takeRawData.
     */
     [[nodiscard]] virtual uint8_t* getRawDataRGBBuffer() = 0;
 
@@ -150,6 +175,8 @@ public:
      * getRawDataRGBA
      *
      * @return: A copy for the internal raw data bytes using 4 channels (red, green, blue, alpha).
+     * @throw DecodeLimitExceeded if the conversion would go over the memory budget,
+     * runtime_error if the raw data was taken by takeRawData.
     */
     [[nodiscard]] virtual utils::typings::Bytes getRawDataRGBA() = 0;
 
@@ -163,9 +190,232 @@ public:
      * @return: A pointer to the allocated memory and copied content of the internal raw data vector
      * using four channels (red, green, blue, alpha).
      * It's the caller responsability to deallocate this memory with delete[].
+     * @throw DecodeLimitExceeded if the conversion would go over the memory budget,
+     * runtime_error if the raw data was taken by takeRawData.
     */
     [[nodiscard]] virtual uint8_t* getRawDataRGBABuffer() = 0;
 
+    /*!
+     * getRawDataView
+     *
+     * @return: A view of the internal defiltered bytes, nothing is copied,
+     * valid as long as the object lives and until swapBytesOrder or takeRawData are called.
+    */
+    [[nodiscard]] virtual utils::typings::BytesView getRawDataView() = 0;
+
+    /*!
+     * getRawDataRGBView
+     *
+     * Converts the data to three channels (red, green, blue) the first time it's called,
+     * images already in rgb are viewed directly.
+     *
+     * @return: A view of the internal rgb bytes, nothing is copied,
+     * valid as long as the object lives and until resetCachedData, swapBytesOrder or takeRawData are called.
+    */
+    [[nodiscard]] virtual utils::typings::BytesView getRawDataRGBView() = 0;
+
+    /*!
+     * getRawDataRGBAView
+     *
+     * Converts the data to four channels (red, green, blue, alpha) the first time it's called,
+     * images already in rgba are viewed directly.
+     *
+     * @return: A view of the internal rgba bytes, nothing is copied,
+     * valid as long as the object lives and until resetCachedData, swapBytesOrder or takeRawData are called.
+    */
+    [[nodiscard]] virtual utils::typings::BytesView getRawDataRGBAView() = 0;
+
+    /*!
+     * getRawDataAligned
+     *
+     * Copies the defiltered data into rows laid out as asked, so it can be read with aligned loads
+     * or uploaded as is to memory expecting a row pitch, instead of being repacked by the caller.
+     *
+     * @param row_layout: Alignment and padding of each row.
+     * @return: The defiltered bytes, one row of getImageScanlineSize() bytes every stride() bytes.
+     * @throw runtime_error if the row layout is invalid or the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] virtual utils::AlignedBuffer getRawDataAligned(const utils::RowLayout& row_layout = {}) = 0;
+
+    /*!
+     * getRawDataRGBAligned
+     *
+     * The same as getRawDataAligned, with the data converted to three channels (red, green, blue)
+     * straight into the rows, the rgb cache isn't filled.
+     *
+     * @param row_layout: Alignment and padding of each row.
+     * @return: The rgb bytes, one row of getImageRGBScanlineSize() bytes every stride() bytes.
+     * @throw runtime_error if the row layout is invalid or the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] virtual utils::AlignedBuffer getRawDataRGBAligned(const utils::RowLayout& row_layout = {}) = 0;
+
+    /*!
+     * getRawDataRGBAAligned
+     *
+     * The same as getRawDataAligned, with the data converted to four channels (red, green, blue, alpha)
+     * straight into the rows, the rgba cache isn't filled.
+     *
+     * @param row_layout: Alignment and padding of each row.
+     * @return: The rgba bytes, one row of getImageRGBAScanlineSize() bytes every stride() bytes.
+     * @throw runtime_error if the row layout is invalid or the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] virtual utils::AlignedBuffer getRawDataRGBAAligned(const utils::RowLayout& row_layout = {}) = 0;
+
+    /*!
+     * convertRawDataInto
+     *
+     * Converts the data to pixel_format straight into a buffer owned by the caller, in a single pass
+     * from whatever color type and bit depth the image has, nothing is cached.
+     *
+     * @param pixel_format: Layout of the converted pixels, four bytes each.
+     * @param dest: Where the rows are written, at least (height - 1) * stride + width * 4 bytes.
+     * @param stride: Distance in bytes from the start of a row to the start of the next one in dest,
+     * 0 for rows packed one after another, the bytes between rows are left untouched.
+     * @return
+     * @throw runtime_error if dest is too small, the stride is smaller than a row or the raw data was taken by takeRawData.
+    */
+    virtual void convertRawDataInto
+    (
+        utils::typings::PixelFormat pixel_format,
+        utils::typings::MutableBytesView dest,
+        uint64_t stride = 0
+    ) = 0;
+
+    /*!
+     * getRawDataPixelFormat
+     *
+     * @param pixel_format: Layout of the converted pixels, four bytes each.
+     * @return: A copy of the data converted to pixel_format (see convertRawDataInto).
+     * @throw runtime_error if the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] virtual utils::typings::Bytes getRawDataPixelFormat(utils::typings::PixelFormat pixel_format) = 0;
+
+    /*!
+     * getRawDataPixelFormatAligned
+     *
+     * The same as getRawDataAligned, with the data converted to pixel_format (see convertRawDataInto).
+     *
+     * @param pixel_format: Layout of the converted pixels, four bytes each.
+     * @param row_layout: Alignment and padding of each row.
+     * @return: The converted pixels, one row of width * 4 bytes every stride() bytes.
+     * @throw runtime_error if the row layout is invalid or the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] virtual utils::AlignedBuffer getRawDataPixelFormatAligned
+    (
+        utils::typings::PixelFormat pixel_format,
+        const utils::RowLayout& row_layout = {}
+    ) = 0;
+
+    /*!
+     * getImageTensorSize
+     *
+     * @param tensor_options: Type, layout, channels and size of the tensor.
+     * @return: Bytes of the tensor convertRawDataToTensor writes, width * height * channels elements,
+     * the tensor's width and height if set, the image's otherwise.
+    */
+    [[nodiscard]] virtual uint64_t getImageTensorSize(const utils::typings::TensorOptions& tensor_options) const = 0;
+
+    /*!
+     * convertRawDataToTensor
+     *
+     * Writes the pixels as a tensor straight into a buffer owned by the caller, converting, normalizing
+     * and laying them out in a single pass, a row at a time, nothing is cached.
+     *
+     * @param tensor_options: Type, layout, channels, normalization, size and fit of the tensor.
+     * @param dest: Where the tensor is written, at least getImageTensorSize bytes, aligned to the element size.
+     * @return
+     * @throw runtime_error if the channels aren't 3 or 4, the tensor's size differs from the image's
+     * and fit is EXACT, dest is too small or misaligned, or the raw data was taken by takeRawData.
+    */
+    virtual void convertRawDataToTensor
+    (
+        const utils::typings::TensorOptions& tensor_options,
+        utils::typings::MutableBytesView dest
+    ) = 0;
+
+    /*!
+     * convertRawDataIntoPlanes
+     *
+     * Writes each channel to a plane of its own, red, green, blue, then alpha, straight into buffers owned
+     * by the caller, splitting the pixels with SIMD a row at a time, nothing is cached.
+     * 16 bit images keep 16 bit samples, in the image's byte order, any other image gets 8 bit samples
+     * (lower bit depths are scaled up, palettes looked up), the alpha comes from the alpha channel or the tRNS chunk.
+     *
+     * @param planes: Where the planes are written, only the first channels of them are used,
+     * each at least (height - 1) * stride + getImagePlaneRowSize() bytes.
+     * @param channels: 3 (red, green, blue) or 4 (red, green, blue, alpha), whatever the image's color type.
+     * @param stride: Distance in bytes from the start of a row to the start of the next one in every plane,
+     * 0 for rows packed one after another, the bytes between rows are left untouched.
+     * @return
+     * @throw runtime_error if the channels aren't 3 or 4, a plane is too small, the stride is smaller than a row
+     * or the raw data was taken by takeRawData.
+    */
+    virtual void convertRawDataIntoPlanes
+    (
+        const std::array<utils::typings::MutableBytesView, 4>& planes,
+        uint8_t channels,
+        uint64_t stride = 0
+    ) = 0;
+
+    /*!
+     * getRawDataPlanes
+     *
+     * @param channels: 3 (red, green, blue) or 4 (red, green, blue, alpha).
+     * @param row_layout: Alignment and padding of the rows of every plane.
+     * @return: A buffer per plane (see convertRawDataIntoPlanes), each one allocated and aligned on its own.
+     * @throw runtime_error if the channels aren't 3 or 4, the row layout is invalid
+     * or the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] virtual std::vector<utils::AlignedBuffer> getRawDataPlanes
+    (
+        uint8_t channels = 4,
+        const utils::RowLayout& row_layout = {}
+    ) = 0;
+
+    /*!
+     * takeRawData
+     *
+     * Moves the internal defiltered bytes out to the caller, without copying them.
+     * Afterwards the object has no raw data left, getRawDataView returns an empty view,
+     * and conversions that weren't cached yet can't be made anymore.
+     * It must not be called while other threads are reading the data.
+     *
+     * @return: The defiltered bytes, using the memory resource the object was created with,
+     * they can outlive the object.
+    */
+    [[nodiscard]] virtual utils::typings::Bytes takeRawData() = 0;
+
+    /*!
+     * getMemoryStats
+     *
+     * Every allocation made by the decoder is accounted, by the logical buffer it belongs to
+     * (chunks, inflate output, defiltered data, rgb and rgba caches).
+     * Copies handed to the caller (getRawDataCopy, getRawDataRGB, etc.) aren't accounted.
+     *
+     * @return: A snapshot of the allocation counters, useful after decoding
+     * to know the peak memory usage and how many allocations it took.
+    */
+    [[nodiscard]] virtual utils::MemoryStats getMemoryStats() const = 0;
+
+    /*!
+     * getDecodeStats
+     *
+     * Time spent and bytes processed by each decoding stage,
+     * only collected when the image was decoded with DecodeOptions::collect_decode_stats.
+     *
+     * @return: A copy of the stats collected so far, conversions made later
+     * (getRawDataRGB, getRawDataRGBA, etc.) are added as they happen.
+    */
+    [[nodiscard]] virtual utils::DecodeStats getDecodeStats() const = 0;
+
+    /*!
+     * getImageContent
+     *
+     * @return: Whether the image is opaque, gray and its largest sample, as detected while decoding
+     * with DecodeOptions::detect_content or DecodeOptions::reduce_channels, and its original color type.
+    */
+    [[nodiscard]] virtual utils::typings::ImageContent getImageContent() const = 0;
+
     /*!
      * resetCachedData
      *
@@ -174,6 +424,9 @@ public:
      *
      * NOTE: For classes that don't use internal cache for conversion this function is noop.
      *
+     * Unlike the getters, which can be called from many threads at once,
+     * it must not be called while other threads are reading the data.
+     *
      * @return
     */
     virtual void resetCachedData() = 0;
@@ -182,11 +435,27 @@ public:
      * swapBytesOrder
      *
      * If image's bit depth > 8 bits, raw data will be reodered, meaning if it's LSB it'll become MSB,
-     * and if it's MSB it'll become LSB.
+     * and if it's MSB it'll become LSB, along with the rgb and rgba caches already filled.
      * If image's bit depth is less than 8 bits, nothing is done.
      *
+     * Large images are swapped by several threads at once.
+     *
+     * Unlike the getters, which can be called from many threads at once,
+     * it must not be called while other threads are reading the data.
+     *
      * @return
     */
     virtual void swapBytesOrder() = 0;
+
+    /*!
+     * setImageByteOrder
+     *
+     * Swaps the bytes (see swapBytesOrder) only if the samples aren't in byte_order already,
+     * so it can be called before every use of the data without flipping it back and forth.
+     *
+     * @param byte_order: Byte order wanted for the 16 bit samples.
+     * @return
+    */
+    virtual void setImageByteOrder(utils::typings::ByteOrder byte_order) = 0;
 }; // class AbstractImageFormats
 } // namespace abstract_formats
@@ -15,6 +15,11 @@ extern "C"
 #define SUCCESS 0
 #define INVALID_ARGUMENTS -1
 #define EXCEPTION -2
+#define BUFFER_TOO_SMALL -3
+#define DECODE_CANCELLED -4
+#define DEADLINE_EXCEEDED -5
+#define LIMIT_EXCEEDED -6
+#define DECODE_REQUEST_PENDING 1
 
 typedef enum
 {
@@ -26,6 +31,214 @@ typedef enum
     RGBA_COLOR_TYPE,
 } ImageColorType; // enum ImageColorType
 
+/*!
+ * PixelFormat
+ *
+ * Layout of the pixels handed to the caller.
+ *
+ * NATIVE_PIXEL_FORMAT: The defiltered data, in the image's own color type and bit depth.
+ * RGB_PIXEL_FORMAT: Three channels (red, green, blue), 8 or 16 bits each.
+ * RGBA_PIXEL_FORMAT: Four channels (red, green, blue, alpha), 8 or 16 bits each.
+ *
+ * The formats below are 8 bits per channel (16 bit samples are rounded), named in the order the bytes are in memory,
+ * with the alpha of the image's alpha channel or tRNS chunk. They're converted in a single pass straight into
+ * the caller's buffer, so they can only be written into one (decodeImageInto, or a request with a buffer).
+ * Any changes here must be reflected in utils/typings.hpp PixelFormat.
+ *
+ * BGRA_PIXEL_FORMAT, ARGB_PIXEL_FORMAT: Straight alpha.
+ * RGBA_PREMULTIPLIED_PIXEL_FORMAT, BGRA_PREMULTIPLIED_PIXEL_FORMAT: Colors multiplied by alpha.
+ * XRGB_PIXEL_FORMAT: The first byte is padding, always 0xFF, the alpha is dropped.
+*/
+typedef enum
+{
+    NATIVE_PIXEL_FORMAT,
+    RGB_PIXEL_FORMAT,
+    RGBA_PIXEL_FORMAT,
+    BGRA_PIXEL_FORMAT,
+    ARGB_PIXEL_FORMAT,
+    RGBA_PREMULTIPLIED_PIXEL_FORMAT,
+    BGRA_PREMULTIPLIED_PIXEL_FORMAT,
+    XRGB_PIXEL_FORMAT,
+} PixelFormat; // enum PixelFormat
+
+/*!
+ * The logical buffers a decoder allocates,
+ * any changes here must be reflected in utils/memory-accounting.hpp
+*/
+typedef enum
+{
+    CHUNK_BUFFER,
+    INFLATE_OUTPUT_BUFFER,
+    DEFILTERED_BUFFER,
+    RGB_CACHE_BUFFER,
+    RGBA_CACHE_BUFFER,
+    NUMBER_OF_BUFFER_KINDS,
+} BufferKind; // enum BufferKind
+
+/*!
+ * BufferMemoryStats
+ *
+ * A snapshot of the allocations of a buffer (or all of them).
+*/
+typedef struct
+{
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t current_bytes;
+    uint64_t peak_bytes;
+} BufferMemoryStats; // struct BufferMemoryStats
+
+/*!
+ * MemoryStats
+ *
+ * A snapshot of the allocations of all buffers, and broken down by each buffer kind (index it with BufferKind).
+*/
+typedef struct
+{
+    BufferMemoryStats total;
+    BufferMemoryStats buffers[NUMBER_OF_BUFFER_KINDS];
+} MemoryStats; // struct MemoryStats
+
+/*!
+ * DecodeStats
+ *
+ * Time spent, in nanoseconds, and bytes processed by each decoding stage.
+ * Any changes here must be reflected in utils/decode-stats.hpp
+*/
+typedef struct
+{
+    uint64_t total_decode_nanoseconds;
+    uint64_t io_nanoseconds;
+    uint64_t crc_nanoseconds;
+    uint64_t inflate_nanoseconds;
+    uint64_t defilter_nanoseconds;
+    uint64_t rgb_conversion_nanoseconds;
+    uint64_t rgba_conversion_nanoseconds;
+    uint64_t chunks;
+    uint64_t io_bytes;
+    uint64_t crc_bytes;
+    uint64_t compressed_bytes;
+    uint64_t inflated_bytes;
+    uint64_t defiltered_bytes;
+    uint64_t rgb_converted_bytes;
+    uint64_t rgba_converted_bytes;
+    uint64_t filter_type_rows[5]; /* None, Sub, Up, Average, Paeth */
+} DecodeStats; // struct DecodeStats
+
+/*!
+ * ImageContent
+ *
+ * What the pixels of an image actually use, detected while decoding with ImageDecoderOptions::detect_content
+ * or ImageDecoderOptions::reduce_channels, otherwise opaque and gray are 0 and max_sample is 65535.
+ * Any changes here must be reflected in utils/typings.hpp ImageContent.
+*/
+typedef struct
+{
+    int opaque; /* Non-zero if every pixel is fully opaque, a tRNS transparent color counts as not opaque. */
+    int gray; /* Non-zero if red, green and blue are equal in every pixel. */
+    uint16_t max_sample; /* Largest color sample, alpha left out, at the image's bit depth. */
+    ImageColorType original_color_type; /* Color type the image was encoded with, before reduce_channels. */
+} ImageContent; // struct ImageContent
+
+/*!
+ * DecodeCancellationToken
+ *
+ * Cancels every decode given it through ImageDecoderOptions once cancelDecode is called,
+ * created by createDecodeCancellationToken.
+*/
+typedef struct DecodeCancellationToken DecodeCancellationToken;
+
+/*!
+ * ImageDecoderOptions
+ *
+ * Options changing how an image gets decoded, zero-initializing it gives the default options.
+ * Any changes here must be reflected in utils/typings.hpp DecodeOptions.
+ *
+ * Cancellation and the deadline are checked between chunks, rounds of inflate and batches of rows,
+ * an interrupted decode frees what it allocated and fails with DECODE_CANCELLED or DEADLINE_EXCEEDED.
+ * Images going over max_pixels or memory_budget_bytes fail with LIMIT_EXCEEDED.
+*/
+typedef struct
+{
+    int collect_decode_stats; /* Non-zero to measure each decoding stage, see getDecodeStats. */
+    uint64_t deadline_milliseconds; /* Non-zero to stop decodes still running this long after they're requested. */
+    DecodeCancellationToken* cancellation_token; /* Optional, stops the decode once cancelDecode is called on it. */
+    uint64_t max_pixels; /* Non-zero to refuse images with more pixels (width times height), checked before allocating. */
+    uint64_t memory_budget_bytes; /* Non-zero to refuse decodes or conversions needing more memory, checked before allocating. */
+    const char* out_of_core_directory; /* Optional, directory where the pixels are kept in memory mapped temporary files. */
+    int native_byte_order; /* Non-zero to get 16 bit samples in the host's byte order instead of big endian. */
+    int reduce_to_8_bits; /* Non-zero to round 16 bit samples to 8 bit while decoding, the image is then 8 bit deep. */
+    int detect_content; /* Non-zero to find out whether the image is opaque or gray while decoding, see getImageContent. */
+    int reduce_channels; /* Non-zero to drop the channels the detected content makes redundant, e.g. opaque rgba to rgb. */
+} ImageDecoderOptions; // struct ImageDecoderOptions
+
+/*!
+ * DecodeRequest
+ *
+ * One image to be decoded by decodeImageBatch or submitDecodeRequest, read either from a file or from memory.
+ *
+ * image_filepath: Image filepath, or NULL to decode image_data instead.
+ * image_data: The whole encoded image in memory, it's read in place, so it must stay valid until the request is done.
+ * image_data_size: Size in bytes of image_data.
+ * options: Optional pointer to the decode options, if NULL the default options are used.
+ * pixel_format: Layout the pixels will be written in.
+ * buffer: Buffer owned by the caller where the pixels will be written to, may be NULL if buffer_size is 0,
+ * a submitted request without a buffer keeps the pixels instead, see borrowDecodeRequestPixels.
+ * buffer_size: Size in bytes of the buffer.
+*/
+typedef struct
+{
+    const char* image_filepath;
+    const uint8_t* image_data;
+    size_t image_data_size;
+    const ImageDecoderOptions* options;
+    PixelFormat pixel_format;
+    uint8_t* buffer;
+    size_t buffer_size;
+} DecodeRequest; // struct DecodeRequest
+
+/*!
+ * DecodeResult
+ *
+ * status: SUCCESS, INVALID_ARGUMENTS, EXCEPTION, DECODE_CANCELLED, DEADLINE_EXCEEDED, LIMIT_EXCEEDED,
+ * or BUFFER_TOO_SMALL in which case nothing was written.
+ * written_size: Bytes written to the buffer, or the bytes needed when it's too small.
+ * image_*: The image's properties, zero if it couldn't be decoded.
+ * error: Message of what happened when status isn't SUCCESS, always null terminated.
+*/
+typedef struct
+{
+    int status;
+    size_t written_size;
+    uint32_t image_width;
+    uint32_t image_height;
+    ImageColorType image_color_type;
+    uint8_t image_bit_depth;
+    char error[256];
+} DecodeResult; // struct DecodeResult
+
+/*!
+ * DecodeThreadPool
+ *
+ * Worker threads decoding the requests given to decodeImageBatch and submitDecodeRequest.
+*/
+typedef struct DecodeThreadPool DecodeThreadPool;
+
+/*!
+ * DecodeRequestHandle
+ *
+ * A request submitted by submitDecodeRequest, released with releaseDecodeRequest.
+*/
+typedef struct DecodeRequestHandle DecodeRequestHandle;
+
+/*!
+ * DecodeCallback
+ *
+ * Called from a worker thread once a submitted request is done, the result is only valid during the call.
+ * The handle may be released from inside the callback, but decodeImageBatch must not be called from it.
+*/
+typedef void (*DecodeCallback)(DecodeRequestHandle* handle, const DecodeResult* result, void* user_data);
+
 /*!
  * ImageDecoderWrapper
  *
@@ -69,12 +282,44 @@ ImageDecoderWrapper* createImageDecoderInstance
     ImageColorType* image_color_type,
     uint8_t* image_bit_depth,
     uint8_t* image_number_of_channels,
-    uint32_t* image_scanline_size,
-    uint32_t* image_scanlines_size,
-    uint32_t* image_rgb_scanline_size,
-    uint32_t* image_rgb_scanlines_size,
-    uint32_t* image_rgba_scanline_size,
-    uint32_t* image_rgba_scanlines_size,
+    uint64_t* image_scanline_size,
+    uint64_t* image_scanlines_size,
+    uint64_t* image_rgb_scanline_size,
+    uint64_t* image_rgb_scanlines_size,
+    uint64_t* image_rgba_scanline_size,
+    uint64_t* image_rgba_scanlines_size,
+    const char** error
+);
+
+/*!
+ * createImageDecoderInstanceWithOptions
+ *
+ * Same as createImageDecoderInstance, but decoding the image with the given options.
+ *
+ * @param image_filepath: Image filepath.
+ * @param options: Optional pointer to the decode options, if NULL the default options are used.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to an instance wrapper around the ImageDecoder class,
+ * the memory should be deallocated by destroyImageDecoderInstance.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+ImageDecoderWrapper* createImageDecoderInstanceWithOptions
+(
+    const char* image_filepath,
+    const ImageDecoderOptions* options,
+    uint32_t* image_width,
+    uint32_t* image_height,
+    ImageColorType* image_color_type,
+    uint8_t* image_bit_depth,
+    uint8_t* image_number_of_channels,
+    uint64_t* image_scanline_size,
+    uint64_t* image_scanlines_size,
+    uint64_t* image_rgb_scanline_size,
+    uint64_t* image_rgb_scanlines_size,
+    uint64_t* image_rgba_scanline_size,
+    uint64_t* image_rgba_scanlines_size,
     const char** error
 );
 
@@ -138,6 +383,267 @@ uint8_t* getRawDataRGBBuffer(ImageDecoderWrapper* image_decoder_wrapper, const c
 */
 uint8_t* getRawDataRGBABuffer(ImageDecoderWrapper* image_decoder_wrapper, const char** error);
 
+/*!
+ * borrowRawDataBuffer
+ *
+ * Unlike getRawDataBuffer nothing is allocated nor copied, the pointer points into the decoder's own storage.
+ * It stays valid until destroyImageDecoderInstance is called, and the bytes it points to
+ * are changed in place by swapBytesOrder.
+ *
+ * @param image_decoder_wrapper: Pointer to an instance of the ImageDecoder object.
+ * @param length: Pointer where the number of bytes pointed to will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to the internal raw data, it must not be freed nor written to.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+const uint8_t* borrowRawDataBuffer(ImageDecoderWrapper* image_decoder_wrapper, size_t* length, const char** error);
+
+/*!
+ * borrowRawDataRGBBuffer
+ *
+ * Same as borrowRawDataBuffer, but in (red, green, blue) format, converted the first time it's asked for.
+ * Besides destroyImageDecoderInstance, resetCachedData also invalidates the pointer.
+ *
+ * @param image_decoder_wrapper: Pointer to an instance of the ImageDecoder object.
+ * @param length: Pointer where the number of bytes pointed to will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to the internal rgb data, it must not be freed nor written to.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+const uint8_t* borrowRawDataRGBBuffer(ImageDecoderWrapper* image_decoder_wrapper, size_t* length, const char** error);
+
+/*!
+ * borrowRawDataRGBABuffer
+ *
+ * Same as borrowRawDataBuffer, but in (red, green, blue, alpha) format, converted the first time it's asked for.
+ * Besides destroyImageDecoderInstance, resetCachedData also invalidates the pointer.
+ *
+ * @param image_decoder_wrapper: Pointer to an instance of the ImageDecoder object.
+ * @param length: Pointer where the number of bytes pointed to will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to the internal rgba data, it must not be freed nor written to.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+const uint8_t* borrowRawDataRGBABuffer(ImageDecoderWrapper* image_decoder_wrapper, size_t* length, const char** error);
+
+/*!
+ * decodeImageInto
+ *
+ * Decodes an image straight into a buffer owned by the caller, no instance is kept around
+ * and no buffer has to be freed afterwards.
+ *
+ * @param image_filepath: Image filepath.
+ * @param options: Optional pointer to the decode options, if NULL the default options are used.
+ * @param pixel_format: Layout the pixels will be written in.
+ * @param buffer: Buffer where the pixels will be written to, may be NULL if buffer_size is 0.
+ * @param buffer_size: Size in bytes of the buffer.
+ * @param written_size: Optional pointer where the number of bytes written will be stored,
+ * or the number of bytes needed when the buffer is too small.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid, -2 if an exception happens,
+ * -3 if the buffer is too small, in which case nothing is written to it, -4 if the decode was cancelled,
+ * -5 if its deadline passed or -6 if the image goes over the options' limits.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int decodeImageInto
+(
+    const char* image_filepath,
+    const ImageDecoderOptions* options,
+    PixelFormat pixel_format,
+    uint8_t* buffer,
+    size_t buffer_size,
+    size_t* written_size,
+    const char** error
+);
+
+/*!
+ * decodeImagePlanesInto
+ *
+ * Decodes an image straight into a plane per channel (red, green, blue, then alpha) owned by the caller,
+ * each one width samples per row, rows packed one after another. Samples are 16 bits for 16 bit images,
+ * in the options' byte order, and 8 bits otherwise, no instance is kept around.
+ *
+ * @param image_filepath: Image filepath.
+ * @param options: Optional pointer to the decode options, if NULL the default options are used.
+ * @param channels: 3 (red, green, blue) or 4 (red, green, blue, alpha), whatever the image's color type.
+ * @param planes: Where each plane will be written to, only the first channels pointers are used,
+ * they may be NULL if plane_size is 0.
+ * @param plane_size: Size in bytes of each plane.
+ * @param written_size: Optional pointer where the number of bytes written to each plane will be stored,
+ * or the number of bytes needed when the planes are too small.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid, -2 if an exception happens,
+ * -3 if the planes are too small, in which case nothing is written to them, -4 if the decode was cancelled,
+ * -5 if its deadline passed or -6 if the image goes over the options' limits.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int decodeImagePlanesInto
+(
+    const char* image_filepath,
+    const ImageDecoderOptions* options,
+    uint8_t channels,
+    uint8_t* const planes[4],
+    size_t plane_size,
+    size_t* written_size,
+    const char** error
+);
+
+/*!
+ * createDecodeCancellationToken
+ *
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to the token, the memory should be deallocated by destroyDecodeCancellationToken.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+DecodeCancellationToken* createDecodeCancellationToken(const char** error);
+
+/*!
+ * cancelDecode
+ *
+ * Cancels every decode, running or yet to start, given the token, it may be called from any thread.
+ *
+ * @param cancellation_token: Pointer to the token.
+ * @return
+*/
+void cancelDecode(DecodeCancellationToken* cancellation_token);
+
+/*!
+ * destroyDecodeCancellationToken
+ *
+ * Decodes already given the token keep running, they just can't be cancelled anymore.
+ *
+ * @param cancellation_token: Pointer to the token to be deallocated.
+ * @return
+*/
+void destroyDecodeCancellationToken(DecodeCancellationToken* cancellation_token);
+
+/*!
+ * createDecodeThreadPool
+ *
+ * @param number_of_threads: Worker threads started, 0 starts one per hardware thread.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to the thread pool, the memory should be deallocated by destroyDecodeThreadPool.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+DecodeThreadPool* createDecodeThreadPool(size_t number_of_threads, const char** error);
+
+/*!
+ * destroyDecodeThreadPool
+ *
+ * Waits for every request already submitted to be done, then stops the workers,
+ * handles not released yet stay valid.
+ *
+ * @param decode_thread_pool: Pointer to the thread pool to be deallocated.
+ * @return
+*/
+void destroyDecodeThreadPool(DecodeThreadPool* decode_thread_pool);
+
+/*!
+ * decodeImageBatch
+ *
+ * Decodes every request in parallel on the pool's workers, each into its own buffer, and waits for all of them.
+ *
+ * @param decode_thread_pool: Pointer to the thread pool decoding the requests.
+ * @param requests: Array of count requests, every one of them must have a buffer (or a buffer_size of 0).
+ * @param results: Array of count results, results[i] is the result of requests[i].
+ * @param count: Number of requests.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid,
+ * or the status of the first request failed, in which case the results tell which ones failed and why.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int decodeImageBatch
+(
+    DecodeThreadPool* decode_thread_pool,
+    const DecodeRequest* requests,
+    DecodeResult* results,
+    size_t count,
+    const char** error
+);
+
+/*!
+ * submitDecodeRequest
+ *
+ * Queues a request to be decoded by one of the pool's workers and returns right away,
+ * its result can be polled, waited for, or handed to a callback.
+ * The request and its options are copied, only image_data and buffer must stay valid until it's done.
+ *
+ * @param decode_thread_pool: Pointer to the thread pool decoding the request.
+ * @param request: The request.
+ * @param callback: Optional function called once the request is done.
+ * @param user_data: Passed as is to the callback.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A handle to the request, it must be released by releaseDecodeRequest.
+ * NULL pointer will be returned in case of error.
+ * The caller must check the 'error' parameter message
+ * to see what happened in case of null pointer return.
+*/
+DecodeRequestHandle* submitDecodeRequest
+(
+    DecodeThreadPool* decode_thread_pool,
+    const DecodeRequest* request,
+    DecodeCallback callback,
+    void* user_data,
+    const char** error
+);
+
+/*!
+ * pollDecodeRequest
+ *
+ * @param handle: Handle returned by submitDecodeRequest.
+ * @param result: Pointer where the result will be stored once the request is done.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: 1 (DECODE_REQUEST_PENDING) while the request isn't done, 0 once it's done and result was stored,
+ * or -1 if the arguments are invalid.
+*/
+int pollDecodeRequest(DecodeRequestHandle* handle, DecodeResult* result, const char** error);
+
+/*!
+ * waitDecodeRequest
+ *
+ * Blocks until the request is done.
+ *
+ * @param handle: Handle returned by submitDecodeRequest.
+ * @param result: Pointer where the result will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid.
+*/
+int waitDecodeRequest(DecodeRequestHandle* handle, DecodeResult* result, const char** error);
+
+/*!
+ * borrowDecodeRequestPixels
+ *
+ * Pixels of a request submitted without a buffer, decoded successfully.
+ *
+ * @param handle: Handle returned by submitDecodeRequest.
+ * @param length: Pointer where the number of bytes pointed to will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: A pointer to the pixels, valid until the handle is released, it must not be freed nor written to.
+ * NULL pointer will be returned if the request isn't done, failed, or was given a buffer.
+*/
+const uint8_t* borrowDecodeRequestPixels(DecodeRequestHandle* handle, size_t* length, const char** error);
+
+/*!
+ * releaseDecodeRequest
+ *
+ * Gives the handle up, it may be called before the request is done,
+ * in which case the request still runs (and calls its callback) but its result is discarded.
+ *
+ * @param handle: Handle returned by submitDecodeRequest.
+ * @return
+*/
+void releaseDecodeRequest(DecodeRequestHandle* handle);
+
 /*!
  * freeRawDataBuffer
  *
@@ -173,6 +679,70 @@ int swapBytesOrder(ImageDecoderWrapper* image_decoder_wrapper, const char** erro
 */
 void resetCachedData(ImageDecoderWrapper* image_decoder_wrapper, const char** error);
 
+/*!
+ * getMemoryStats
+ *
+ * Every allocation made by the decoder is accounted, by the logical buffer it belongs to.
+ * Buffers returned by the get*Buffer functions aren't accounted.
+ *
+ * @param image_decoder_wrapper: Pointer to an instance of the ImageDecoder object.
+ * @param memory_stats: Pointer where the snapshot of the allocation counters will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid or -2 if an exception happens.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int getMemoryStats(ImageDecoderWrapper* image_decoder_wrapper, MemoryStats* memory_stats, const char** error);
+
+/*!
+ * getDecodeStats
+ *
+ * Only collected when the instance was created with ImageDecoderOptions::collect_decode_stats set,
+ * otherwise every field will be zero.
+ * Conversions (getRawDataRGBBuffer, etc.) are added as they happen.
+ *
+ * @param image_decoder_wrapper: Pointer to an instance of the ImageDecoder object.
+ * @param decode_stats: Pointer where the stats will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid or -2 if an exception happens.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int getDecodeStats(ImageDecoderWrapper* image_decoder_wrapper, DecodeStats* decode_stats, const char** error);
+
+/*!
+ * getImageContent
+ *
+ * @param image_decoder_wrapper: Pointer to an instance of the ImageDecoder object.
+ * @param image_content: Pointer where the detected content will be stored.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid or -2 if an exception happens.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int getImageContent(ImageDecoderWrapper* image_decoder_wrapper, ImageContent* image_content, const char** error);
+
+/*!
+ * startDecodeTracing
+ *
+ * Starts recording when each decoding stage begins and ends, on which thread and for which image,
+ * of every decoder instance, the spans are written as Chrome trace-event JSON when stopDecodeTracing is called.
+ *
+ * @param output_filepath: File where the trace will be written.
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -1 if the arguments are invalid or -2 if an exception happens.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int startDecodeTracing(const char* output_filepath, const char** error);
+
+/*!
+ * stopDecodeTracing
+ *
+ * Stops recording and writes the trace to the file given to startDecodeTracing.
+ *
+ * @param error: If there's any error its message will be placed into it.
+ * @return: On success this function will return 0, it will return -2 if an exception happens.
+ * The caller must check the 'error' parameter to see what happened in case of non-zero return.
+*/
+int stopDecodeTracing(const char** error);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
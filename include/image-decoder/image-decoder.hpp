@@ -1,22 +1,168 @@
 #pragma once
 
+#include <coroutine>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <variant>
 
 #include "abstract-image-formats/abstract-image-formats.hpp"
+#include "utils/thread-pool.hpp"
 
 namespace image_decoder
 {
+class AsyncDecode;
+
 class ImageDecoder : abstract_image_formats::AbstractImageFormats
 {
 public:
-    ImageDecoder(const std::filesystem::path& image_filepath);
+    /*!
+     * ImageDecoder
+     *
+     * @param image_filepath: Image filepath.
+     * @param memory_resource: Memory resource all the internal buffers will be allocated from,
+     * useful for per-request arenas (std::pmr::monotonic_buffer_resource) which are released all at once.
+     * It must outlive the ImageDecoder object, by default the global heap is used.
+    */
+    ImageDecoder
+    (
+        const std::filesystem::path& image_filepath,
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * ImageDecoder
+     *
+     * @param image_filepath: Image filepath.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param memory_resource: Memory resource all the internal buffers will be allocated from,
+     * it must outlive the ImageDecoder object, by default the global heap is used.
+    */
+    ImageDecoder
+    (
+        const std::filesystem::path& image_filepath,
+        const utils::typings::DecodeOptions& decode_options,
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * ImageDecoder
+     *
+     * @param image_data: The whole encoded image already in memory, its format is detected from its signature,
+     * it's decoded in place, so it only has to outlive the constructor.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param memory_resource: Memory resource all the internal buffers will be allocated from,
+     * it must outlive the ImageDecoder object, by default the global heap is used.
+     * @throw runtime_error if the format isn't supported.
+    */
+    explicit ImageDecoder
+    (
+        utils::typings::BytesView image_data,
+        const utils::typings::DecodeOptions& decode_options = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
     ~ImageDecoder();
     ImageDecoder(ImageDecoder&&);
     ImageDecoder& operator=(ImageDecoder&&);
     ImageDecoder(const ImageDecoder&) = delete;
     ImageDecoder& operator=(const ImageDecoder&) = delete;
 
+public:
+    /*!
+     * decodeAsync
+     *
+     * Decodes the image on the executor instead of the calling thread.
+     * The decode stops early if a stop is requested on decode_options.stop_token or its deadline passes,
+     * the result then throws utils::DecodeCancelled or utils::DecodeDeadlineExceeded.
+     *
+     * @param image_filepath: Image filepath.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param executor: Where the decode runs, if empty it runs on a thread pool shared by every decodeAsync call.
+     * @param memory_resource: Memory resource all the internal buffers will be allocated from,
+     * it must outlive the ImageDecoder object.
+     * @return: The decode in flight, co_await it, or get a std::future out of it.
+    */
+    [[nodiscard]] static AsyncDecode decodeAsync
+    (
+        std::filesystem::path image_filepath,
+        utils::typings::DecodeOptions decode_options = {},
+        utils::Executor executor = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * decodeAsync
+     *
+     * Same as above, but decoding an image in memory, which must stay valid until the decode is done.
+    */
+    [[nodiscard]] static AsyncDecode decodeAsync
+    (
+        utils::typings::BytesView image_data,
+        utils::typings::DecodeOptions decode_options = {},
+        utils::Executor executor = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * decodeTensorBatch
+     *
+     * Decodes a minibatch of images into one contiguous tensor, [N, C, H, W] for CHW (or [N, H, W, C] for HWC),
+     * the i-th image written to the i-th slice by convertRawDataToTensor. Images are decoded in parallel
+     * on the executor and the calling thread, each decoder freed as soon as its slice is written,
+     * so only the images being decoded are held at once. Returns once every slice is written.
+     *
+     * @param image_filepaths: The images of the batch.
+     * @param tensor_options: Tensor of each image, width and height must be set,
+     * images of another size are only accepted if fit crops or pads them.
+     * @param dest: Where the batch is written, at least getTensorBatchSize bytes, aligned to the element size.
+     * @param decode_options: Options changing how every image is decoded, a stop on its stop_token cancels the batch.
+     * @param executor: Where the decodes run, if empty on the thread pool shared with decodeAsync,
+     * it may run them late or never, the calling thread decodes every image no task started on.
+     * @param memory_resource: Memory resource the buffers of every decoder are allocated from.
+     * @return
+     * @throw runtime_error if the tensor's width or height isn't set or dest is too small,
+     * otherwise the exception of the first image that failed, once the others are written.
+    */
+    static void decodeTensorBatch
+    (
+        std::span<const std::filesystem::path> image_filepaths,
+        const utils::typings::TensorOptions& tensor_options,
+        utils::typings::MutableBytesView dest,
+        const utils::typings::DecodeOptions& decode_options = {},
+        utils::Executor executor = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * decodeTensorBatch
+     *
+     * Same as above, but decoding images in memory.
+    */
+    static void decodeTensorBatch
+    (
+        std::span<const utils::typings::BytesView> images_data,
+        const utils::typings::TensorOptions& tensor_options,
+        utils::typings::MutableBytesView dest,
+        const utils::typings::DecodeOptions& decode_options = {},
+        utils::Executor executor = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * getTensorBatchSize
+     *
+     * @param images: Number of images in the batch.
+     * @param tensor_options: Tensor of each image, with its width and height set.
+     * @return: Bytes of the batch decodeTensorBatch writes, images slices one after the other.
+    */
+    [[nodiscard]] static uint64_t getTensorBatchSize
+    (
+        std::size_t images,
+        const utils::typings::TensorOptions& tensor_options
+    ) noexcept;
+
 public:
     /*!
      * AbstractImageFormats class members
@@ -28,19 +174,61 @@ public:
     [[nodiscard]] uint8_t* getRawDataRGBBuffer() override;
     [[nodiscard]] utils::typings::Bytes getRawDataRGBA() override;
     [[nodiscard]] uint8_t* getRawDataRGBABuffer() override;
+    [[nodiscard]] utils::typings::BytesView getRawDataView() override;
+    [[nodiscard]] utils::typings::BytesView getRawDataRGBView() override;
+    [[nodiscard]] utils::typings::BytesView getRawDataRGBAView() override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataAligned(const utils::RowLayout& row_layout = {}) override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataRGBAligned(const utils::RowLayout& row_layout = {}) override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataRGBAAligned(const utils::RowLayout& row_layout = {}) override;
+    void convertRawDataInto
+    (
+        utils::typings::PixelFormat pixel_format,
+        utils::typings::MutableBytesView dest,
+        uint64_t stride = 0
+    ) override;
+    [[nodiscard]] utils::typings::Bytes getRawDataPixelFormat(utils::typings::PixelFormat pixel_format) override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataPixelFormatAligned
+    (
+        utils::typings::PixelFormat pixel_format,
+        const utils::RowLayout& row_layout = {}
+    ) override;
+    [[nodiscard]] uint64_t getImageTensorSize(const utils::typings::TensorOptions& tensor_options) const override;
+    void convertRawDataToTensor
+    (
+        const utils::typings::TensorOptions& tensor_options,
+        utils::typings::MutableBytesView dest
+    ) override;
+    void convertRawDataIntoPlanes
+    (
+        const std::array<utils::typings::MutableBytesView, 4>& planes,
+        uint8_t channels,
+        uint64_t stride = 0
+    ) override;
+    [[nodiscard]] std::vector<utils::AlignedBuffer> getRawDataPlanes
+    (
+        uint8_t channels = 4,
+        const utils::RowLayout& row_layout = {}
+    ) override;
+    [[nodiscard]] utils::typings::Bytes takeRawData() override;
     [[nodiscard]] uint32_t getImageWidth() const override;
     [[nodiscard]] uint32_t getImageHeight() const override;
     [[nodiscard]] utils::typings::ImageColorType getImageColorType() const override;
     [[nodiscard]] uint8_t getImageBitDepth() const override;
+    [[nodiscard]] utils::typings::ByteOrder getImageByteOrder() const override;
     [[nodiscard]] uint8_t getImageNumberOfChannels() const override;
-    [[nodiscard]] uint32_t getImageScanlineSize() const override;
-    [[nodiscard]] uint32_t getImageScanlinesSize() const override;
-    [[nodiscard]] uint32_t getImageRGBScanlineSize() const override;
-    [[nodiscard]] uint32_t getImageRGBScanlinesSize() const override;
-    [[nodiscard]] uint32_t getImageRGBAScanlineSize() const override;
-    [[nodiscard]] uint32_t getImageRGBAScanlinesSize() const override;
+    [[nodiscard]] uint64_t getImageScanlineSize() const override;
+    [[nodiscard]] uint64_t getImageScanlinesSize() const override;
+    [[nodiscard]] uint64_t getImageRGBScanlineSize() const override;
+    [[nodiscard]] uint64_t getImageRGBScanlinesSize() const override;
+    [[nodiscard]] uint64_t getImageRGBAScanlineSize() const override;
+    [[nodiscard]] uint64_t getImageRGBAScanlinesSize() const override;
+    [[nodiscard]] uint64_t getImagePlaneRowSize() const override;
+    [[nodiscard]] utils::MemoryStats getMemoryStats() const override;
+    [[nodiscard]] utils::DecodeStats getDecodeStats() const override;
+    [[nodiscard]] utils::typings::ImageContent getImageContent() const override;
     void resetCachedData() noexcept override;
     void swapBytesOrder() override;
+    void setImageByteOrder(utils::typings::ByteOrder byte_order) override;
 
 private:
     using png_image_unique_ptr = std::unique_ptr<utils::typings::PNGFormat>;
@@ -50,12 +238,62 @@ private:
      * loadPNGImage
      *
      * @param image_filepath: Image filepath.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param memory_resource: Memory resource the PNGFormat buffers will be allocated from.
+     * @return
+    */
+    void loadPNGImage
+    (
+        const std::filesystem::path& image_filepath,
+        const utils::typings::DecodeOptions& decode_options,
+        std::pmr::memory_resource* memory_resource
+    );
+
+    /*!
+     * loadPNGImage
+     *
+     * @param image_data: The whole png file in memory.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param memory_resource: Memory resource the PNGFormat buffers will be allocated from.
      * @return
     */
-    void loadPNGImage(const std::filesystem::path& image_filepath);
+    void loadPNGImage
+    (
+        utils::typings::BytesView image_data,
+        const utils::typings::DecodeOptions& decode_options,
+        std::pmr::memory_resource* memory_resource
+    );
 
     // TODO: Load more formats
 
+    /*!
+     * startAsyncDecode
+     *
+     * @param decode: Decodes the image, run on the executor.
+     * @param executor: Where decode runs, if empty the shared thread pool is used.
+     * @return: The decode in flight.
+    */
+    [[nodiscard]] static AsyncDecode startAsyncDecode(std::function<ImageDecoder()> decode, utils::Executor executor);
+
+    /*!
+     * runTensorBatch
+     *
+     * @param images: Number of images in the batch.
+     * @param decode: Decodes the image at the index given, called from any thread.
+     * @param tensor_options: Tensor of each image.
+     * @param dest: Where the batch is written.
+     * @param executor: Where the decodes run, if empty the shared thread pool is used.
+     * @return
+    */
+    static void runTensorBatch
+    (
+        std::size_t images,
+        const std::function<ImageDecoder(std::size_t)>& decode,
+        const utils::typings::TensorOptions& tensor_options,
+        utils::typings::MutableBytesView dest,
+        const utils::Executor& executor
+    );
+
     /*!
      * getPNGVariantData
      *
@@ -69,4 +307,51 @@ private:
     std::variant<png_image_unique_ptr> m_data;
     utils::typings::ImageFormat m_image_format_type;
 }; // class ImageDecoder
+
+/*!
+ * AsyncDecode
+ *
+ * A decode started by ImageDecoder::decodeAsync, its result can be taken once,
+ * either by co_await (the coroutine is resumed on the executor's thread once the image is decoded)
+ * or through future() for callers not using coroutines. The first of them to ask gets it, any later co_await
+ * or future() throws std::future_error (future_already_retrieved), even while the decode is still running.
+ *
+ * Any exception thrown by the decode, utils::DecodeInterrupted included, is rethrown to whoever takes the result.
+*/
+class AsyncDecode
+{
+public:
+    AsyncDecode(AsyncDecode&&) noexcept = default;
+    AsyncDecode& operator=(AsyncDecode&&) noexcept = default;
+    AsyncDecode(const AsyncDecode&) = delete;
+    AsyncDecode& operator=(const AsyncDecode&) = delete;
+
+public:
+    /*!
+     * Awaitable interface.
+     *
+     * @throw future_error from await_resume if the result was already taken, or asked for through future().
+    */
+    [[nodiscard]] bool await_ready() const;
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> continuation);
+    [[nodiscard]] ImageDecoder await_resume();
+
+    /*!
+     * future
+     *
+     * @return: A future ready once the image is decoded.
+     * @throw future_error if the result was already taken, or is awaited by a coroutine.
+    */
+    [[nodiscard]] std::future<ImageDecoder> future();
+
+private:
+    friend class ImageDecoder;
+
+    struct State;
+
+    explicit AsyncDecode(std::shared_ptr<State> state) noexcept;
+
+private:
+    std::shared_ptr<State> m_state;
+}; // class AsyncDecode
 }
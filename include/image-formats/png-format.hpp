@@ -1,10 +1,21 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 
 #include "abstract-image-formats/abstract-image-formats.hpp"
+#include "utils/decode-stats.hpp"
+#include "utils/memory-accounting.hpp"
+#include "utils/memory-stream-buffer.hpp"
+#include "utils/pixel-kernels.hpp"
+#include "utils/tracing.hpp"
 
 namespace image_formats::png_format
 {
@@ -110,7 +121,14 @@ private:
 
 public:
     Scanlines() = default;
-    Scanlines(uint32_t scanline_size, uint32_t scanlines_size, uint8_t stride);
+    Scanlines
+    (
+        uint64_t scanline_size,
+        uint64_t scanlines_size,
+        uint8_t stride,
+        bool swap_byte_pairs = false,
+        bool reduce_to_8_bits = false
+    );
     Scanlines(const Scanlines&) = default;
     Scanlines(Scanlines&&) = default;
     Scanlines& operator=(const Scanlines&) = default;
@@ -122,9 +140,36 @@ public:
      *
      * Applies the necessary filter for each scanline.
      * @param filtered_data: Filtered data to be defiltered.
+     * @param defiltered_data: Vector where the defiltered data will be put on.
+     * @param decode_stats: Optional stats where the defilter time, bytes and filter types will be accumulated.
+     * @param decode_options: Optional options checked for interruption every ROWS_PER_INTERRUPTION_CHECK rows.
      * @return
+     *
+     * When the scanlines swap byte pairs, each row is swapped right after the next one is defiltered,
+     * the filters of a row read the previous one in its original order.
+     *
+     * When the scanlines reduce 16 bit samples to 8 bit, rows are defiltered into two rows kept aside
+     * and each one is written reduced to defiltered_data, which ends up half the size.
+     *
+     * @param row_visitor: Optional, called with each row of defiltered_data as soon as it's final,
+     * zeroed rows of truncated images included, 16 bit samples are still big endian.
+     * @throw DecodeInterrupted if the decode is interrupted.
+    */
+    void defilterData
+    (
+        utils::typings::CBytes& filtered_data,
+        utils::typings::Bytes& defiltered_data,
+        utils::DecodeStats* decode_stats = nullptr,
+        const utils::typings::DecodeOptions* decode_options = nullptr,
+        const std::function<void(const utils::typings::Byte* row)>& row_visitor = {}
+    );
+
+private:
+    /*!
+     * Rows defiltered between interruption checks, a check per row would cost more than the rows
+     * of small images, while a batch of even the widest rows still takes a few milliseconds at most.
     */
-    void defilterData(utils::typings::CBytes& filtered_data, utils::typings::Bytes& defiltered_data);
+    static constexpr uint32_t ROWS_PER_INTERRUPTION_CHECK { 64 };
 
 private:
     void defilterSubFilter(
@@ -163,14 +208,46 @@ private:
 private:
     uint8_t m_stride { 0 };
     utils::typings::Bytes::difference_type m_scanline_size { 0 };
-    uint32_t m_scanlines_size { 0 };
+    uint64_t m_scanlines_size { 0 };
+    bool m_swap_byte_pairs { false }; // Leaves 16 bit samples little endian.
+    bool m_reduce_to_8_bits { false }; // Rounds 16 bit samples to 8 bit.
 }; // Scalines
 
 
 class PNGFormat : abstract_image_formats::AbstractImageFormats
 {
 public:
-    PNGFormat(const std::filesystem::path& image_filepath);
+    /*!
+     * PNGFormat
+     *
+     * @param image_filepath: Image filepath.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param memory_resource: Memory resource every internal buffer (chunks, decompressed data,
+     * defiltered data and conversion caches) will be allocated from,
+     * it must outlive the PNGFormat object.
+    */
+    PNGFormat
+    (
+        const std::filesystem::path& image_filepath,
+        const utils::typings::DecodeOptions& decode_options = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
+
+    /*!
+     * PNGFormat
+     *
+     * @param image_data: The whole png file already in memory, it's read in place,
+     * so it only has to outlive the constructor.
+     * @param decode_options: Options changing how the image is decoded.
+     * @param memory_resource: Memory resource every internal buffer will be allocated from,
+     * it must outlive the PNGFormat object.
+    */
+    PNGFormat
+    (
+        utils::typings::BytesView image_data,
+        const utils::typings::DecodeOptions& decode_options = {},
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
     ~PNGFormat();
     PNGFormat(PNGFormat&&) = delete;
     PNGFormat(const PNGFormat&) = delete;
@@ -186,9 +263,25 @@ private:
     static constexpr uint16_t PLTE_CHUNK_MAX_SIZE            { 256 * 3 };
     static constexpr uint32_t IHDR_CHUNK_TYPE                { 0x49484452 };
 
+    /*!
+     * Buffers written to memory mapped files when decoding out of core, every buffer sized by the image,
+     * only the chunks and the state zlib allocates by itself (its 32 KiB window) stay on the heap.
+    */
+    static constexpr std::array OUT_OF_CORE_BUFFER_KINDS
+    {
+        utils::BufferKind::INFLATE_OUTPUT,
+        utils::BufferKind::DEFILTERED,
+        utils::BufferKind::RGB_CACHE,
+        utils::BufferKind::RGBA_CACHE
+    };
+
     struct Chunk
     {
-        utils::typings::Bytes m_chunk_type{utils::typings::Bytes(CHUNK_TYPE_FIELD_BYTES_SIZE)};
+        Chunk(std::pmr::memory_resource* memory_resource)
+            : m_chunk_type(CHUNK_TYPE_FIELD_BYTES_SIZE, memory_resource),
+              m_chunk_data(memory_resource) {}
+
+        utils::typings::Bytes m_chunk_type;
         utils::typings::Bytes m_chunk_data;
     };
 
@@ -209,28 +302,80 @@ public:
     /*!
      * AbstractImageFormats class members
     */
-    [[nodiscard]] uint32_t getImageScanlinesSize() const noexcept override;
-    [[nodiscard]] uint32_t getImageScanlineSize() const noexcept override;
-    [[nodiscard]] uint32_t getImageRGBScanlineSize() const noexcept override;
-    [[nodiscard]] uint32_t getImageRGBScanlinesSize() const noexcept override;
-    [[nodiscard]] uint32_t getImageRGBAScanlineSize() const noexcept override;
-    [[nodiscard]] uint32_t getImageRGBAScanlinesSize() const noexcept override;
+    [[nodiscard]] uint64_t getImageScanlinesSize() const noexcept override;
+    [[nodiscard]] uint64_t getImageScanlineSize() const noexcept override;
+    [[nodiscard]] uint64_t getImageRGBScanlineSize() const noexcept override;
+    [[nodiscard]] uint64_t getImageRGBScanlinesSize() const noexcept override;
+    [[nodiscard]] uint64_t getImageRGBAScanlineSize() const noexcept override;
+    [[nodiscard]] uint64_t getImageRGBAScanlinesSize() const noexcept override;
+    [[nodiscard]] uint64_t getImagePlaneRowSize() const noexcept override;
     [[nodiscard]] uint32_t getImageWidth() const noexcept override;
     [[nodiscard]] uint32_t getImageHeight() const noexcept override;
     [[nodiscard]] uint8_t getImageBitDepth() const noexcept override;
+    [[nodiscard]] utils::typings::ByteOrder getImageByteOrder() const noexcept override;
     [[nodiscard]] utils::typings::ImageColorType getImageColorType() const noexcept override;
     [[nodiscard]] uint8_t getImageNumberOfChannels() const override;
     [[nodiscard]] [[deprecated("Use getRawDataCopy instead.")]] utils::typings::CBytes& getRawDataConstRef() noexcept override;
     [[nodiscard]] utils::typings::Bytes getRawDataCopy() noexcept override;
     [[nodiscard]] uint8_t* getRawDataBuffer() noexcept override;
-    [[nodiscard]] utils::typings::Bytes getRawDataRGB() noexcept override;
-    [[nodiscard]] uint8_t* getRawDataRGBBuffer() noexcept override;
-    [[nodiscard]] utils::typings::Bytes getRawDataRGBA() noexcept override;
-    [[nodiscard]] uint8_t* getRawDataRGBABuffer() noexcept override;
+    [[nodiscard]] utils::typings::Bytes getRawDataRGB() override;
+    [[nodiscard]] uint8_t* getRawDataRGBBuffer() override;
+    [[nodiscard]] utils::typings::Bytes getRawDataRGBA() override;
+    [[nodiscard]] uint8_t* getRawDataRGBABuffer() override;
+    [[nodiscard]] utils::typings::BytesView getRawDataView() noexcept override;
+    [[nodiscard]] utils::typings::BytesView getRawDataRGBView() override;
+    [[nodiscard]] utils::typings::BytesView getRawDataRGBAView() override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataAligned(const utils::RowLayout& row_layout = {}) override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataRGBAligned(const utils::RowLayout& row_layout = {}) override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataRGBAAligned(const utils::RowLayout& row_layout = {}) override;
+    void convertRawDataInto
+    (
+        utils::typings::PixelFormat pixel_format,
+        utils::typings::MutableBytesView dest,
+        uint64_t stride = 0
+    ) override;
+    [[nodiscard]] utils::typings::Bytes getRawDataPixelFormat(utils::typings::PixelFormat pixel_format) override;
+    [[nodiscard]] utils::AlignedBuffer getRawDataPixelFormatAligned
+    (
+        utils::typings::PixelFormat pixel_format,
+        const utils::RowLayout& row_layout = {}
+    ) override;
+    [[nodiscard]] uint64_t getImageTensorSize(const utils::typings::TensorOptions& tensor_options) const noexcept override;
+    void convertRawDataToTensor
+    (
+        const utils::typings::TensorOptions& tensor_options,
+        utils::typings::MutableBytesView dest
+    ) override;
+    void convertRawDataIntoPlanes
+    (
+        const std::array<utils::typings::MutableBytesView, 4>& planes,
+        uint8_t channels,
+        uint64_t stride = 0
+    ) override;
+    [[nodiscard]] std::vector<utils::AlignedBuffer> getRawDataPlanes
+    (
+        uint8_t channels = 4,
+        const utils::RowLayout& row_layout = {}
+    ) override;
+    [[nodiscard]] utils::typings::Bytes takeRawData() override;
+    [[nodiscard]] utils::MemoryStats getMemoryStats() const noexcept override;
+    [[nodiscard]] utils::DecodeStats getDecodeStats() const noexcept override;
+    [[nodiscard]] utils::typings::ImageContent getImageContent() const noexcept override;
     void resetCachedData() noexcept override;
     void swapBytesOrder() noexcept override;
+    void setImageByteOrder(utils::typings::ByteOrder byte_order) noexcept override;
 
 private:
+    /*!
+     * decodeImage
+     *
+     * Reads every chunk from m_image_stream and defilters the image data,
+     * the stream must already be set by the constructor.
+     *
+     * @return
+    */
+    void decodeImage();
+
     /*!
      * readNBytes
      *
@@ -283,6 +428,20 @@ private:
     */
     void fillPLTEData(utils::typings::Bytes& data);
 
+    /*!
+     * fillTRNSData
+     *
+     * Keeps the transparency from the tRNS chunk, the alpha of each palette entry for indexed images,
+     * or the color (in the image's bit depth) taken as fully transparent for grayscale and rgb images.
+     * Images with an alpha channel can't have it, it's ignored for them.
+     *
+     * @param data: Vector containing data about the tRNS chunk.
+     *
+     * @return
+     * @throw runtime_error if the chunk's size doesn't fit the color type.
+    */
+    void fillTRNSData(utils::typings::Bytes& data);
+
     /*!
      * unpackData
      *
@@ -320,7 +479,8 @@ private:
     /*!
      * convertDataToRGB
      *
-     * Convert data from any color type to RGBA, if the color doesn't have a alpha channel it will be added.
+     * Convert data from any color type to RGBA, if the color doesn't have a alpha channel it will be added,
+     * taken from the tRNS chunk when there's one.
      * Each channel will be converted to 8 bits,
      * unless the original data bit depth is 16, in that case each channel will still have 16 bits.
      * @param src: Source data.
@@ -333,17 +493,264 @@ private:
         utils::typings::Bytes& dest
     ) const;
 
+    /*!
+     * expandRow
+     *
+     * Expands a row of any color type and bit depth to straight rgb or rgba, the alpha coming from
+     * the alpha channel or the tRNS chunk.
+     *
+     * @param src: The defiltered row.
+     * @param dest: Where the width * channels samples of the row are written, 8 bit samples (16 bit ones rounded)
+     * when Sample is Byte, 16 bit samples in the host's byte order when it's uint16_t (16 bit images only).
+     * @param channels: 3 for rgb, 4 for rgba.
+     * @return
+    */
+    template<typename Sample>
+    void expandRow
+    (
+        const utils::typings::Byte* src,
+        Sample* dest,
+        uint8_t channels = 4
+    ) const;
+
+    /*!
+     * convertRow
+     *
+     * Expands a row with expandRow, laid out as the rows of the rgb and rgba caches are.
+     *
+     * @param src: The defiltered row.
+     * @param dest: Where the width * channels samples of the row are written, 16 bit samples (16 bit images only)
+     * in the byte order the defiltered data is in right now.
+     * @param channels: 3 for rgb, 4 for rgba.
+     * @return
+    */
+    void convertRow
+    (
+        const utils::typings::Byte* src,
+        utils::typings::Byte* dest,
+        uint8_t channels
+    ) const;
+
+    /*!
+     * expandIndexedData
+     *
+     * Looks every index of an indexed image up in m_palette_rgba.
+     *
+     * @param src: The defiltered indices.
+     * @param dest: Vector where the rgb or rgba pixels will be put on.
+     * @param channels: 3 for rgb, 4 for rgba (with the alphas from tRNS).
+     * @return
+     * @throw out_of_range if src holds less rows than the image height.
+    */
+    void expandIndexedData
+    (
+        utils::typings::CBytes& src,
+        utils::typings::Bytes& dest,
+        uint8_t channels
+    ) const;
+
+    /*!
+     * fillPaletteRGBA
+     *
+     * Builds m_palette_rgba from the PLTE and tRNS chunks, indices past the end of the palette are opaque black.
+     *
+     * @return
+    */
+    void fillPaletteRGBA() noexcept;
+
+    /*!
+     * fillRGBCache
+     *
+     * Converts the defiltered data to rgb into the rgb cache, if it wasn't filled yet.
+     * Safe to call from many threads at once, only the first one converts, the others wait for it,
+     * after that it doesn't lock anymore.
+     *
+     * @return
+     * @throw runtime_error if the cache is empty and the defiltered data was taken by takeRawData.
+    */
+    void fillRGBCache();
+
+    /*!
+     * fillRGBACache
+     *
+     * Converts the defiltered data to rgba into the rgba cache, if it wasn't filled yet.
+     * Safe to call from many threads at once, only the first one converts, the others wait for it,
+     * after that it doesn't lock anymore.
+     *
+     * @return
+     * @throw runtime_error if the cache is empty and the defiltered data was taken by takeRawData.
+    */
+    void fillRGBACache();
+
+    /*!
+     * decodeStats
+     *
+     * @return: Pointer to the stats being collected, or null if the collection is off.
+    */
+    [[nodiscard]] utils::DecodeStats* decodeStats() noexcept;
+
+    /*!
+     * enforceDecodeLimits
+     *
+     * Checks the image against the pixel limit and the worst case memory of the decode against the budget,
+     * computed in 64 bits from IHDR, so it must be called right after IHDR is read.
+     *
+     * @return: The size of the inflated data (scanlines plus their filter type bytes).
+     * @throw DecodeLimitExceeded if the image goes over any limit.
+     * @throw runtime_error if the decoded image would be too large to address at all.
+    */
+    uint64_t enforceDecodeLimits() const;
+
+    /*!
+     * enforceMemoryBudget
+     *
+     * @param additional_bytes: Bytes about to be allocated.
+     * @param what: What is about to be allocated, used in the exception's message.
+     * @return
+     * @throw DecodeLimitExceeded if the bytes already held plus additional_bytes go over the memory budget.
+    */
+    void enforceMemoryBudget(uint64_t additional_bytes, const char* what) const;
+
+    /*!
+     * isOutOfCore
+     *
+     * @return: True if the buffers in OUT_OF_CORE_BUFFER_KINDS are memory mapped files
+     * (DecodeOptions::out_of_core_directory is set).
+    */
+    [[nodiscard]] bool isOutOfCore() const noexcept;
+
+    /*!
+     * defilteredDataResource
+     *
+     * The defiltered data may be handed over by takeRawData and outlive the decoder with its memory accounting,
+     * so it's allocated straight from the upstream (a mapped file when decoding out of core)
+     * and accounted by hand with MemoryAccounting::recordBuffer and MemoryAccounting::releaseBuffer.
+     *
+     * @return: Memory resource the defiltered data is allocated from.
+    */
+    [[nodiscard]] std::pmr::memory_resource* defilteredDataResource() const;
+
+    /*!
+     * reducesTo8Bits
+     *
+     * @return: True if the image has 16 bit samples still to be reduced to 8 bit while defiltering
+     * (DecodeOptions::reduce_to_8_bits is set).
+    */
+    [[nodiscard]] bool reducesTo8Bits() const noexcept;
+
+    /*!
+     * detectRowContent
+     *
+     * @param row: Row of defiltered data, 16 bit samples still big endian.
+     * @param bit_depth: Bit depth of the row's samples, 8 for rows reduced to 8 bit.
+     * @param sample_stats: Stats updated with the row's samples, only the largest one for indexed images.
+     * @param used_palette_entries: Entries the row's indices point to are set, for indexed images.
+     * @return
+    */
+    void detectRowContent
+    (
+        const utils::typings::Byte* row,
+        uint8_t bit_depth,
+        utils::kernels::SampleStats& sample_stats,
+        std::array<bool, 256>& used_palette_entries
+    ) const noexcept;
+
+    /*!
+     * finishImageContent
+     *
+     * Fills the detected flags of m_image_content once every row was seen,
+     * indexed images from the palette entries they use.
+     *
+     * @param sample_stats: Stats of every row.
+     * @param used_palette_entries: Palette entries used by every row.
+     * @return
+    */
+    void finishImageContent
+    (
+        const utils::kernels::SampleStats& sample_stats,
+        const std::array<bool, 256>& used_palette_entries
+    ) noexcept;
+
+    /*!
+     * reduceChannels
+     *
+     * Copies the defiltered data without the channels m_image_content makes redundant,
+     * see DecodeOptions::reduce_channels, and reports the image with the reduced color type from then on.
+     *
+     * @return
+    */
+    void reduceChannels();
+
+    /*!
+     * copyRowsAligned
+     *
+     * @param src: Tightly packed rows, one per image row.
+     * @param row_size: Bytes of each row in src.
+     * @param row_layout: Alignment and padding of the rows copied to.
+     * @return: The rows laid out as asked.
+     * @throw runtime_error if the row layout is invalid.
+     * @throw out_of_range if src holds less rows than the image height.
+    */
+    [[nodiscard]] utils::AlignedBuffer copyRowsAligned
+    (
+        utils::typings::BytesView src,
+        uint64_t row_size,
+        const utils::RowLayout& row_layout
+    ) const;
+
+    /*!
+     * convertRowsAligned
+     *
+     * Converts the defiltered data straight into rows laid out as asked, a row at a time with convertRow,
+     * so the rgb and rgba caches are neither filled nor read.
+     *
+     * @param channels: 3 for rgb, 4 for rgba.
+     * @param row_layout: Alignment and padding of the rows converted to.
+     * @return: The rows laid out as asked.
+     * @throw runtime_error if the row layout is invalid or the raw data was taken by takeRawData.
+    */
+    [[nodiscard]] utils::AlignedBuffer convertRowsAligned(uint8_t channels, const utils::RowLayout& row_layout) const;
+
 private:
-    std::ifstream m_image_stream;
-    utils::typings::Bytes m_signature { utils::typings::Bytes(SIGNATURE_FIELD_BYTES_SIZE) };
-    utils::typings::Bytes m_palette;
+    std::ifstream m_image_file;
+    std::optional<utils::MemoryStreamBuffer> m_image_memory;
+    std::istream m_image_stream { nullptr }; // Reads from m_image_file or m_image_memory.
+    utils::typings::DecodeOptions m_decode_options {};
+    utils::DecodeStats m_decode_stats {};
+    uint64_t m_image_id { utils::tracing::nextImageId() }; // Tells this image's trace spans from the others.
+    /*!
+     * Declared before every buffer, it must outlive them all.
+    */
+    utils::MemoryAccounting m_memory_accounting;
+    utils::typings::Bytes m_signature
+    {
+        utils::typings::Bytes(SIGNATURE_FIELD_BYTES_SIZE, m_memory_accounting.resource(utils::BufferKind::CHUNK))
+    };
+    utils::typings::Bytes m_palette { m_memory_accounting.resource(utils::BufferKind::CHUNK) };
+    utils::typings::Bytes m_palette_alphas { m_memory_accounting.resource(utils::BufferKind::CHUNK) }; // From tRNS.
+    /*!
+     * Every palette entry with its alpha, built once per image, so expanding an index is a single 4 byte copy
+     * (or gather), the bytes of each entry are red, green, blue and alpha in memory order.
+    */
+    alignas(64) std::array<uint32_t, 256> m_palette_rgba {};
+    std::optional<std::array<uint16_t, 3>> m_transparent_color; // From tRNS, grayscale only uses the first.
     IHDRChunk m_ihdr {};
     utils::typings::ImageColorType m_color_type { utils::typings::INVALID_COLOR_TYPE };
     uint8_t m_number_of_samples { 0 };
     uint8_t m_number_of_channels { 0 };
-    utils::typings::Bytes m_defiltered_data;
-    utils::typings::Bytes m_defiltered_data_rgb;
-    utils::typings::Bytes m_defiltered_data_rgba;
+    utils::typings::ByteOrder m_byte_order { utils::typings::ByteOrder::BIG }; // Of the 16 bit samples right now.
+    utils::typings::ImageContent m_image_content {};
+    utils::typings::Bytes m_defiltered_data { defilteredDataResource() };
+    utils::typings::Bytes m_defiltered_data_rgb { m_memory_accounting.resource(utils::BufferKind::RGB_CACHE) };
+    utils::typings::Bytes m_defiltered_data_rgba { m_memory_accounting.resource(utils::BufferKind::RGBA_CACHE) };
+    /*!
+     * Set (release) once a cache is filled, so readers seeing it set (acquire) also see the cache's content,
+     * the mutexes are only taken while the caches are being filled.
+    */
+    std::atomic<bool> m_rgb_cache_filled { false };
+    std::atomic<bool> m_rgba_cache_filled { false };
+    mutable std::mutex m_rgb_cache_mutex;
+    mutable std::mutex m_rgba_cache_mutex;
     Scanlines m_scanlines;
 }; // PNGFormat
 }; // namespace image_formats::png_format
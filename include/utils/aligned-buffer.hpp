@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace utils
+{
+/*!
+ * RowLayout
+ *
+ * How the rows of an AlignedBuffer are laid out.
+ *
+ * row_alignment: Every row starts at a multiple of it, a power of two, 64 (a cache line) by default,
+ * which is also what AVX-512 loads and most GPU copy engines want.
+ * row_padding: Extra bytes at least left after the pixels of each row (e.g. for kernels reading past the end).
+ * huge_pages: Asks the kernel to back buffers of at least HUGE_PAGE_SIZE with transparent huge pages,
+ * which cuts the page faults and TLB misses of big images, ignored where it isn't supported.
+*/
+struct RowLayout
+{
+    std::size_t row_alignment { 64 };
+    std::size_t row_padding { 0 };
+    bool huge_pages { false };
+}; // struct RowLayout
+
+/*!
+ * AlignedBuffer
+ *
+ * Owns rows of bytes, each one starting at a multiple of the row alignment, stride() bytes apart.
+ * The buffer itself is aligned to at least a cache line, so aligned loads can be used on it directly.
+ *
+ * The padding after the pixels of each row is zeroed, the pixels are left for whoever fills the buffer.
+*/
+class AlignedBuffer
+{
+public:
+    static constexpr std::size_t CACHE_LINE_SIZE { 64 };
+    static constexpr std::size_t HUGE_PAGE_SIZE { 2 * 1024 * 1024 };
+
+public:
+    AlignedBuffer() noexcept = default;
+
+    /*!
+     * AlignedBuffer
+     *
+     * @param row_size: Bytes of pixels in each row.
+     * @param rows: Number of rows.
+     * @param row_layout: Alignment and padding of the rows.
+     * @throw runtime_error if the row alignment isn't a power of two or the buffer would be too large.
+    */
+    AlignedBuffer(std::size_t row_size, std::size_t rows, const RowLayout& row_layout = {});
+    ~AlignedBuffer();
+    AlignedBuffer(AlignedBuffer&& other) noexcept;
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept;
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+public:
+    [[nodiscard]] std::byte* data() noexcept { return m_data; }
+    [[nodiscard]] const std::byte* data() const noexcept { return m_data; }
+
+    /*!
+     * size
+     *
+     * @return: Bytes of the whole buffer, stride() times rows(), padding included.
+    */
+    [[nodiscard]] std::size_t size() const noexcept { return m_stride * m_rows; }
+
+    /*!
+     * rowSize
+     *
+     * @return: Bytes of pixels in each row, without the padding.
+    */
+    [[nodiscard]] std::size_t rowSize() const noexcept { return m_row_size; }
+
+    /*!
+     * stride
+     *
+     * @return: Distance in bytes from the start of a row to the start of the next one.
+    */
+    [[nodiscard]] std::size_t stride() const noexcept { return m_stride; }
+    [[nodiscard]] std::size_t rows() const noexcept { return m_rows; }
+    [[nodiscard]] std::size_t alignment() const noexcept { return m_alignment; }
+
+    /*!
+     * row
+     *
+     * @param index: Row index, it isn't checked.
+     * @return: The pixels of the row, without the padding.
+    */
+    [[nodiscard]] std::span<std::byte> row(std::size_t index) noexcept
+    {
+        return { m_data + index * m_stride, m_row_size };
+    }
+
+    [[nodiscard]] std::span<const std::byte> row(std::size_t index) const noexcept
+    {
+        return { m_data + index * m_stride, m_row_size };
+    }
+
+private:
+    void release() noexcept;
+
+private:
+    std::byte* m_data { nullptr };
+    std::size_t m_row_size { 0 };
+    std::size_t m_stride { 0 };
+    std::size_t m_rows { 0 };
+    std::size_t m_alignment { 0 };
+}; // class AlignedBuffer
+} // namespace utils
@@ -2,6 +2,7 @@
 
 #include <bit>
 #include <iostream>
+#include <memory_resource>
 
 namespace debugging
 {
@@ -11,6 +12,10 @@ namespace debugging
  *
  * This file must be guarded to be added for debugging purposes only,
  * so there shouldn't be much of an issue.
+ *
+ * The allocator still forwards every request to a std::pmr::memory_resource,
+ * so a decoder built with DEBUG_ALLOCATOR honours the memory resource given to it
+ * exactly like the regular std::pmr::polymorphic_allocator does.
 */
 
 template<typename T>
@@ -20,10 +25,14 @@ public:
 
     using value_type = T;
 
-    DebugAllocator() = default;
+    DebugAllocator() noexcept = default;
+
+    DebugAllocator(std::pmr::memory_resource* memory_resource) noexcept
+        : m_allocator(memory_resource) {}
 
     template<typename U>
-    constexpr DebugAllocator(const DebugAllocator<U>&) noexcept {}
+    DebugAllocator(const DebugAllocator<U>& other) noexcept
+        : m_allocator(other.resource()) {}
 
 public:
     static void enableLogging()
@@ -36,9 +45,23 @@ public:
         m_enable_logging = false;
     }
 
+    /*!
+     * Same behaviour as std::pmr::polymorphic_allocator, copies of a container
+     * don't inherit the memory resource, they use the default one.
+    */
+    DebugAllocator select_on_container_copy_construction() const noexcept
+    {
+        return DebugAllocator();
+    }
+
+    std::pmr::memory_resource* resource() const noexcept
+    {
+        return m_allocator.resource();
+    }
+
     T* allocate(std::size_t n)
     {
-        T* ptr = std::allocator<T>{}.allocate(n);
+        T* ptr = m_allocator.allocate(n);
 
         if (m_enable_logging)
         {
@@ -67,10 +90,11 @@ public:
             << "\n";
         }
 
-        std::allocator<T>{}.deallocate(ptr, n);
+        m_allocator.deallocate(ptr, n);
     }
 
 private:
+    std::pmr::polymorphic_allocator<T> m_allocator;
     static bool m_enable_logging;
 };
 
@@ -78,9 +102,9 @@ template <typename T>
 bool DebugAllocator<T>::m_enable_logging = false;
 
 template <typename T, typename U>
-bool operator==(const DebugAllocator<T>&, const DebugAllocator<U>&) { return true; }
+bool operator==(const DebugAllocator<T>& lhs, const DebugAllocator<U>& rhs) { return *lhs.resource() == *rhs.resource(); }
 
 template<typename T, typename U>
-bool operator!=(const DebugAllocator<T>&, const DebugAllocator<U>&) { return false; }
+bool operator!=(const DebugAllocator<T>& lhs, const DebugAllocator<U>& rhs) { return not (lhs == rhs); }
 
 } // namespace debugging
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdexcept>
+
+namespace utils
+{
+/*!
+ * DecodeLimitExceeded
+ *
+ * Thrown when an image is bigger than DecodeOptions::max_pixels, or decoding it would take more memory
+ * than DecodeOptions::memory_budget_bytes, it's thrown before the memory is allocated.
+*/
+class DecodeLimitExceeded : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+}; // class DecodeLimitExceeded
+} // namespace utils
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace utils
+{
+/*!
+ * DecodeStats
+ *
+ * Where the time of a decode went, and how many bytes each stage processed,
+ * dividing one by the other gives the throughput of each stage.
+ *
+ * Only collected when DecodeOptions::collect_decode_stats is set,
+ * otherwise every field stays zeroed.
+*/
+struct DecodeStats
+{
+    /*!
+     * Time spent on each stage.
+     *
+     * The io, crc, inflate and defilter stages happen inside total_decode,
+     * the conversions are lazy, they're only made the first time rgb/rgba data is requested.
+    */
+    std::chrono::nanoseconds total_decode { 0 };
+    std::chrono::nanoseconds io { 0 };
+    std::chrono::nanoseconds crc { 0 };
+    std::chrono::nanoseconds inflate { 0 };
+    std::chrono::nanoseconds defilter { 0 };
+    std::chrono::nanoseconds rgb_conversion { 0 };
+    std::chrono::nanoseconds rgba_conversion { 0 };
+
+    /*!
+     * Bytes processed by each stage.
+    */
+    uint64_t chunks { 0 };               // Chunks read, IEND included.
+    uint64_t io_bytes { 0 };             // Bytes read from the file, signature included.
+    uint64_t crc_bytes { 0 };            // Bytes checked against the chunks' crc.
+    uint64_t compressed_bytes { 0 };     // IDAT bytes fed to zlib.
+    uint64_t inflated_bytes { 0 };       // Bytes zlib gave back, filter type bytes included.
+    uint64_t defiltered_bytes { 0 };     // Bytes written by the defilter.
+    uint64_t rgb_converted_bytes { 0 };  // Bytes written by the rgb conversion.
+    uint64_t rgba_converted_bytes { 0 }; // Bytes written by the rgba conversion.
+
+    /*!
+     * How many scanlines used each filter type, indexed by the filter type (None, Sub, Up, Average, Paeth).
+    */
+    std::array<uint64_t, 5> filter_type_rows {};
+}; // struct DecodeStats
+
+/*!
+ * StageTimer
+ *
+ * Adds the time elapsed between its construction and destruction to elapsed.
+ *
+ * If elapsed is null (stats collection is off) the clock is never read,
+ * the only cost left is checking the pointer.
+*/
+class StageTimer
+{
+public:
+    explicit StageTimer(std::chrono::nanoseconds* elapsed) noexcept
+        : m_elapsed(elapsed)
+    {
+        if (m_elapsed) { m_start = std::chrono::steady_clock::now(); }
+    }
+
+    ~StageTimer()
+    {
+        if (m_elapsed)
+        {
+            *m_elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>
+            (
+                std::chrono::steady_clock::now() - m_start
+            );
+        }
+    }
+
+    StageTimer(StageTimer&&) = delete;
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(StageTimer&&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    std::chrono::nanoseconds* m_elapsed { nullptr };
+    std::chrono::steady_clock::time_point m_start {};
+}; // class StageTimer
+} // namespace utils
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "utils/typings.hpp"
+
+namespace utils
+{
+/*!
+ * DecodeInterrupted
+ *
+ * Thrown when the decode stops before it's done, because it was cancelled or ran past its deadline,
+ * everything allocated so far is freed as the exception unwinds.
+*/
+class DecodeInterrupted : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+}; // class DecodeInterrupted
+
+/*!
+ * DecodeCancelled
+ *
+ * A stop was requested on DecodeOptions::stop_token.
+*/
+class DecodeCancelled : public DecodeInterrupted
+{
+public:
+    using DecodeInterrupted::DecodeInterrupted;
+}; // class DecodeCancelled
+
+/*!
+ * DecodeDeadlineExceeded
+ *
+ * DecodeOptions::deadline passed before the decode was done.
+*/
+class DecodeDeadlineExceeded : public DecodeInterrupted
+{
+public:
+    using DecodeInterrupted::DecodeInterrupted;
+}; // class DecodeDeadlineExceeded
+
+/*!
+ * throwIfInterrupted
+ *
+ * Called between units of work (chunks, rounds of inflate, batches of rows), never per byte,
+ * the clock is only read when there's a deadline.
+ *
+ * @param decode_options: Options of the decode being checked.
+ * @param where: Name of the stage checking, used in the exception's message.
+ * @return
+ * @throw DecodeCancelled if a stop was requested, DecodeDeadlineExceeded if the deadline passed.
+*/
+inline void throwIfInterrupted(const typings::DecodeOptions& decode_options, const char* where)
+{
+    if (decode_options.stop_token.stop_requested())
+    {
+        throw DecodeCancelled(where + std::string("\nDecode cancelled.\n"));
+    }
+
+    if (decode_options.deadline != typings::DecodeOptions::NO_DEADLINE
+        and std::chrono::steady_clock::now() >= decode_options.deadline)
+    {
+        throw DecodeDeadlineExceeded(where + std::string("\nDecode deadline exceeded.\n"));
+    }
+} // throwIfInterrupted
+} // namespace utils
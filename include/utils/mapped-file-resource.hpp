@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory_resource>
+
+namespace utils
+{
+/*!
+ * MappedFileResource
+ *
+ * Memory resource backing every allocation by its own memory mapped temporary file, so buffers larger than
+ * the memory available are paged in and out by the kernel instead of living on the heap.
+ *
+ * Each file is created already unlinked (O_TMPFILE, or mkstemp followed by unlink where it isn't supported),
+ * and only grown with ftruncate, so it's sparse, pages that are never written take no disk space.
+ * The file goes away when the mapping is freed, or when the process dies.
+ *
+ * Only available on POSIX systems, allocating elsewhere throws.
+*/
+class MappedFileResource : public std::pmr::memory_resource
+{
+public:
+    /*!
+     * MappedFileResource
+     *
+     * @param directory: Where the temporary files are created, it must be on a file system
+     * that supports memory mapping (not every network file system does).
+    */
+    explicit MappedFileResource(std::filesystem::path directory);
+    MappedFileResource(MappedFileResource&&) = delete;
+    MappedFileResource(const MappedFileResource&) = delete;
+    MappedFileResource& operator=(MappedFileResource&&) = delete;
+    MappedFileResource& operator=(const MappedFileResource&) = delete;
+
+public:
+    [[nodiscard]] const std::filesystem::path& directory() const noexcept;
+
+private:
+    /*!
+     * do_allocate
+     *
+     * @throw runtime_error if the file can't be created, grown or mapped.
+    */
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    std::filesystem::path m_directory;
+}; // class MappedFileResource
+
+/*!
+ * mappedFileResource
+ *
+ * A buffer may outlive whoever allocated it (e.g. one handed over by PNGFormat::takeRawData),
+ * so the resources are never destroyed, there's a single one per directory living as long as the process.
+ *
+ * @param directory: Where the temporary files are created.
+ * @return: The resource creating its files in directory.
+*/
+[[nodiscard]] std::pmr::memory_resource* mappedFileResource(const std::filesystem::path& directory);
+} // namespace utils
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+
+namespace utils
+{
+/*!
+ * BufferKind
+ *
+ * The logical buffers a decoder allocates, each one is accounted separately.
+ *
+ * This is enum is needed for the wrapper,
+ * any changes here must be reflected in image-decoder-wrapper.h
+*/
+enum class BufferKind : uint8_t
+{
+    CHUNK,          // Chunk type and data read from the file, the signature and the palette.
+    INFLATE_OUTPUT, // Zlib output buffer and the whole decompressed (still filtered) data.
+    DEFILTERED,     // Defiltered data, the image in its original color type.
+    RGB_CACHE,      // Cache of the image converted to rgb.
+    RGBA_CACHE,     // Cache of the image converted to rgba.
+}; // enum class BufferKind
+
+constexpr std::size_t NUMBER_OF_BUFFER_KINDS { 5 };
+
+/*!
+ * BufferMemoryStats
+ *
+ * A snapshot of the allocations of a buffer (or all of them).
+*/
+struct BufferMemoryStats
+{
+    uint64_t allocations { 0 };     // How many allocations were made.
+    uint64_t allocated_bytes { 0 }; // Sum of the bytes of every allocation made.
+    uint64_t current_bytes { 0 };   // Bytes still allocated.
+    uint64_t peak_bytes { 0 };      // Highest value current_bytes ever reached.
+}; // struct BufferMemoryStats
+
+/*!
+ * MemoryStats
+ *
+ * A snapshot of the allocations of all buffers, and broken down by each buffer kind,
+ * index buffers with static_cast<std::size_t>(BufferKind).
+ *
+ * The total peak isn't the sum of each buffer's peak, the buffers don't necessarily peak at the same time.
+*/
+struct MemoryStats
+{
+    BufferMemoryStats total {};
+    std::array<BufferMemoryStats, NUMBER_OF_BUFFER_KINDS> buffers {};
+}; // struct MemoryStats
+
+/*!
+ * MemoryAccounting
+ *
+ * Keeps track of every allocation made by a decoder, while forwarding them to an upstream memory resource.
+ *
+ * There's one std::pmr::memory_resource for each BufferKind, buffers must be created using the resource
+ * of their kind, so we know which logical buffer each allocation belongs to without having to tag them.
+ *
+ * The counters are relaxed atomics, they don't order any other memory operation,
+ * they're just cheap enough to be always on, and still correct when buffers
+ * are allocated or freed from different threads.
+ *
+ * The object must outlive every buffer created from its resources, and it can't be moved or copied,
+ * as the buffers hold pointers to the resources.
+*/
+class MemoryAccounting
+{
+public:
+    /*!
+     * MemoryAccounting
+     *
+     * @param upstream: Memory resource where the allocations will be forwarded to.
+    */
+    MemoryAccounting(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    MemoryAccounting(MemoryAccounting&&) = delete;
+    MemoryAccounting(const MemoryAccounting&) = delete;
+    MemoryAccounting& operator=(MemoryAccounting&&) = delete;
+    MemoryAccounting& operator=(const MemoryAccounting&) = delete;
+
+public:
+    /*!
+     * resource
+     *
+     * @param buffer_kind: The logical buffer which will be allocated from the memory resource.
+     * @return: A memory resource accounting the allocations as buffer_kind.
+    */
+    [[nodiscard]] std::pmr::memory_resource* resource(BufferKind buffer_kind) noexcept;
+
+    /*!
+     * upstream
+     *
+     * @return: Memory resource where the allocations are forwarded to.
+    */
+    [[nodiscard]] std::pmr::memory_resource* upstream() const noexcept;
+
+    /*!
+     * upstream
+     *
+     * @param buffer_kind: The logical buffer.
+     * @return: Memory resource where the allocations of buffer_kind are forwarded to.
+    */
+    [[nodiscard]] std::pmr::memory_resource* upstream(BufferKind buffer_kind) const noexcept;
+
+    /*!
+     * setUpstream
+     *
+     * Forwards the allocations of a single buffer kind somewhere else (e.g. a file backed resource),
+     * it must be called before anything of that kind is allocated.
+     *
+     * @param buffer_kind: The logical buffer.
+     * @param upstream: Memory resource where the allocations of buffer_kind will be forwarded to.
+     * @return
+    */
+    void setUpstream(BufferKind buffer_kind, std::pmr::memory_resource* upstream) noexcept;
+
+    /*!
+     * getMemoryStats
+     *
+     * @return: A snapshot of the counters, while other threads are allocating
+     * the fields may be slightly out of sync between themselves.
+    */
+    [[nodiscard]] MemoryStats getMemoryStats() const noexcept;
+
+    /*!
+     * recordBuffer
+     *
+     * Accounts bytes of a buffer allocated straight from the upstream resource of its kind,
+     * a buffer that may be handed over to someone else can't hold a pointer to the accounting resource,
+     * it would dangle once the accounting is gone.
+     *
+     * @param buffer_kind: The logical buffer.
+     * @param bytes: Bytes allocated by the buffer.
+     * @return
+    */
+    void recordBuffer(BufferKind buffer_kind, std::size_t bytes) noexcept;
+
+    /*!
+     * releaseBuffer
+     *
+     * Stops accounting bytes of a buffer recorded with recordBuffer, once it's freed or handed over.
+     *
+     * @param buffer_kind: The logical buffer.
+     * @param bytes: Bytes allocated by the buffer.
+     * @return
+    */
+    void releaseBuffer(BufferKind buffer_kind, std::size_t bytes) noexcept;
+
+private:
+    class Counters
+    {
+    public:
+        void recordAllocation(std::size_t bytes) noexcept;
+        void recordDeallocation(std::size_t bytes) noexcept;
+        [[nodiscard]] BufferMemoryStats snapshot() const noexcept;
+
+    private:
+        std::atomic<uint64_t> m_allocations { 0 };
+        std::atomic<uint64_t> m_allocated_bytes { 0 };
+        std::atomic<uint64_t> m_current_bytes { 0 };
+        std::atomic<uint64_t> m_peak_bytes { 0 };
+    }; // class Counters
+
+    class AccountedResource : public std::pmr::memory_resource
+    {
+    public:
+        AccountedResource() = default;
+        void setup(std::pmr::memory_resource* upstream, Counters* total, Counters* own) noexcept;
+        [[nodiscard]] std::pmr::memory_resource* upstream() const noexcept;
+
+    private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        std::pmr::memory_resource* m_upstream { nullptr };
+        Counters* m_total { nullptr };
+        Counters* m_own { nullptr };
+    }; // class AccountedResource
+
+private:
+    std::pmr::memory_resource* m_upstream { nullptr };
+    Counters m_total;
+    std::array<Counters, NUMBER_OF_BUFFER_KINDS> m_counters;
+    std::array<AccountedResource, NUMBER_OF_BUFFER_KINDS> m_resources;
+}; // class MemoryAccounting
+} // namespace utils
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <streambuf>
+
+#include "utils/typings.hpp"
+
+namespace utils
+{
+/*!
+ * MemoryStreamBuffer
+ *
+ * Read only stream buffer over bytes already in memory, lets an image in memory be
+ * read through a std::istream the same way a file is, without copying it first.
+ *
+ * The bytes aren't owned, they must outlive the stream buffer.
+*/
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+    MemoryStreamBuffer() noexcept = default;
+
+    explicit MemoryStreamBuffer(typings::BytesView data) noexcept
+    {
+        // The get area is never written to, the const_cast is only needed by the streambuf interface.
+        char* begin { const_cast<char*>(reinterpret_cast<const char*>(data.data())) };
+
+        setg(begin, begin, begin + data.size());
+    }
+
+    MemoryStreamBuffer(MemoryStreamBuffer&&) = delete;
+    MemoryStreamBuffer(const MemoryStreamBuffer&) = delete;
+    MemoryStreamBuffer& operator=(MemoryStreamBuffer&&) = delete;
+    MemoryStreamBuffer& operator=(const MemoryStreamBuffer&) = delete;
+}; // class MemoryStreamBuffer
+} // namespace utils
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "utils/typings.hpp"
+
+namespace utils::kernels
+{
+/*!
+ * Hot loops over whole images, each one has a scalar version and, on x86, SSSE3 and AVX2 versions
+ * picked at runtime from what the cpu supports, so the library still runs on any x86-64 cpu
+ * without having to be built with -march flags.
+*/
+
+/*!
+ * swapBytePairs
+ *
+ * Swaps the two bytes of every 16 bit sample, turning big endian samples into little endian ones and back.
+ *
+ * @param data: Samples to swap in place.
+ * @param size: Bytes of data, an odd last byte is left as is.
+ * @return
+*/
+void swapBytePairs(std::byte* data, std::size_t size) noexcept;
+
+// Parallel kernels don't start a thread for less than this, the cost of starting it would outweigh the work.
+inline constexpr std::size_t MIN_BYTES_PER_THREAD { 4 * 1024 * 1024 };
+
+/*!
+ * swapBytePairsParallel
+ *
+ * The same as swapBytePairs, split across threads for buffers of many times MIN_BYTES_PER_THREAD,
+ * smaller buffers (or when threads can't be started) are swapped by the calling thread alone.
+ *
+ * @param data: Samples to swap in place.
+ * @param size: Bytes of data, an odd last byte is left as is.
+ * @param max_threads: Most threads used, the calling thread included, 0 uses one per hardware thread.
+ * @return
+*/
+void swapBytePairsParallel(std::byte* data, std::size_t size, std::size_t max_threads = 0) noexcept;
+
+/*!
+ * reduce16To8
+ *
+ * Rounds big endian 16 bit samples to the nearest 8 bit ones, round(sample * 255 / 65535).
+ *
+ * @param src: Samples to reduce, 2 * samples bytes.
+ * @param dest: Where the reduced samples are written, samples bytes, it must not overlap src.
+ * @param samples: Number of samples.
+ * @return
+*/
+void reduce16To8(const std::byte* src, std::byte* dest, std::size_t samples) noexcept;
+
+/*!
+ * rgbaToPixelFormat
+ *
+ * Converts straight 8 bit rgba pixels to pixel_format, swizzling and premultiplying in the same pass.
+ *
+ * @param src: Pixels to convert, 4 * pixels bytes.
+ * @param dest: Where the converted pixels are written, 4 * pixels bytes, it must not overlap src.
+ * @param pixels: Number of pixels.
+ * @param pixel_format: Layout of the converted pixels.
+ * @return
+*/
+void rgbaToPixelFormat
+(
+    const std::byte* src,
+    std::byte* dest,
+    std::size_t pixels,
+    typings::PixelFormat pixel_format
+) noexcept;
+
+/*!
+ * rgbToPixelFormat
+ *
+ * Converts 8 bit rgb pixels to pixel_format, as if they had an opaque alpha.
+ *
+ * @param src: Pixels to convert, 3 * pixels bytes.
+ * @param dest: Where the converted pixels are written, 4 * pixels bytes, it must not overlap src.
+ * @param pixels: Number of pixels.
+ * @param pixel_format: Layout of the converted pixels.
+ * @return
+*/
+void rgbToPixelFormat
+(
+    const std::byte* src,
+    std::byte* dest,
+    std::size_t pixels,
+    typings::PixelFormat pixel_format
+) noexcept;
+
+/*!
+ * samplesToFloats
+ *
+ * Converts interleaved samples to floats, sample * scale[channel] + offset[channel].
+ *
+ * @param src: Samples to convert, one byte each, or two (in the host's byte order) if wide.
+ * @param wide: True for 16 bit samples.
+ * @param dest: Where count floats are written, it must not overlap src.
+ * @param count: Number of samples, pixels * channels.
+ * @param channels: Channels per pixel, 1 to 4, the sample at index i belongs to channel i % channels.
+ * @param scale: Factor of each channel.
+ * @param offset: Added to each channel after scaling.
+ * @return
+*/
+void samplesToFloats
+(
+    const std::byte* src,
+    bool wide,
+    float* dest,
+    std::size_t count,
+    std::size_t channels,
+    const std::array<float, 4>& scale,
+    const std::array<float, 4>& offset
+) noexcept;
+
+/*!
+ * convertFloats
+ *
+ * Writes floats as tensor elements of data_type, FLOAT16 and BFLOAT16 rounded to the nearest even.
+ *
+ * @param src: Floats to convert.
+ * @param dest: Where the count elements are written, it must not overlap src.
+ * @param count: Number of floats.
+ * @param data_type: Type of the elements written.
+ * @return
+*/
+void convertFloats(const float* src, std::byte* dest, std::size_t count, typings::TensorDataType data_type) noexcept;
+
+/*!
+ * deinterleaveSamples
+ *
+ * Splits interleaved samples into one plane per channel.
+ *
+ * @param src: Interleaved samples, pixels * channels of them.
+ * @param sample_size: Bytes per sample, 1 or 2.
+ * @param channels: Channels per pixel, 1 to 4.
+ * @param pixels: Number of pixels.
+ * @param planes: Where the samples of each channel are written, pixels samples each,
+ * only the first channels of them are used.
+ * @return
+*/
+void deinterleaveSamples
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept;
+
+/*!
+ * expandPaletteIndices
+ *
+ * Looks palette indices up into their colors, a single 4 byte copy per pixel (a gather of 8 at a time with AVX2),
+ * indices of less than 8 bits are taken a whole byte at a time.
+ *
+ * @param src: Indices packed from the most significant bits of each byte, as png stores them.
+ * @param bit_depth: Bits per index, 1, 2, 4 or 8.
+ * @param pixels: Number of pixels.
+ * @param palette: The 256 colors, the bytes of each one are red, green, blue and alpha in memory order.
+ * @param dest: Where channels * pixels bytes are written, it must not overlap src.
+ * @param channels: 3 for rgb, 4 for rgba.
+ * @return
+*/
+void expandPaletteIndices
+(
+    const std::byte* src,
+    std::size_t bit_depth,
+    std::size_t pixels,
+    const std::array<uint32_t, 256>& palette,
+    std::byte* dest,
+    std::size_t channels
+) noexcept;
+
+/*!
+ * SampleStats
+ *
+ * What the pixels seen so far use, accumulated by accumulateSampleStats starting from the defaults.
+ *
+ * opaque: Every alpha sample is the largest one, stays true without alpha.
+ * gray: Red, green and blue are equal in every pixel, stays true without them.
+ * max_sample: Largest sample, alpha left out.
+*/
+struct SampleStats
+{
+    bool opaque { true };
+    bool gray { true };
+    uint16_t max_sample { 0 };
+}; // struct SampleStats
+
+/*!
+ * accumulateSampleStats
+ *
+ * @param src: Interleaved samples, one byte each, or two big endian ones (as png stores them).
+ * @param sample_size: Bytes per sample, 1 or 2.
+ * @param channels: 1 (gray), 2 (gray and alpha), 3 (rgb) or 4 (rgba).
+ * @param pixels: Number of pixels.
+ * @param stats: Stats updated with these pixels.
+ * @return
+*/
+void accumulateSampleStats
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    SampleStats& stats
+) noexcept;
+} // namespace utils::kernels
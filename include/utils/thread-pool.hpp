@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+/*!
+ * Executor
+ *
+ * Runs the task it's given somewhere else, e.g. [&pool](auto task) { pool.submit(std::move(task)); },
+ * or hands it to whatever executor the caller already has.
+*/
+using Executor = std::function<void(std::function<void()>)>;
+
+/*!
+ * ThreadPool
+ *
+ * Fixed number of worker threads running the tasks submitted, in the order they were submitted.
+ *
+ * Tasks must not throw, an exception escaping a task calls std::terminate (as it would on any std::thread),
+ * report failures through whatever the task writes its result to.
+*/
+class ThreadPool
+{
+public:
+    /*!
+     * ThreadPool
+     *
+     * @param number_of_threads: Worker threads started, 0 starts one per hardware thread.
+    */
+    explicit ThreadPool(std::size_t number_of_threads = 0);
+
+    /*!
+     * ~ThreadPool
+     *
+     * Runs every task already submitted, then joins the workers.
+    */
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+    /*!
+     * submit
+     *
+     * @param task: Run by the first worker free.
+     * @return
+    */
+    void submit(std::function<void()> task);
+
+    /*!
+     * size
+     *
+     * @return: Number of worker threads.
+    */
+    [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+    /*!
+     * workerLoop
+     *
+     * Runs tasks until the pool is being destroyed and there are no tasks left,
+     * noexcept so a task throwing terminates right where it threw.
+     *
+     * @return
+    */
+    void workerLoop() noexcept;
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_task_available;
+    std::deque<std::function<void()>> m_tasks;
+    bool m_stopping { false };
+    std::vector<std::thread> m_workers;
+}; // class ThreadPool
+} // namespace utils
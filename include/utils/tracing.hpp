@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+namespace utils::tracing
+{
+/*!
+ * A tracing sink recording when each decoding stage begins and ends, on which thread
+ * and for which image, written as Chrome trace-event JSON, which can be opened
+ * in chrome://tracing or https://ui.perfetto.dev to see how the decodes of many threads overlap.
+ *
+ * The format is documented at:
+ * https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ *
+ * Every thread records its spans into its own buffer, the only synchronization on the recording path
+ * is a release store publishing each event, so tracing doesn't distort much the timings it's measuring.
+ * The buffers are only read when tracing stops and the JSON is written.
+ *
+ * When tracing is off, a TraceScope costs a relaxed atomic load.
+*/
+
+/*!
+ * TraceStage
+ *
+ * The stages a span can belong to.
+*/
+enum class TraceStage : uint8_t
+{
+    DECODE,     // The whole decode, from opening the file to the defiltered data.
+    CHUNK_READ, // Reading a chunk from the file.
+    CRC,        // Checking a chunk's crc.
+    INFLATE,    // Decompressing an IDAT chunk.
+    DEFILTER,   // Defiltering all scanlines.
+    CONVERSION, // Converting the defiltered data to another color type.
+    CACHE_FILL, // Filling a conversion cache, the conversion included.
+}; // enum class TraceStage
+
+/*!
+ * startTracing
+ *
+ * Starts recording spans, any span recorded by a previous session is discarded.
+ *
+ * @param output_filepath: File where the trace-event JSON will be written once stopTracing is called.
+ * @return
+ * @throw runtime_error if tracing is already on.
+*/
+void startTracing(const std::filesystem::path& output_filepath);
+
+/*!
+ * stopTracing
+ *
+ * Stops recording spans and writes all of them to the file given to startTracing.
+ * Spans still open on other threads when it's called won't be in the file.
+ *
+ * @return
+ * @throw runtime_error if tracing is off or if the file can't be written.
+*/
+void stopTracing();
+
+/*!
+ * isTracing
+ *
+ * @return: True if spans are being recorded.
+*/
+[[nodiscard]] bool isTracing() noexcept;
+
+/*!
+ * nextImageId
+ *
+ * @return: An unique id to tell the spans of one image from the others.
+*/
+[[nodiscard]] uint64_t nextImageId() noexcept;
+
+/*!
+ * TraceScope
+ *
+ * Records a span of stage for image_id, beginning at its construction and ending at its destruction.
+ * If tracing is off when it's constructed, nothing is recorded.
+*/
+class TraceScope
+{
+public:
+    TraceScope(TraceStage stage, uint64_t image_id) noexcept;
+    ~TraceScope();
+
+    TraceScope(TraceScope&&) = delete;
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(TraceScope&&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    TraceStage m_stage;
+    uint64_t m_image_id { 0 };
+    int64_t m_begin_nanoseconds { -1 }; // Negative when tracing was off.
+}; // class TraceScope
+} // namespace utils::tracing
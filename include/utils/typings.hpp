@@ -1,5 +1,17 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #ifdef DEBUG_ALLOCATOR
@@ -27,20 +39,91 @@ namespace utils::typings
 
 using Byte = std::byte;
 
+/*!
+ * DefaultInitAllocator
+ *
+ * Wraps an allocator so elements constructed without a value are default initialized instead of value initialized,
+ * for bytes it means resize() leaves the new bytes as they are instead of zeroing them.
+ * The decoder sizes its buffers exactly and then writes every byte by index, zeroing them first would
+ * just touch the whole image one more time (and fault every page of it in) for nothing.
+ *
+ * Everything else (copies, insert, emplace_back with a value) is forwarded to the wrapped allocator.
+*/
+template<typename Allocator>
+class DefaultInitAllocator : public Allocator
+{
+    using Traits = std::allocator_traits<Allocator>;
+
+public:
+    template<typename U>
+    struct rebind
+    {
+        using other = DefaultInitAllocator<typename Traits::template rebind_alloc<U>>;
+    };
+
+public:
+    using Allocator::Allocator;
+
+    DefaultInitAllocator() noexcept = default;
+
+    DefaultInitAllocator(const Allocator& allocator) noexcept : Allocator(allocator) {}
+
+    template<typename OtherAllocator>
+    DefaultInitAllocator(const DefaultInitAllocator<OtherAllocator>& other) noexcept
+        : Allocator(static_cast<const OtherAllocator&>(other)) {}
+
+public:
+    DefaultInitAllocator select_on_container_copy_construction() const
+    {
+        return Traits::select_on_container_copy_construction(static_cast<const Allocator&>(*this));
+    }
+
+    template<typename U>
+    void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+    {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template<typename U, typename... Args>
+    void construct(U* ptr, Args&&... args)
+    {
+        Traits::construct(static_cast<Allocator&>(*this), ptr, std::forward<Args>(args)...);
+    }
+}; // class DefaultInitAllocator
+
+#ifdef DEBUG_ALLOCATOR
+using BytesAllocator = DefaultInitAllocator<debugging::DebugAllocator<Byte>>;
+#else
+using BytesAllocator = DefaultInitAllocator<std::pmr::polymorphic_allocator<Byte>>;
+#endif // DEBUG_ALLOCATOR
+
 /*!
  * We could use std::array for most part of the program where
  * a structure has a fixed size, as signature, chunk types, etc.
  * But for any other dynamic chain of bytes handling and passing std::array
  * is really not viable, so we use std::vector instead.
+ *
+ * The vector allocates through a std::pmr::polymorphic_allocator, this way whoever creates
+ * the decoder can hand it a std::pmr::memory_resource (a per-request arena, a pool, etc.)
+ * and every buffer created while decoding will be carved out of it.
+ * When no resource is given, std::pmr::get_default_resource() is used, which is the global heap.
+ *
+ * Copies of a Bytes (like the ones returned by getRawDataCopy) don't inherit the memory resource,
+ * they always use the default one, so they can safely outlive the resource the decoder used.
 */
-#ifdef DEBUG_ALLOCATOR
-using BytesAllocator = debugging::DebugAllocator<Byte>;
 using Bytes = std::vector<Byte, BytesAllocator>;
 using CBytes = const Bytes;
-#else
-using Bytes = std::vector<Byte>;
-using CBytes = const Bytes;
-#endif // LOGGING_ALLOCATOR
+
+/*!
+ * A read only view into bytes owned by someone else (usually the decoder), nothing is copied,
+ * it's only valid while the owner is alive and doesn't change the bytes it points to.
+*/
+using BytesView = std::span<const Byte>;
+
+/*!
+ * A writable view into bytes owned by someone else, like a buffer the caller wants pixels written to.
+*/
+using MutableBytesView = std::span<Byte>;
 
 /*!
  * This is enum is needed for the wrapper,
@@ -56,6 +139,208 @@ enum ImageColorType
     RGBA_COLOR_TYPE,
 }; // enum ImageColorType
 
+/*!
+ * ByteOrder
+ *
+ * Order of the two bytes of 16 bit samples, png stores them big endian.
+ * NATIVE is whichever of the two the host uses.
+*/
+enum class ByteOrder : uint8_t
+{
+    BIG,
+    LITTLE,
+    NATIVE = (std::endian::native == std::endian::little) ? LITTLE : BIG,
+}; // enum class ByteOrder
+
+/*!
+ * PixelFormat
+ *
+ * Layouts the pixels can be converted to in a single pass, for consumers that upload them as is.
+ * Every format is four bytes per pixel, eight bits per channel (16 bit samples are rounded to 8 bit),
+ * named in the order the bytes are in memory.
+ *
+ * RGBA, BGRA, ARGB: Straight (non premultiplied) alpha.
+ * RGBA_PREMULTIPLIED, BGRA_PREMULTIPLIED: Colors multiplied by alpha, what Skia and most compositors blend.
+ * XRGB: The first byte is padding, always 0xFF, the alpha is dropped.
+ *
+ * Alpha comes from the image's alpha channel, or from its tRNS chunk (palette alphas or a transparent color),
+ * images with neither are opaque.
+*/
+enum class PixelFormat : uint8_t
+{
+    RGBA,
+    BGRA,
+    ARGB,
+    RGBA_PREMULTIPLIED,
+    BGRA_PREMULTIPLIED,
+    XRGB,
+}; // enum class PixelFormat
+
+/*!
+ * TensorDataType
+ *
+ * Type of the elements of a tensor, FLOAT16 is IEEE half precision and BFLOAT16 is the upper half of a float32,
+ * both rounded to the nearest even.
+*/
+enum class TensorDataType : uint8_t
+{
+    FLOAT32,
+    FLOAT16,
+    BFLOAT16,
+}; // enum class TensorDataType
+
+/*!
+ * TensorLayout
+ *
+ * HWC: Rows of pixels, the channels of each pixel next to each other.
+ * CHW: A plane per channel, each one rows of that channel alone.
+*/
+enum class TensorLayout : uint8_t
+{
+    HWC,
+    CHW,
+}; // enum class TensorLayout
+
+/*!
+ * TensorFit
+ *
+ * EXACT: The tensor has the image's size.
+ * CENTER_CROP_OR_PAD: The image is centered in the tensor, cropping the sides that don't fit and padding the ones
+ * that aren't covered, each dimension separately (e.g. a wider but shorter image is cropped and padded).
+*/
+enum class TensorFit : uint8_t
+{
+    EXACT,
+    CENTER_CROP_OR_PAD,
+}; // enum class TensorFit
+
+/*!
+ * TensorOptions
+ *
+ * How the pixels are written as a tensor, every element being sample / max_sample * scale[channel] + offset[channel],
+ * where max_sample is 255 or 65535 (16 bit images keep their precision), so by default they go from 0 to 1.
+ * For mean and standard deviation normalization use scale = 1 / std and offset = -mean / std.
+ *
+ * channels: 3 (red, green, blue) or 4 (red, green, blue, alpha), whatever the image's color type,
+ * the alpha comes from the alpha channel or the tRNS chunk.
+ * width, height: Size of the tensor, 0 takes the image's, anything else must match it unless fit crops or pads.
+ * pad_value: Element written where fit pads, as is, neither scaled nor offset.
+*/
+struct TensorOptions
+{
+    TensorDataType data_type { TensorDataType::FLOAT32 };
+    TensorLayout layout { TensorLayout::HWC };
+    uint8_t channels { 3 };
+    std::array<float, 4> scale { 1.0f, 1.0f, 1.0f, 1.0f };
+    std::array<float, 4> offset { 0.0f, 0.0f, 0.0f, 0.0f };
+    uint32_t width { 0 };
+    uint32_t height { 0 };
+    TensorFit fit { TensorFit::EXACT };
+    float pad_value { 0.0f };
+}; // struct TensorOptions
+
+/*!
+ * DecodeOptions
+ *
+ * Knobs changing how an image gets decoded, the defaults decode as fast as possible.
+*/
+struct DecodeOptions
+{
+    /*!
+     * Measure the time spent and bytes processed by each decoding stage (see utils/decode-stats.hpp).
+     * When false nothing is measured.
+    */
+    bool collect_decode_stats { false };
+
+    /*!
+     * Stops the decode early once a stop is requested, checked between chunks, rounds of inflate
+     * and batches of rows, the decode then throws utils::DecodeCancelled (see utils/interruption.hpp).
+     * The default token can't be stopped.
+    */
+    std::stop_token stop_token {};
+
+    /*!
+     * Stops the decode early once this point in time passes, checked as often as stop_token,
+     * the decode then throws utils::DecodeDeadlineExceeded.
+    */
+    static constexpr std::chrono::steady_clock::time_point NO_DEADLINE { std::chrono::steady_clock::time_point::max() };
+    std::chrono::steady_clock::time_point deadline { NO_DEADLINE };
+
+    /*!
+     * Limits checked right after IHDR, before any buffer sized by the image is allocated, 0 means no limit,
+     * going over either throws utils::DecodeLimitExceeded (see utils/decode-limits.hpp).
+     *
+     * max_pixels: Width times height.
+     * memory_budget_bytes: Bytes the decoder may hold at once, the worst case of the decode (inflated and defiltered
+     * data together) is checked after IHDR, chunks before they're read, and each conversion cache before it's filled.
+    */
+    uint64_t max_pixels { 0 };
+    uint64_t memory_budget_bytes { 0 };
+
+    /*!
+     * When not empty, the inflated data, the defiltered data and the rgb and rgba caches are written to sparse
+     * memory mapped temporary files created in this directory (see utils/mapped-file-resource.hpp) instead of the heap,
+     * so images larger than the memory available can still be decoded, the kernel pages them in and out.
+     *
+     * Those buffers don't count against memory_budget_bytes, only what stays on the heap (the chunks) does,
+     * the budget still caps the inflated data at the size IHDR declares, so it can't fill the disk either.
+    */
+    std::filesystem::path out_of_core_directory {};
+
+    /*!
+     * Byte order of 16 bit samples in the decoded data and every conversion made from it.
+     * Anything but BIG is swapped while defiltering, each row as soon as the next one (which reads it
+     * unswapped) is defiltered, while it's still in cache, so there's no extra pass over the image.
+    */
+    ByteOrder byte_order { ByteOrder::BIG };
+
+    /*!
+     * Rounds 16 bit samples to 8 bit ones while defiltering, each row as soon as it's defiltered,
+     * so the decoded data (and every conversion made from it) takes half the memory and a 16 bit copy
+     * of the whole image is never held, the image is reported as 8 bit deep from then on.
+     * Images of 8 bits or less are left as is, byte_order doesn't apply to reduced images.
+    */
+    bool reduce_to_8_bits { false };
+
+    /*!
+     * Finds out whether the image is opaque, gray and its largest sample while defiltering,
+     * with vector reductions over each row while it's still in cache, see ImageContent.
+     * When false the image content is left at its conservative defaults.
+    */
+    bool detect_content { false };
+
+    /*!
+     * Drops the channels the detected content makes redundant (detect_content is implied) once the image
+     * is decoded, the image is then reported with the reduced color type and every size and conversion follows
+     * from it: opaque rgba becomes rgb, gray rgba becomes gray and alpha, and gray rgb, opaque gray and alpha
+     * or opaque gray rgba become gray. Indexed images, images with a tRNS transparent color
+     * and images of less than 8 bits are left as they are.
+    */
+    bool reduce_channels { false };
+}; // struct DecodeOptions
+
+/*!
+ * ImageContent
+ *
+ * What the pixels of an image actually use, detected while decoding when DecodeOptions::detect_content
+ * or DecodeOptions::reduce_channels is set, otherwise every flag keeps its conservative default.
+ *
+ * opaque: Every pixel is fully opaque, true for images without alpha, while a tRNS transparent color
+ * makes it false even if no pixel has that color.
+ * gray: Red, green and blue are equal in every pixel, true for grayscale images.
+ * max_sample: Largest color sample (alpha left out) at the image's bit depth.
+ * Indexed images report the palette entries their pixels use, so max_sample is 8 bit.
+ * original_color_type: Color type the image was encoded with, always set, it only differs
+ * from the image's color type when DecodeOptions::reduce_channels dropped channels.
+*/
+struct ImageContent
+{
+    bool opaque { false };
+    bool gray { false };
+    uint16_t max_sample { 0xFFFF };
+    ImageColorType original_color_type { INVALID_COLOR_TYPE };
+}; // struct ImageContent
+
 /*!
  * Some types and type aliases for easy of documentation.
 */
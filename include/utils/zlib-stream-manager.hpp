@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <memory_resource>
 #include <zlib.h>
 
+#include "utils/decode-stats.hpp"
 #include "utils/typings.hpp"
 
 namespace utils
@@ -14,8 +17,13 @@ public:
      * ZlibStreamManager
      *
      * @param output_chunk_size: Specify how many bytes will be outputed to the output buffer at time.
+     * @param memory_resource: Memory resource the internal output buffer will be allocated from.
     */
-    ZlibStreamManager(uint32_t buffer_size = 4096);
+    ZlibStreamManager
+    (
+        uint32_t buffer_size = 4096,
+        std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource()
+    );
     ~ZlibStreamManager();
     ZlibStreamManager(ZlibStreamManager&&);
     ZlibStreamManager& operator=(ZlibStreamManager&&);
@@ -27,14 +35,35 @@ public:
      *
      * @param compressed_data: Zlib compressed data bytes vector.
      * @param decompressed_data: Output vector for the decompressed data bytes.
+     * @param decode_stats: Optional stats where the inflate time and bytes will be accumulated.
+     * @param decode_options: Optional options checked for interruption every INFLATE_ROUNDS_PER_INTERRUPTION_CHECK
+     * rounds, a single small chunk may inflate to gigabytes.
      * @return
+     * @throw DecodeInterrupted if the decode is interrupted.
     */
     void decompressData
     (
         typings::CBytes& compressed_data,
-        typings::Bytes& decompressed_data
+        typings::Bytes& decompressed_data,
+        DecodeStats* decode_stats = nullptr,
+        const typings::DecodeOptions* decode_options = nullptr
     );
 
+    /*!
+     * setOutputLimit
+     *
+     * @param output_limit: Most bytes decompressData may leave in its output vector,
+     * going over it throws DecodeLimitExceeded before the bytes are appended.
+     * @return
+    */
+    void setOutputLimit(std::size_t output_limit) noexcept;
+
+private:
+    /*!
+     * Each round fills the output buffer at most once (4096 bytes by default).
+    */
+    static constexpr uint32_t INFLATE_ROUNDS_PER_INTERRUPTION_CHECK { 64 };
+
 private:
     /*!
      * growBuffer
@@ -60,5 +89,6 @@ private:
         .opaque = Z_NULL
     };
     utils::typings::Bytes m_buffer;
+    std::size_t m_output_limit { SIZE_MAX };
 }; // class ZlibStreamManager
 } // namespace utils
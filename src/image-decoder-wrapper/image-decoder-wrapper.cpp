@@ -1,11 +1,376 @@
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
 #include "image-decoder/image-decoder.hpp"
 #include "image-decoder-wrapper/image-decoder-wrapper.h"
+#include "utils/decode-limits.hpp"
+#include "utils/interruption.hpp"
+#include "utils/thread-pool.hpp"
+#include "utils/tracing.hpp"
+
+static_assert
+(
+    NUMBER_OF_BUFFER_KINDS == utils::NUMBER_OF_BUFFER_KINDS,
+    "BufferKind in image-decoder-wrapper.h is out of sync with utils/memory-accounting.hpp"
+);
 
 struct ImageDecoderWrapper
 {
     image_decoder::ImageDecoder* image_decoder;
 };
 
+struct DecodeCancellationToken
+{
+    std::stop_source stop_source;
+};
+
+struct DecodeThreadPool
+{
+    explicit DecodeThreadPool(size_t number_of_threads) : thread_pool(number_of_threads) {}
+
+    utils::ThreadPool thread_pool;
+};
+
+struct DecodeRequestHandle
+{
+    DecodeRequest request {};
+    utils::typings::DecodeOptions decode_options {};
+    std::string image_filepath;
+    DecodeCallback callback { nullptr };
+    void* user_data { nullptr };
+    /*!
+     * Kept when the request has no buffer, so its pixels can be borrowed.
+    */
+    std::unique_ptr<image_decoder::ImageDecoder> image_decoder;
+    DecodeResult result {};
+    std::mutex mutex;
+    std::condition_variable done_condition;
+    bool done { false };
+    /*!
+     * One held by the caller and one by the worker, whoever releases it last deletes it.
+    */
+    std::atomic<int> references { 2 };
+};
+
+/*!
+ * toDecodeOptions
+ *
+ * Called when the decode is requested, the deadline counts from then.
+ *
+ * @param options: Optional C options, if null the default options are used.
+ * @return: The ImageDecoder equivalent of the C options.
+*/
+static utils::typings::DecodeOptions toDecodeOptions(const ImageDecoderOptions* options)
+{
+    utils::typings::DecodeOptions decode_options {};
+
+    if (not options) { return decode_options; }
+
+    decode_options.collect_decode_stats = options->collect_decode_stats != 0;
+    decode_options.max_pixels = options->max_pixels;
+    decode_options.memory_budget_bytes = options->memory_budget_bytes;
+
+    if (options->out_of_core_directory) { decode_options.out_of_core_directory = options->out_of_core_directory; }
+
+    if (options->native_byte_order) { decode_options.byte_order = utils::typings::ByteOrder::NATIVE; }
+
+    decode_options.reduce_to_8_bits = options->reduce_to_8_bits != 0;
+    decode_options.detect_content = options->detect_content != 0;
+    decode_options.reduce_channels = options->reduce_channels != 0;
+
+    if (options->deadline_milliseconds)
+    {
+        decode_options.deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(options->deadline_milliseconds);
+    }
+
+    if (options->cancellation_token)
+    {
+        decode_options.stop_token = options->cancellation_token->stop_source.get_token();
+    }
+
+    return decode_options;
+} // toDecodeOptions
+
+/*!
+ * exceptionStatus
+ *
+ * @param exception: Exception thrown while decoding.
+ * @return: DECODE_CANCELLED or DEADLINE_EXCEEDED if the decode was interrupted,
+ * LIMIT_EXCEEDED if the image went over a limit, EXCEPTION otherwise.
+*/
+static int exceptionStatus(const std::exception& exception) noexcept
+{
+    if (dynamic_cast<const utils::DecodeCancelled*>(&exception)) { return DECODE_CANCELLED; }
+    if (dynamic_cast<const utils::DecodeDeadlineExceeded*>(&exception)) { return DEADLINE_EXCEEDED; }
+    if (dynamic_cast<const utils::DecodeLimitExceeded*>(&exception)) { return LIMIT_EXCEEDED; }
+
+    return EXCEPTION;
+} // exceptionStatus
+
+/*!
+ * viewPixels
+ *
+ * @param image_decoder: Decoder holding the pixels.
+ * @param pixel_format: Layout of the pixels.
+ * @return: A view of the decoder's pixels in the given layout.
+ * @throw runtime_error if the pixel format is invalid.
+*/
+static utils::typings::BytesView viewPixels(image_decoder::ImageDecoder& image_decoder, PixelFormat pixel_format)
+{
+    switch (pixel_format)
+    {
+        case NATIVE_PIXEL_FORMAT:   return image_decoder.getRawDataView();
+        case RGB_PIXEL_FORMAT:      return image_decoder.getRawDataRGBView();
+        case RGBA_PIXEL_FORMAT:     return image_decoder.getRawDataRGBAView();
+        case BGRA_PIXEL_FORMAT:
+        case ARGB_PIXEL_FORMAT:
+        case RGBA_PREMULTIPLIED_PIXEL_FORMAT:
+        case BGRA_PREMULTIPLIED_PIXEL_FORMAT:
+        case XRGB_PIXEL_FORMAT:
+            throw std::runtime_error
+            (
+                __func__ + std::string("\nThis pixel format isn't kept by the decoder, it can only be written into a buffer.\n")
+            );
+    }
+
+    throw std::runtime_error(__func__ + std::string("\nInvalid pixel format.\n"));
+} // viewPixels
+
+/*!
+ * convertedPixelFormat
+ *
+ * @param pixel_format: Layout of the pixels.
+ * @return: The format the decoder converts to straight into a buffer, or nothing for the layouts viewPixels can view.
+*/
+static std::optional<utils::typings::PixelFormat> convertedPixelFormat(PixelFormat pixel_format) noexcept
+{
+    switch (pixel_format)
+    {
+        case BGRA_PIXEL_FORMAT:                 return utils::typings::PixelFormat::BGRA;
+        case ARGB_PIXEL_FORMAT:                 return utils::typings::PixelFormat::ARGB;
+        case RGBA_PREMULTIPLIED_PIXEL_FORMAT:   return utils::typings::PixelFormat::RGBA_PREMULTIPLIED;
+        case BGRA_PREMULTIPLIED_PIXEL_FORMAT:   return utils::typings::PixelFormat::BGRA_PREMULTIPLIED;
+        case XRGB_PIXEL_FORMAT:                 return utils::typings::PixelFormat::XRGB;
+        default: break;
+    }
+
+    return std::nullopt;
+} // convertedPixelFormat
+
+/*!
+ * writePixels
+ *
+ * @param image_decoder: Decoder holding the pixels.
+ * @param pixel_format: Layout of the pixels.
+ * @param buffer: Where the pixels are written, if they fit.
+ * @param buffer_size: Size in bytes of the buffer.
+ * @return: Bytes the pixels take, nothing is written when it's more than buffer_size.
+ * @throw runtime_error if the pixel format is invalid.
+*/
+static size_t writePixels
+(
+    image_decoder::ImageDecoder& image_decoder,
+    PixelFormat pixel_format,
+    uint8_t* buffer,
+    size_t buffer_size
+)
+{
+    if (const auto converted_pixel_format { convertedPixelFormat(pixel_format) })
+    {
+        const size_t size { uint64_t { image_decoder.getImageWidth() } * image_decoder.getImageHeight() * 4 };
+
+        if (size and size <= buffer_size)
+        {
+            image_decoder.convertRawDataInto(*converted_pixel_format, { std::bit_cast<std::byte*>(buffer), size });
+        }
+
+        return size;
+    }
+
+    const utils::typings::BytesView view { viewPixels(image_decoder, pixel_format) };
+
+    if (not view.empty() and view.size() <= buffer_size) { std::memcpy(buffer, view.data(), view.size()); }
+
+    return view.size();
+} // writePixels
+
+/*!
+ * toImageColorType
+ *
+ * @param color_type: ImageDecoder color type.
+ * @return: The C equivalent of the color type.
+ * @throw runtime_error if the color type is invalid.
+*/
+static ImageColorType toImageColorType(utils::typings::ImageColorType color_type)
+{
+    switch (color_type)
+    {
+        case utils::typings::GRAYSCALE_COLOR_TYPE:              return GRAYSCALE_COLOR_TYPE;
+        case utils::typings::RGB_COLOR_TYPE:                    return RGB_COLOR_TYPE;
+        case utils::typings::INDEXED_COLOR_TYPE:                return INDEXED_COLOR_TYPE;
+        case utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE:    return GRAYSCALE_AND_ALPHA_COLOR_TYPE;
+        case utils::typings::RGBA_COLOR_TYPE:                   return RGBA_COLOR_TYPE;
+        default: break;
+    }
+
+    throw std::runtime_error(__func__ + std::string("\nInvalid color type.\n"));
+} // toImageColorType
+
+/*!
+ * setResultError
+ *
+ * @param result: Result whose status and error are set, the message is truncated to fit.
+ * @param status: Status of the request.
+ * @param message: What happened.
+*/
+static void setResultError(DecodeResult& result, int status, const char* message) noexcept
+{
+    result.status = status;
+    std::strncpy(result.error, message, sizeof(result.error) - 1);
+    result.error[sizeof(result.error) - 1] = '\0';
+} // setResultError
+
+/*!
+ * validateDecodeRequest
+ *
+ * @param request: Request to be validated.
+ * @return: Why the request is invalid, or null if it's valid.
+*/
+static const char* validateDecodeRequest(const DecodeRequest& request) noexcept
+{
+    if (not request.image_filepath and not request.image_data)
+    {
+        return "Error: Request without an image filepath nor image data, nothing was done.";
+    }
+
+    if (not request.buffer and request.buffer_size)
+    {
+        return "Error: Null pointer to the buffer with a non-zero size, nothing was done.";
+    }
+
+    return nullptr;
+} // validateDecodeRequest
+
+/*!
+ * runDecodeRequest
+ *
+ * Decodes a request, writing its pixels into the request's buffer.
+ * Nothing escapes, every failure ends up in result.
+ *
+ * @param request: The request, already validated, its options are ignored in favor of decode_options.
+ * @param decode_options: The request's options, converted when the request was made.
+ * @param result: Where the result is written to.
+ * @param kept_decoder: Optional, if the request has no buffer the decoder is moved into it instead.
+*/
+static void runDecodeRequest
+(
+    const DecodeRequest& request,
+    const utils::typings::DecodeOptions& decode_options,
+    DecodeResult& result,
+    std::unique_ptr<image_decoder::ImageDecoder>* kept_decoder = nullptr
+) noexcept
+{
+    result = DecodeResult {};
+
+    try
+    {
+        // ImageDecoder exits the program when the file doesn't exist, it can't be allowed to on a worker thread.
+        if (request.image_filepath and not std::filesystem::exists(request.image_filepath))
+        {
+            setResultError(result, EXCEPTION, (std::string("File does not exist: ") + request.image_filepath).c_str());
+            return;
+        }
+
+        auto image_decoder
+        {
+            request.image_filepath
+            ? std::make_unique<image_decoder::ImageDecoder>(request.image_filepath, decode_options)
+            : std::make_unique<image_decoder::ImageDecoder>
+            (
+                utils::typings::BytesView
+                {
+                    std::bit_cast<const std::byte*>(request.image_data),
+                    request.image_data_size
+                },
+                decode_options
+            )
+        };
+        result.image_width = image_decoder->getImageWidth();
+        result.image_height = image_decoder->getImageHeight();
+        result.image_color_type = toImageColorType(image_decoder->getImageColorType());
+        result.image_bit_depth = image_decoder->getImageBitDepth();
+
+        if (not request.buffer and kept_decoder)
+        {
+            result.written_size = viewPixels(*image_decoder, request.pixel_format).size();
+            *kept_decoder = std::move(image_decoder);
+        } else
+        {
+            result.written_size = writePixels(*image_decoder, request.pixel_format, request.buffer, request.buffer_size);
+
+            if (result.written_size > request.buffer_size)
+            {
+                setResultError(result, BUFFER_TOO_SMALL, "Error: Buffer too small for the decoded image, nothing was written.");
+                return;
+            }
+        }
+    } catch (const std::exception& e)
+    {
+        setResultError(result, exceptionStatus(e), e.what());
+        return;
+    } catch (...)
+    {
+        setResultError(result, EXCEPTION, "Error: Unknown exception while decoding.");
+        return;
+    }
+
+    result.status = SUCCESS;
+} // runDecodeRequest
+
+/*!
+ * borrowPixels
+ *
+ * Implements the borrow*Buffer functions.
+*/
+static const uint8_t* borrowPixels
+(
+    ImageDecoderWrapper* image_decoder_wrapper,
+    PixelFormat pixel_format,
+    size_t* length,
+    const char** error
+)
+{
+    if (not image_decoder_wrapper or not image_decoder_wrapper->image_decoder or not length)
+    {
+        *error = "Error: Null pointer to ImageDecoder instance or length, nothing was done.";
+        return nullptr;
+    }
+
+    try
+    {
+        const utils::typings::BytesView view { viewPixels(*image_decoder_wrapper->image_decoder, pixel_format) };
+
+        *length = view.size();
+
+        return std::bit_cast<const uint8_t*>(view.data());
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return nullptr;
+    }
+} // borrowPixels
+
 ImageDecoderWrapper* createImageDecoderInstance
 (
     const char* image_filepath,
@@ -14,12 +379,49 @@ ImageDecoderWrapper* createImageDecoderInstance
     ImageColorType* image_color_type,
     uint8_t* image_bit_depth,
     uint8_t* image_number_of_channels,
-    uint32_t* image_scanline_size,
-    uint32_t* image_scanlines_size,
-    uint32_t* image_rgb_scanline_size,
-    uint32_t* image_rgb_scanlines_size,
-    uint32_t* image_rgba_scanline_size,
-    uint32_t* image_rgba_scanlines_size,
+    uint64_t* image_scanline_size,
+    uint64_t* image_scanlines_size,
+    uint64_t* image_rgb_scanline_size,
+    uint64_t* image_rgb_scanlines_size,
+    uint64_t* image_rgba_scanline_size,
+    uint64_t* image_rgba_scanlines_size,
+    const char** error
+)
+{
+    return createImageDecoderInstanceWithOptions
+    (
+        image_filepath,
+        nullptr,
+        image_width,
+        image_height,
+        image_color_type,
+        image_bit_depth,
+        image_number_of_channels,
+        image_scanline_size,
+        image_scanlines_size,
+        image_rgb_scanline_size,
+        image_rgb_scanlines_size,
+        image_rgba_scanline_size,
+        image_rgba_scanlines_size,
+        error
+    );
+} // createImageDecoderInstance
+
+ImageDecoderWrapper* createImageDecoderInstanceWithOptions
+(
+    const char* image_filepath,
+    const ImageDecoderOptions* options,
+    uint32_t* image_width,
+    uint32_t* image_height,
+    ImageColorType* image_color_type,
+    uint8_t* image_bit_depth,
+    uint8_t* image_number_of_channels,
+    uint64_t* image_scanline_size,
+    uint64_t* image_scanlines_size,
+    uint64_t* image_rgb_scanline_size,
+    uint64_t* image_rgb_scanlines_size,
+    uint64_t* image_rgba_scanline_size,
+    uint64_t* image_rgba_scanlines_size,
     const char** error
 )
 {
@@ -28,7 +430,11 @@ ImageDecoderWrapper* createImageDecoderInstance
     try
     {
         image_decoder_wrapper = new ImageDecoderWrapper;
-        image_decoder_wrapper->image_decoder = new image_decoder::ImageDecoder(image_filepath);
+        image_decoder_wrapper->image_decoder = new image_decoder::ImageDecoder
+        (
+            image_filepath,
+            toDecodeOptions(options)
+        );
 
         if (image_width)
         {
@@ -82,43 +488,7 @@ ImageDecoderWrapper* createImageDecoderInstance
 
         if (image_color_type)
         {
-            switch (image_decoder_wrapper->image_decoder->getImageColorType())
-            {
-                case utils::typings::GRAYSCALE_COLOR_TYPE:
-                {
-                    *image_color_type = GRAYSCALE_COLOR_TYPE;
-
-                    break;
-                }
-                case utils::typings::RGB_COLOR_TYPE:
-                {
-                    *image_color_type = RGB_COLOR_TYPE;
-
-                    break;
-                }
-                case utils::typings::INDEXED_COLOR_TYPE:
-                {
-                    *image_color_type = INDEXED_COLOR_TYPE;
-
-                    break;
-                }
-                case utils::typings::RGBA_COLOR_TYPE:
-                {
-                    *image_color_type = RGBA_COLOR_TYPE;
-
-                    break;
-                }
-                case utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE:
-                {
-                    *image_color_type = GRAYSCALE_COLOR_TYPE;
-
-                    break;
-                }
-                default:
-                {
-                    throw std::runtime_error(__func__ + std::string("\nInvalid color type.\n"));
-                }
-            }
+            *image_color_type = toImageColorType(image_decoder_wrapper->image_decoder->getImageColorType());
         }
     } catch (const std::exception& e)
     {
@@ -130,7 +500,7 @@ ImageDecoderWrapper* createImageDecoderInstance
     }
 
     return image_decoder_wrapper;
-} // createImageDecoderInstance
+} // createImageDecoderInstanceWithOptions
 
 void destroyImageDecoderInstance(ImageDecoderWrapper* image_decoder_wrapper)
 {
@@ -199,6 +569,392 @@ uint8_t* getRawDataRGBABuffer(ImageDecoderWrapper* image_decoder_wrapper, const
     }
 } // getRawDataRGBABuffer
 
+const uint8_t* borrowRawDataBuffer(ImageDecoderWrapper* image_decoder_wrapper, size_t* length, const char** error)
+{
+    return borrowPixels(image_decoder_wrapper, NATIVE_PIXEL_FORMAT, length, error);
+} // borrowRawDataBuffer
+
+const uint8_t* borrowRawDataRGBBuffer(ImageDecoderWrapper* image_decoder_wrapper, size_t* length, const char** error)
+{
+    return borrowPixels(image_decoder_wrapper, RGB_PIXEL_FORMAT, length, error);
+} // borrowRawDataRGBBuffer
+
+const uint8_t* borrowRawDataRGBABuffer(ImageDecoderWrapper* image_decoder_wrapper, size_t* length, const char** error)
+{
+    return borrowPixels(image_decoder_wrapper, RGBA_PIXEL_FORMAT, length, error);
+} // borrowRawDataRGBABuffer
+
+int decodeImageInto
+(
+    const char* image_filepath,
+    const ImageDecoderOptions* options,
+    PixelFormat pixel_format,
+    uint8_t* buffer,
+    size_t buffer_size,
+    size_t* written_size,
+    const char** error
+)
+{
+    if (not image_filepath or (not buffer and buffer_size))
+    {
+        *error = "Error: Null pointer to the image filepath or buffer, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    try
+    {
+        image_decoder::ImageDecoder image_decoder(image_filepath, toDecodeOptions(options));
+        const size_t size { writePixels(image_decoder, pixel_format, buffer, buffer_size) };
+
+        if (written_size) { *written_size = size; }
+
+        if (size > buffer_size)
+        {
+            *error = "Error: Buffer too small for the decoded image, nothing was written.";
+            return BUFFER_TOO_SMALL;
+        }
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return exceptionStatus(e);
+    }
+
+    return SUCCESS;
+} // decodeImageInto
+
+int decodeImagePlanesInto
+(
+    const char* image_filepath,
+    const ImageDecoderOptions* options,
+    uint8_t channels,
+    uint8_t* const planes[4],
+    size_t plane_size,
+    size_t* written_size,
+    const char** error
+)
+{
+    if (not image_filepath or not planes or (channels != 3 and channels != 4))
+    {
+        *error = "Error: Null pointer to the image filepath or planes, or channels other than 3 or 4, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    for (uint8_t channel = 0; channel < channels; ++channel)
+    {
+        if (not planes[channel] and plane_size)
+        {
+            *error = "Error: Null pointer to a plane, nothing was done.";
+            return INVALID_ARGUMENTS;
+        }
+    }
+
+    try
+    {
+        image_decoder::ImageDecoder image_decoder(image_filepath, toDecodeOptions(options));
+        const uint64_t size { image_decoder.getImagePlaneRowSize() * image_decoder.getImageHeight() };
+
+        if (written_size) { *written_size = static_cast<size_t>(size); }
+
+        if (size > plane_size)
+        {
+            *error = "Error: Planes too small for the decoded image, nothing was written.";
+            return BUFFER_TOO_SMALL;
+        }
+
+        std::array<utils::typings::MutableBytesView, 4> views {};
+
+        for (uint8_t channel = 0; channel < channels; ++channel)
+        {
+            views[channel] = { reinterpret_cast<utils::typings::Byte*>(planes[channel]), plane_size };
+        }
+
+        image_decoder.convertRawDataIntoPlanes(views, channels);
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return exceptionStatus(e);
+    }
+
+    return SUCCESS;
+} // decodeImagePlanesInto
+
+DecodeCancellationToken* createDecodeCancellationToken(const char** error)
+{
+    try
+    {
+        return new DecodeCancellationToken;
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return nullptr;
+    }
+} // createDecodeCancellationToken
+
+void cancelDecode(DecodeCancellationToken* cancellation_token)
+{
+    if (cancellation_token)
+    {
+        cancellation_token->stop_source.request_stop();
+    }
+} // cancelDecode
+
+void destroyDecodeCancellationToken(DecodeCancellationToken* cancellation_token)
+{
+    if (cancellation_token)
+    {
+        delete cancellation_token;
+    }
+} // destroyDecodeCancellationToken
+
+DecodeThreadPool* createDecodeThreadPool(size_t number_of_threads, const char** error)
+{
+    try
+    {
+        return new DecodeThreadPool(number_of_threads);
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return nullptr;
+    }
+} // createDecodeThreadPool
+
+void destroyDecodeThreadPool(DecodeThreadPool* decode_thread_pool)
+{
+    if (decode_thread_pool)
+    {
+        delete decode_thread_pool;
+    }
+} // destroyDecodeThreadPool
+
+int decodeImageBatch
+(
+    DecodeThreadPool* decode_thread_pool,
+    const DecodeRequest* requests,
+    DecodeResult* results,
+    size_t count,
+    const char** error
+)
+{
+    if (not decode_thread_pool or ((not requests or not results) and count))
+    {
+        *error = "Error: Null pointer to the thread pool, requests or results, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (const char* invalid = validateDecodeRequest(requests[i]))
+        {
+            *error = invalid;
+            return INVALID_ARGUMENTS;
+        }
+    }
+
+    try
+    {
+        std::vector<utils::typings::DecodeOptions> decode_options(count);
+        std::latch requests_done { static_cast<std::ptrdiff_t>(count) };
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            decode_options[i] = toDecodeOptions(requests[i].options);
+        }
+
+        size_t submitted { 0 };
+
+        try
+        {
+            for (; submitted < count; ++submitted)
+            {
+                decode_thread_pool->thread_pool.submit
+                (
+                    [&requests_done, request = &requests[submitted], options = &decode_options[submitted],
+                        result = &results[submitted]]
+                    {
+                        runDecodeRequest(*request, *options, *result);
+                        requests_done.count_down();
+                    }
+                );
+            }
+        } catch (const std::exception&)
+        {
+            // The requests already queued use the latch and options on this stack, they're waited for all the same,
+            // the ones the pool couldn't take are decoded here.
+            for (size_t i = submitted; i < count; ++i)
+            {
+                runDecodeRequest(requests[i], decode_options[i], results[i]);
+                requests_done.count_down();
+            }
+        }
+
+        requests_done.wait();
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return EXCEPTION;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (results[i].status != SUCCESS)
+        {
+            *error = "Error: At least one request failed, its result tells why.";
+            return results[i].status;
+        }
+    }
+
+    return SUCCESS;
+} // decodeImageBatch
+
+DecodeRequestHandle* submitDecodeRequest
+(
+    DecodeThreadPool* decode_thread_pool,
+    const DecodeRequest* request,
+    DecodeCallback callback,
+    void* user_data,
+    const char** error
+)
+{
+    if (not decode_thread_pool or not request)
+    {
+        *error = "Error: Null pointer to the thread pool or request, nothing was done.";
+        return nullptr;
+    }
+
+    if (const char* invalid = validateDecodeRequest(*request))
+    {
+        *error = invalid;
+        return nullptr;
+    }
+
+    DecodeRequestHandle* handle = nullptr;
+
+    try
+    {
+        handle = new DecodeRequestHandle;
+        handle->request = *request;
+        handle->callback = callback;
+        handle->user_data = user_data;
+
+        // Copied so the caller's request, filepath and options don't have to outlive the call,
+        // converting the options now also starts the deadline at submission, queueing time included.
+        if (request->image_filepath)
+        {
+            handle->image_filepath = request->image_filepath;
+            handle->request.image_filepath = handle->image_filepath.c_str();
+        }
+
+        handle->decode_options = toDecodeOptions(request->options);
+        handle->request.options = nullptr;
+
+        decode_thread_pool->thread_pool.submit
+        (
+            [handle]
+            {
+                DecodeResult result {};
+
+                runDecodeRequest(handle->request, handle->decode_options, result, &handle->image_decoder);
+
+                {
+                    std::scoped_lock lock { handle->mutex };
+
+                    handle->result = result;
+                    handle->done = true;
+                }
+
+                handle->done_condition.notify_all();
+
+                if (handle->callback) { handle->callback(handle, &result, handle->user_data); }
+
+                releaseDecodeRequest(handle);
+            }
+        );
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+
+        delete handle;
+
+        return nullptr;
+    }
+
+    return handle;
+} // submitDecodeRequest
+
+int pollDecodeRequest(DecodeRequestHandle* handle, DecodeResult* result, const char** error)
+{
+    if (not handle or not result)
+    {
+        *error = "Error: Null pointer to the handle or result, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    std::scoped_lock lock { handle->mutex };
+
+    if (not handle->done) { return DECODE_REQUEST_PENDING; }
+
+    *result = handle->result;
+
+    return SUCCESS;
+} // pollDecodeRequest
+
+int waitDecodeRequest(DecodeRequestHandle* handle, DecodeResult* result, const char** error)
+{
+    if (not handle or not result)
+    {
+        *error = "Error: Null pointer to the handle or result, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    std::unique_lock lock { handle->mutex };
+
+    handle->done_condition.wait(lock, [handle] { return handle->done; });
+
+    *result = handle->result;
+
+    return SUCCESS;
+} // waitDecodeRequest
+
+const uint8_t* borrowDecodeRequestPixels(DecodeRequestHandle* handle, size_t* length, const char** error)
+{
+    if (not handle or not length)
+    {
+        *error = "Error: Null pointer to the handle or length, nothing was done.";
+        return nullptr;
+    }
+
+    {
+        std::scoped_lock lock { handle->mutex };
+
+        if (not handle->done or not handle->image_decoder)
+        {
+            *error = "Error: The request isn't done, failed, or was given a buffer, there are no pixels to borrow.";
+            return nullptr;
+        }
+    }
+
+    try
+    {
+        const utils::typings::BytesView view { viewPixels(*handle->image_decoder, handle->request.pixel_format) };
+
+        *length = view.size();
+
+        return std::bit_cast<const uint8_t*>(view.data());
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return nullptr;
+    }
+} // borrowDecodeRequestPixels
+
+void releaseDecodeRequest(DecodeRequestHandle* handle)
+{
+    if (handle and handle->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        delete handle;
+    }
+} // releaseDecodeRequest
+
 void freeRawDataBuffer(uint8_t* buffer)
 {
     if (buffer)
@@ -243,3 +999,141 @@ void resetCachedData(ImageDecoderWrapper* image_decoder_wrapper, const char** er
         *error = e.what();
     }
 } // resetCachedData
+
+int getMemoryStats(ImageDecoderWrapper* image_decoder_wrapper, MemoryStats* memory_stats, const char** error)
+{
+    if (not image_decoder_wrapper or not image_decoder_wrapper->image_decoder or not memory_stats)
+    {
+        *error = "Error: Null pointer to ImageDecoder instance or MemoryStats, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    static const auto convert = [](const utils::BufferMemoryStats& stats)
+    {
+        return BufferMemoryStats
+        {
+            .allocations = stats.allocations,
+            .allocated_bytes = stats.allocated_bytes,
+            .current_bytes = stats.current_bytes,
+            .peak_bytes = stats.peak_bytes
+        };
+    };
+
+    try
+    {
+        const utils::MemoryStats stats { image_decoder_wrapper->image_decoder->getMemoryStats() };
+
+        memory_stats->total = convert(stats.total);
+
+        for (size_t i = 0; i < NUMBER_OF_BUFFER_KINDS; ++i)
+        {
+            memory_stats->buffers[i] = convert(stats.buffers[i]);
+        }
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return EXCEPTION;
+    }
+
+    return SUCCESS;
+} // getMemoryStats
+
+int getDecodeStats(ImageDecoderWrapper* image_decoder_wrapper, DecodeStats* decode_stats, const char** error)
+{
+    if (not image_decoder_wrapper or not image_decoder_wrapper->image_decoder or not decode_stats)
+    {
+        *error = "Error: Null pointer to ImageDecoder instance or DecodeStats, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    try
+    {
+        const utils::DecodeStats stats { image_decoder_wrapper->image_decoder->getDecodeStats() };
+
+        decode_stats->total_decode_nanoseconds = stats.total_decode.count();
+        decode_stats->io_nanoseconds = stats.io.count();
+        decode_stats->crc_nanoseconds = stats.crc.count();
+        decode_stats->inflate_nanoseconds = stats.inflate.count();
+        decode_stats->defilter_nanoseconds = stats.defilter.count();
+        decode_stats->rgb_conversion_nanoseconds = stats.rgb_conversion.count();
+        decode_stats->rgba_conversion_nanoseconds = stats.rgba_conversion.count();
+        decode_stats->chunks = stats.chunks;
+        decode_stats->io_bytes = stats.io_bytes;
+        decode_stats->crc_bytes = stats.crc_bytes;
+        decode_stats->compressed_bytes = stats.compressed_bytes;
+        decode_stats->inflated_bytes = stats.inflated_bytes;
+        decode_stats->defiltered_bytes = stats.defiltered_bytes;
+        decode_stats->rgb_converted_bytes = stats.rgb_converted_bytes;
+        decode_stats->rgba_converted_bytes = stats.rgba_converted_bytes;
+
+        for (size_t i = 0; i < stats.filter_type_rows.size(); ++i)
+        {
+            decode_stats->filter_type_rows[i] = stats.filter_type_rows[i];
+        }
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return EXCEPTION;
+    }
+
+    return SUCCESS;
+} // getDecodeStats
+
+int getImageContent(ImageDecoderWrapper* image_decoder_wrapper, ImageContent* image_content, const char** error)
+{
+    if (not image_decoder_wrapper or not image_decoder_wrapper->image_decoder or not image_content)
+    {
+        *error = "Error: Null pointer to ImageDecoder instance or ImageContent, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    try
+    {
+        const utils::typings::ImageContent content { image_decoder_wrapper->image_decoder->getImageContent() };
+
+        image_content->opaque = content.opaque;
+        image_content->gray = content.gray;
+        image_content->max_sample = content.max_sample;
+        image_content->original_color_type = toImageColorType(content.original_color_type);
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return EXCEPTION;
+    }
+
+    return SUCCESS;
+} // getImageContent
+
+int startDecodeTracing(const char* output_filepath, const char** error)
+{
+    if (not output_filepath)
+    {
+        *error = "Error: Null pointer to the output filepath, nothing was done.";
+        return INVALID_ARGUMENTS;
+    }
+
+    try
+    {
+        utils::tracing::startTracing(output_filepath);
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return EXCEPTION;
+    }
+
+    return SUCCESS;
+} // startDecodeTracing
+
+int stopDecodeTracing(const char** error)
+{
+    try
+    {
+        utils::tracing::stopTracing();
+    } catch (const std::exception& e)
+    {
+        *error = e.what();
+        return EXCEPTION;
+    }
+
+    return SUCCESS;
+} // stopDecodeTracing
@@ -1,13 +1,193 @@
+#include <condition_variable>
 #include <cstring>
 #include <iostream>
+#include <mutex>
+#include <optional>
 
 #include "image-formats/png-format.hpp"
 #include "image-decoder/image-decoder.hpp"
 
 namespace image_decoder
 {
+namespace
+{
+/*!
+ * hasPNGSignature
+ *
+ * @param image_data: Encoded image.
+ * @return: True if image_data starts with the 8 bytes every png file starts with.
+*/
+bool hasPNGSignature(utils::typings::BytesView image_data) noexcept
+{
+    constexpr uint8_t PNG_SIGNATURE[] { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    return image_data.size() >= sizeof(PNG_SIGNATURE)
+        and std::memcmp(image_data.data(), PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0;
+} // hasPNGSignature
+
+/*!
+ * sharedThreadPool
+ *
+ * @return: The thread pool decodeAsync runs on when no executor is given, started on first use.
+*/
+utils::ThreadPool& sharedThreadPool()
+{
+    static utils::ThreadPool thread_pool {};
+
+    return thread_pool;
+} // sharedThreadPool
+} // namespace
+
+struct AsyncDecode::State
+{
+    /*!
+     * complete
+     *
+     * Stores the result of the decode, and hands it to the coroutine or future waiting for it, if any.
+    */
+    void complete(std::optional<ImageDecoder> decoded_image, std::exception_ptr decode_exception)
+    {
+        std::coroutine_handle<> waiting_coroutine;
+        std::optional<std::promise<ImageDecoder>> waiting_promise;
+
+        {
+            std::scoped_lock lock { mutex };
+
+            image_decoder = std::move(decoded_image);
+            exception = decode_exception;
+            done = true;
+            waiting_coroutine = continuation;
+            waiting_promise = std::move(promise);
+            taken = waiting_promise.has_value();
+        }
+
+        if (waiting_promise)
+        {
+            fulfill(*waiting_promise);
+        } else if (waiting_coroutine)
+        {
+            waiting_coroutine.resume();
+        }
+    }
+
+    /*!
+     * fulfill
+     *
+     * Moves the result into a promise, only called once done is set, by whoever set taken.
+    */
+    void fulfill(std::promise<ImageDecoder>& result_promise)
+    {
+        if (exception)
+        {
+            result_promise.set_exception(exception);
+            return;
+        }
+
+        result_promise.set_value(std::move(*image_decoder));
+    }
+
+    std::mutex mutex;
+    bool done { false };
+    std::optional<ImageDecoder> image_decoder;
+    std::exception_ptr exception;
+    std::coroutine_handle<> continuation;
+    std::optional<std::promise<ImageDecoder>> promise;
+
+    // The result has a single consumer, the first to ask for it, and it's moved out once.
+    enum class Consumer : uint8_t
+    {
+        NONE,
+        FUTURE,
+        COROUTINE,
+    }; // enum class Consumer
+
+    Consumer consumer { Consumer::NONE };
+    bool taken { false };
+}; // struct AsyncDecode::State
+
+AsyncDecode::AsyncDecode(std::shared_ptr<State> state) noexcept : m_state(std::move(state)) {}
+
+bool AsyncDecode::await_ready() const
+{
+    std::scoped_lock lock { m_state->mutex };
+
+    // A result someone else asked for isn't waited for, await_resume throws right away.
+    return m_state->done or m_state->consumer != State::Consumer::NONE;
+} // AsyncDecode::await_ready
+
+bool AsyncDecode::await_suspend(std::coroutine_handle<> continuation)
+{
+    std::scoped_lock lock { m_state->mutex };
+
+    // Finished (or claimed) in between await_ready and now, resume right away.
+    if (m_state->done or m_state->consumer != State::Consumer::NONE) { return false; }
+
+    m_state->consumer = State::Consumer::COROUTINE;
+    m_state->continuation = continuation;
+
+    return true;
+} // AsyncDecode::await_suspend
 
-ImageDecoder::ImageDecoder(const std::filesystem::path& image_filepath)
+ImageDecoder AsyncDecode::await_resume()
+{
+    std::scoped_lock lock { m_state->mutex };
+
+    // Taken already, claimed by future(), or awaited by another coroutine still suspended.
+    if
+    (
+        m_state->taken
+        or m_state->consumer == State::Consumer::FUTURE
+        or (m_state->consumer == State::Consumer::COROUTINE and not m_state->done)
+    )
+    {
+        throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+
+    m_state->consumer = State::Consumer::COROUTINE;
+    m_state->taken = true;
+
+    if (m_state->exception) { std::rethrow_exception(m_state->exception); }
+
+    return std::move(*m_state->image_decoder);
+} // AsyncDecode::await_resume
+
+std::future<ImageDecoder> AsyncDecode::future()
+{
+    std::scoped_lock lock { m_state->mutex };
+
+    if (m_state->consumer != State::Consumer::NONE)
+    {
+        throw std::future_error(std::future_errc::future_already_retrieved);
+    }
+
+    m_state->consumer = State::Consumer::FUTURE;
+
+    if (m_state->done)
+    {
+        m_state->taken = true;
+
+        std::promise<ImageDecoder> result_promise;
+
+        m_state->fulfill(result_promise);
+
+        return result_promise.get_future();
+    }
+
+    return m_state->promise.emplace().get_future();
+} // AsyncDecode::future
+
+ImageDecoder::ImageDecoder
+(
+    const std::filesystem::path& image_filepath,
+    std::pmr::memory_resource* memory_resource
+) : ImageDecoder(image_filepath, utils::typings::DecodeOptions {}, memory_resource) {}
+
+ImageDecoder::ImageDecoder
+(
+    const std::filesystem::path& image_filepath,
+    const utils::typings::DecodeOptions& decode_options,
+    std::pmr::memory_resource* memory_resource
+)
 {
     if (!std::filesystem::exists(image_filepath))
     {
@@ -18,19 +198,304 @@ ImageDecoder::ImageDecoder(const std::filesystem::path& image_filepath)
 
     if (image_filepath.extension() == ".png")
     {
-        loadPNGImage(image_filepath);
+        loadPNGImage(image_filepath, decode_options, memory_resource);
     }
 
     // TODO: Implement the rest of the logic
 }
 
+ImageDecoder::ImageDecoder
+(
+    utils::typings::BytesView image_data,
+    const utils::typings::DecodeOptions& decode_options,
+    std::pmr::memory_resource* memory_resource
+)
+{
+    if (hasPNGSignature(image_data))
+    {
+        loadPNGImage(image_data, decode_options, memory_resource);
+
+        return;
+    }
+
+    throw std::runtime_error(__func__ + std::string("\nFormat not implemented, unknown image signature.\n"));
+}
+
+AsyncDecode ImageDecoder::decodeAsync
+(
+    std::filesystem::path image_filepath,
+    utils::typings::DecodeOptions decode_options,
+    utils::Executor executor,
+    std::pmr::memory_resource* memory_resource
+)
+{
+    return startAsyncDecode
+    (
+        [image_filepath = std::move(image_filepath), decode_options = std::move(decode_options), memory_resource]
+        {
+            // The constructor exits the program when the file doesn't exist, not acceptable on a worker thread.
+            if (not std::filesystem::exists(image_filepath))
+            {
+                throw std::runtime_error("decodeAsync\nFile does not exist: " + image_filepath.string() + "\n");
+            }
+
+            return ImageDecoder(image_filepath, decode_options, memory_resource);
+        },
+        std::move(executor)
+    );
+} // ImageDecoder::decodeAsync
+
+AsyncDecode ImageDecoder::decodeAsync
+(
+    utils::typings::BytesView image_data,
+    utils::typings::DecodeOptions decode_options,
+    utils::Executor executor,
+    std::pmr::memory_resource* memory_resource
+)
+{
+    return startAsyncDecode
+    (
+        [image_data, decode_options = std::move(decode_options), memory_resource]
+        {
+            return ImageDecoder(image_data, decode_options, memory_resource);
+        },
+        std::move(executor)
+    );
+} // ImageDecoder::decodeAsync
+
+AsyncDecode ImageDecoder::startAsyncDecode(std::function<ImageDecoder()> decode, utils::Executor executor)
+{
+    auto state { std::make_shared<AsyncDecode::State>() };
+    auto task
+    {
+        [state, decode = std::move(decode)]
+        {
+            std::optional<ImageDecoder> decoded_image;
+            std::exception_ptr decode_exception;
+
+            try
+            {
+                decoded_image.emplace(decode());
+            } catch (...)
+            {
+                decode_exception = std::current_exception();
+            }
+
+            // Outside the try, the awaiting coroutine may be resumed from here.
+            state->complete(std::move(decoded_image), decode_exception);
+        }
+    };
+
+    if (executor)
+    {
+        executor(std::move(task));
+    } else
+    {
+        sharedThreadPool().submit(std::move(task));
+    }
+
+    return AsyncDecode(std::move(state));
+} // ImageDecoder::startAsyncDecode
+
+void ImageDecoder::decodeTensorBatch
+(
+    std::span<const std::filesystem::path> image_filepaths,
+    const utils::typings::TensorOptions& tensor_options,
+    utils::typings::MutableBytesView dest,
+    const utils::typings::DecodeOptions& decode_options,
+    utils::Executor executor,
+    std::pmr::memory_resource* memory_resource
+)
+{
+    runTensorBatch
+    (
+        image_filepaths.size(),
+        [&](std::size_t image)
+        {
+            // The constructor exits the program when the file doesn't exist, not acceptable on a worker thread.
+            if (not std::filesystem::exists(image_filepaths[image]))
+            {
+                throw std::runtime_error
+                (
+                    "decodeTensorBatch\nFile does not exist: " + image_filepaths[image].string() + "\n"
+                );
+            }
+
+            return ImageDecoder(image_filepaths[image], decode_options, memory_resource);
+        },
+        tensor_options,
+        dest,
+        executor
+    );
+} // ImageDecoder::decodeTensorBatch
+
+void ImageDecoder::decodeTensorBatch
+(
+    std::span<const utils::typings::BytesView> images_data,
+    const utils::typings::TensorOptions& tensor_options,
+    utils::typings::MutableBytesView dest,
+    const utils::typings::DecodeOptions& decode_options,
+    utils::Executor executor,
+    std::pmr::memory_resource* memory_resource
+)
+{
+    runTensorBatch
+    (
+        images_data.size(),
+        [&](std::size_t image) { return ImageDecoder(images_data[image], decode_options, memory_resource); },
+        tensor_options,
+        dest,
+        executor
+    );
+} // ImageDecoder::decodeTensorBatch
+
+uint64_t ImageDecoder::getTensorBatchSize
+(
+    std::size_t images,
+    const utils::typings::TensorOptions& tensor_options
+) noexcept
+{
+    const uint64_t element_size { (tensor_options.data_type == utils::typings::TensorDataType::FLOAT32) ? 4u : 2u };
+
+    return uint64_t { images } * tensor_options.width * tensor_options.height * tensor_options.channels * element_size;
+} // ImageDecoder::getTensorBatchSize
+
+void ImageDecoder::runTensorBatch
+(
+    std::size_t images,
+    const std::function<ImageDecoder(std::size_t)>& decode,
+    const utils::typings::TensorOptions& tensor_options,
+    utils::typings::MutableBytesView dest,
+    const utils::Executor& executor
+)
+{
+    if (not tensor_options.width or not tensor_options.height)
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe width and height of a batch's tensors must be set.\n"));
+    }
+
+    if (dest.size() < getTensorBatchSize(images, tensor_options))
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nBuffer of ") + std::to_string(dest.size()) + " bytes is too small for a batch of "
+            + std::to_string(getTensorBatchSize(images, tensor_options)) + " bytes.\n"
+        );
+    }
+
+    /*!
+     * Shared with the helpers, so one the executor runs late (or never) still finds it once the batch returned,
+     * sees no image left and returns without touching anything on the calling thread's stack.
+    */
+    struct BatchState
+    {
+        std::mutex mutex;
+        std::condition_variable image_done;
+        std::size_t next_image { 0 };
+        std::size_t images_in_flight { 0 };
+        std::vector<std::exception_ptr> exceptions;
+    };
+
+    const uint64_t slice_size { getTensorBatchSize(1, tensor_options) };
+    const auto state { std::make_shared<BatchState>() };
+
+    state->exceptions.resize(images);
+
+    /*!
+     * Takes images until none are left, so it doesn't matter how many of these run, nor when they start.
+     * The references are only followed while an image is claimed, the calling thread waits for those.
+    */
+    const auto decode_images
+    {
+        [state, images, slice_size, &decode, &tensor_options, dest]
+        {
+            while (true)
+            {
+                std::size_t image { 0 };
+
+                {
+                    std::scoped_lock lock { state->mutex };
+
+                    if (state->next_image == images) { return; }
+
+                    image = state->next_image++;
+                    ++state->images_in_flight;
+                }
+
+                std::exception_ptr exception;
+
+                try
+                {
+                    ImageDecoder image_decoder { decode(image) };
+
+                    image_decoder.convertRawDataToTensor(tensor_options, dest.subspan(image * slice_size, slice_size));
+                } catch (...)
+                {
+                    exception = std::current_exception();
+                }
+
+                {
+                    std::scoped_lock lock { state->mutex };
+
+                    state->exceptions[image] = exception;
+                    --state->images_in_flight;
+                }
+
+                state->image_done.notify_all();
+            }
+        }
+    };
+
+    // The calling thread decodes too, so there's no point in more helpers than images left for them.
+    const std::size_t helpers
+    {
+        std::min(images ? images - 1 : 0, executor ? SIZE_MAX : sharedThreadPool().size())
+    };
+
+    for (std::size_t helper = 0; helper < helpers; ++helper)
+    {
+        // A helper that can't be submitted isn't an error, the calling thread decodes its images.
+        try
+        {
+            if (executor)
+            {
+                executor(decode_images);
+            } else
+            {
+                sharedThreadPool().submit(decode_images);
+            }
+        } catch (...)
+        {
+            break;
+        }
+    }
+
+    // Every image is claimed once it returns, only the ones still being decoded by helpers are waited for.
+    decode_images();
+
+    std::unique_lock lock { state->mutex };
+
+    state->image_done.wait(lock, [&state] { return state->images_in_flight == 0; });
+
+    for (const auto& exception : state->exceptions)
+    {
+        if (exception) { std::rethrow_exception(exception); }
+    }
+} // ImageDecoder::runTensorBatch
+
 ImageDecoder::~ImageDecoder() = default;
 ImageDecoder::ImageDecoder(ImageDecoder&&) = default;
 ImageDecoder& ImageDecoder::operator=(ImageDecoder&&) = default;
 
-void ImageDecoder::loadPNGImage(const std::filesystem::path& image_filepath)
+void ImageDecoder::loadPNGImage
+(
+    const std::filesystem::path& image_filepath,
+    const utils::typings::DecodeOptions& decode_options,
+    std::pmr::memory_resource* memory_resource
+)
 {
-    m_data = std::make_unique<image_formats::png_format::PNGFormat>(image_filepath);
+    m_data = std::make_unique<image_formats::png_format::PNGFormat>(image_filepath, decode_options, memory_resource);
 
     if (not std::holds_alternative<png_image_unique_ptr>(m_data))
     {
@@ -42,6 +507,17 @@ void ImageDecoder::loadPNGImage(const std::filesystem::path& image_filepath)
     m_image_format_type = utils::typings::ImageFormat::PNG_FORMAT_TYPE;
 } // ImageDecoder::loadPNGImage
 
+void ImageDecoder::loadPNGImage
+(
+    utils::typings::BytesView image_data,
+    const utils::typings::DecodeOptions& decode_options,
+    std::pmr::memory_resource* memory_resource
+)
+{
+    m_data = std::make_unique<image_formats::png_format::PNGFormat>(image_data, decode_options, memory_resource);
+    m_image_format_type = utils::typings::ImageFormat::PNG_FORMAT_TYPE;
+} // ImageDecoder::loadPNGImage
+
 ImageDecoder::png_image_unique_ptr* ImageDecoder::getPNGVariantData() noexcept
 {
     auto image = std::get_if<png_image_unique_ptr>(&m_data);
@@ -148,9 +624,12 @@ uint8_t* ImageDecoder::getRawDataRGBBuffer()
     {
         auto image = getPNGVariantData();
 
+        // The conversion may throw (over the memory budget, or once the raw data was taken), so it runs
+        // before the copy is allocated.
+        const uint8_t* data { (*image)->getRawDataRGBBuffer() };
         uint8_t* ptr = new uint8_t[(*image)->getImageRGBScanlinesSize()];
 
-        std::memcpy(ptr, (*image)->getRawDataRGBBuffer(), (*image)->getImageRGBScanlinesSize());
+        std::memcpy(ptr, data, (*image)->getImageRGBScanlinesSize());
 
         return ptr;
     }
@@ -187,9 +666,11 @@ uint8_t* ImageDecoder::getRawDataRGBABuffer()
     {
         auto image = getPNGVariantData();
 
+        // Converted before the copy is allocated, as in getRawDataRGBBuffer.
+        const uint8_t* data { (*image)->getRawDataRGBABuffer() };
         uint8_t* ptr = new uint8_t[(*image)->getImageRGBAScanlinesSize()];
 
-        std::memcpy(ptr, (*image)->getRawDataRGBABuffer(), (*image)->getImageRGBAScanlinesSize());
+        std::memcpy(ptr, data, (*image)->getImageRGBAScanlinesSize());
 
         return ptr;
     }
@@ -202,6 +683,268 @@ uint8_t* ImageDecoder::getRawDataRGBABuffer()
     );
 } // ImageDecoder::getRawDataRGBABuffer
 
+utils::typings::BytesView ImageDecoder::getRawDataView()
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataView();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataView
+
+utils::typings::BytesView ImageDecoder::getRawDataRGBView()
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataRGBView();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataRGBView
+
+utils::typings::BytesView ImageDecoder::getRawDataRGBAView()
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataRGBAView();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataRGBAView
+
+utils::AlignedBuffer ImageDecoder::getRawDataAligned(const utils::RowLayout& row_layout)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataAligned(row_layout);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataAligned
+
+utils::AlignedBuffer ImageDecoder::getRawDataRGBAligned(const utils::RowLayout& row_layout)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataRGBAligned(row_layout);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataRGBAligned
+
+utils::AlignedBuffer ImageDecoder::getRawDataRGBAAligned(const utils::RowLayout& row_layout)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataRGBAAligned(row_layout);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataRGBAAligned
+
+void ImageDecoder::convertRawDataInto
+(
+    utils::typings::PixelFormat pixel_format,
+    utils::typings::MutableBytesView dest,
+    uint64_t stride
+)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        (*image)->convertRawDataInto(pixel_format, dest, stride);
+
+        return;
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::convertRawDataInto
+
+utils::typings::Bytes ImageDecoder::getRawDataPixelFormat(utils::typings::PixelFormat pixel_format)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataPixelFormat(pixel_format);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataPixelFormat
+
+utils::AlignedBuffer ImageDecoder::getRawDataPixelFormatAligned
+(
+    utils::typings::PixelFormat pixel_format,
+    const utils::RowLayout& row_layout
+)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataPixelFormatAligned(pixel_format, row_layout);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataPixelFormatAligned
+
+uint64_t ImageDecoder::getImageTensorSize(const utils::typings::TensorOptions& tensor_options) const
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getImageTensorSize(tensor_options);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getImageTensorSize
+
+void ImageDecoder::convertRawDataToTensor
+(
+    const utils::typings::TensorOptions& tensor_options,
+    utils::typings::MutableBytesView dest
+)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        (*image)->convertRawDataToTensor(tensor_options, dest);
+
+        return;
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::convertRawDataToTensor
+
+void ImageDecoder::convertRawDataIntoPlanes
+(
+    const std::array<utils::typings::MutableBytesView, 4>& planes,
+    uint8_t channels,
+    uint64_t stride
+)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        (*image)->convertRawDataIntoPlanes(planes, channels, stride);
+
+        return;
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::convertRawDataIntoPlanes
+
+std::vector<utils::AlignedBuffer> ImageDecoder::getRawDataPlanes(uint8_t channels, const utils::RowLayout& row_layout)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getRawDataPlanes(channels, row_layout);
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getRawDataPlanes
+
+utils::typings::Bytes ImageDecoder::takeRawData()
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->takeRawData();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::takeRawData
+
 
 uint32_t ImageDecoder::getImageWidth() const
 {
@@ -255,6 +998,23 @@ uint8_t ImageDecoder::getImageBitDepth() const
     );
 } // ImageDecoder::getImageBitDepth
 
+utils::typings::ByteOrder ImageDecoder::getImageByteOrder() const
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getImageByteOrder();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getImageByteOrder
+
 utils::typings::ImageColorType ImageDecoder::getImageColorType() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
@@ -289,7 +1049,7 @@ uint8_t ImageDecoder::getImageNumberOfChannels() const
     );
 } // ImageDecoder::getImageNumberOfChannels
 
-uint32_t ImageDecoder::getImageScanlineSize() const
+uint64_t ImageDecoder::getImageScanlineSize() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
     {
@@ -306,7 +1066,7 @@ uint32_t ImageDecoder::getImageScanlineSize() const
     );
 } // ImageDecoder::getImageScanlineSize
 
-uint32_t ImageDecoder::getImageScanlinesSize() const
+uint64_t ImageDecoder::getImageScanlinesSize() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
     {
@@ -323,7 +1083,7 @@ uint32_t ImageDecoder::getImageScanlinesSize() const
     );
 } // ImageDecoder::getImageScanlinesSize
 
-uint32_t ImageDecoder::getImageRGBScanlineSize() const
+uint64_t ImageDecoder::getImageRGBScanlineSize() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
     {
@@ -340,7 +1100,7 @@ uint32_t ImageDecoder::getImageRGBScanlineSize() const
     );
 } // ImageDecoder::getImageRGBScanlineSize
 
-uint32_t ImageDecoder::getImageRGBScanlinesSize() const
+uint64_t ImageDecoder::getImageRGBScanlinesSize() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
     {
@@ -357,7 +1117,7 @@ uint32_t ImageDecoder::getImageRGBScanlinesSize() const
     );
 } // ImageDecoder::getImageRGBScanlinesSize
 
-uint32_t ImageDecoder::getImageRGBAScanlineSize() const
+uint64_t ImageDecoder::getImageRGBAScanlineSize() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
     {
@@ -374,7 +1134,7 @@ uint32_t ImageDecoder::getImageRGBAScanlineSize() const
     );
 } // ImageDecoder::getImageRGBAScanlineSize
 
-uint32_t ImageDecoder::getImageRGBAScanlinesSize() const
+uint64_t ImageDecoder::getImageRGBAScanlinesSize() const
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
     {
@@ -391,6 +1151,74 @@ uint32_t ImageDecoder::getImageRGBAScanlinesSize() const
     );
 } // ImageDecoder::getImageRGBAScanlinesSize
 
+uint64_t ImageDecoder::getImagePlaneRowSize() const
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getImagePlaneRowSize();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getImagePlaneRowSize
+
+utils::MemoryStats ImageDecoder::getMemoryStats() const
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getMemoryStats();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getMemoryStats
+
+utils::DecodeStats ImageDecoder::getDecodeStats() const
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getDecodeStats();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getDecodeStats
+
+utils::typings::ImageContent ImageDecoder::getImageContent() const
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        return (*image)->getImageContent();
+    }
+
+    throw std::runtime_error
+    (
+        "Format not implement: "
+        + std::to_string(static_cast<uint8_t>(m_image_format_type))
+        + " not implemented.\n"
+    );
+} // ImageDecoder::getImageContent
+
 void ImageDecoder::resetCachedData() noexcept
 {
     if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
@@ -413,4 +1241,16 @@ void ImageDecoder::swapBytesOrder()
     }
 } // ImageDecoder::swapBytesOrder
 
+void ImageDecoder::setImageByteOrder(utils::typings::ByteOrder byte_order)
+{
+    if (m_image_format_type == utils::typings::ImageFormat::PNG_FORMAT_TYPE)
+    {
+        auto image = getPNGVariantData();
+
+        (*image)->setImageByteOrder(byte_order);
+
+        return;
+    }
+} // ImageDecoder::setImageByteOrder
+
 } // namespace image_formats
@@ -1,36 +1,107 @@
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <cmath>
 
 #include "image-formats/png-format.hpp"
+#include "utils/decode-limits.hpp"
+#include "utils/interruption.hpp"
+#include "utils/mapped-file-resource.hpp"
+#include "utils/pixel-kernels.hpp"
+#include "utils/tracing.hpp"
 #include "utils/utils.hpp"
 #include "utils/zlib-stream-manager.hpp"
 
 namespace image_formats::png_format
 {
 
-PNGFormat::PNGFormat(const std::filesystem::path& image_filepath)
+PNGFormat::PNGFormat
+(
+    const std::filesystem::path& image_filepath,
+    const utils::typings::DecodeOptions& decode_options,
+    std::pmr::memory_resource* memory_resource
+) : m_decode_options(decode_options), m_memory_accounting(memory_resource)
 {
-    m_image_stream.exceptions(std::fstream::badbit | std::fstream::failbit);
-    m_image_stream.open(image_filepath, std::fstream::binary);
+    m_image_file.exceptions(std::fstream::badbit | std::fstream::failbit);
+    m_image_file.open(image_filepath, std::fstream::binary);
 
-    if (not m_image_stream.is_open())
+    if (not m_image_file.is_open())
     {
         std::cerr << "File isn't open, exiting.\n";
         std::exit(EXIT_FAILURE);
     }
 
+    m_image_stream.rdbuf(m_image_file.rdbuf());
+    m_image_stream.exceptions(std::fstream::badbit | std::fstream::failbit);
+
+    decodeImage();
+} // PNGFormat::PNGFormat
+
+PNGFormat::PNGFormat
+(
+    utils::typings::BytesView image_data,
+    const utils::typings::DecodeOptions& decode_options,
+    std::pmr::memory_resource* memory_resource
+) : m_decode_options(decode_options), m_memory_accounting(memory_resource)
+{
+    m_image_memory.emplace(image_data);
+    m_image_stream.rdbuf(&*m_image_memory);
+    // Running out of bytes before IEND throws, the same as a truncated file.
+    m_image_stream.exceptions(std::istream::badbit | std::istream::failbit);
+
+    decodeImage();
+} // PNGFormat::PNGFormat
+
+PNGFormat::~PNGFormat()
+{
+    if (m_image_file.is_open()) { m_image_file.close(); }
+} // PNGFormat::~PNGFormat
+
+void PNGFormat::decodeImage()
+{
+    utils::DecodeStats* decode_stats { decodeStats() };
+    utils::StageTimer decode_timer { decode_stats ? &decode_stats->total_decode : nullptr };
+    utils::tracing::TraceScope decode_trace { utils::tracing::TraceStage::DECODE, m_image_id };
+
     uint32_t width { 0 };
     uint32_t height { 0 };
     uint8_t  stride { 0 };
-    utils::ZlibStreamManager z_lib_stream_manager{};
-    utils::typings::Bytes decompressed_data;
-    readNBytes(m_signature, SIGNATURE_FIELD_BYTES_SIZE);
+
+    if (isOutOfCore())
+    {
+        std::pmr::memory_resource* mapped_file_resource
+        {
+            utils::mappedFileResource(m_decode_options.out_of_core_directory)
+        };
+
+        // Nothing was allocated yet, so the buffers sized by the image can still be moved out of the heap.
+        for (const auto buffer_kind : OUT_OF_CORE_BUFFER_KINDS)
+        {
+            m_memory_accounting.setUpstream(buffer_kind, mapped_file_resource);
+        }
+    }
+    std::pmr::memory_resource* inflate_output_resource
+    {
+        m_memory_accounting.resource(utils::BufferKind::INFLATE_OUTPUT)
+    };
+    utils::ZlibStreamManager z_lib_stream_manager{ 4096, inflate_output_resource };
+    utils::typings::Bytes decompressed_data { inflate_output_resource };
+
+    {
+        utils::StageTimer io_timer { decode_stats ? &decode_stats->io : nullptr };
+
+        readNBytes(m_signature, SIGNATURE_FIELD_BYTES_SIZE);
+    }
+
+    if (decode_stats) { decode_stats->io_bytes += SIGNATURE_FIELD_BYTES_SIZE; }
 
     // Parses all essential chunks chunks
     while (true)
     {
-        Chunk chunk;
+        utils::throwIfInterrupted(m_decode_options, __func__);
+
+        Chunk chunk { m_memory_accounting.resource(utils::BufferKind::CHUNK) };
 
         if (not readNextChunk(chunk)) { break; }
 
@@ -63,25 +134,18 @@ PNGFormat::PNGFormat(const std::filesystem::path& image_filepath)
             height = getImageHeight();
             stride = (m_ihdr.bit_depth * m_number_of_samples + 7) / 8;
 
-            const uint64_t max_scanlines_size
-            {
-                // (width x height x bytes_per_pixel) + extra_filter_bytes
-                getImageScanlinesSize() + height
-            };
+            const uint64_t inflated_size { enforceDecodeLimits() };
 
-            /*!
-             * Do not support images that exceeds the limit of UINT32_MAX:
-            */
-            if (max_scanlines_size > UINT32_MAX)
-            {
-                throw std::runtime_error
-                (
-                    "The file exceeds the reasonable limits of sanity. Please rethink your life choices."
-                );
-            }
+            // Refuses inflating past what IHDR declares, so extra data can't grow the buffer unbounded.
+            if (m_decode_options.memory_budget_bytes) { z_lib_stream_manager.setOutputLimit(inflated_size); }
+
+            decompressed_data.reserve(inflated_size);
         } else if (utils::matches(chunk.m_chunk_type, "PLTE"))
         {
             fillPLTEData(chunk.m_chunk_data);
+        } else if (utils::matches(chunk.m_chunk_type, "tRNS"))
+        {
+            fillTRNSData(chunk.m_chunk_data);
         } else if (utils::matches(chunk.m_chunk_type, "IDAT"))
         {
             /*!
@@ -92,29 +156,81 @@ PNGFormat::PNGFormat(const std::filesystem::path& image_filepath)
              * Processing each IDAT chunk as they come is a better choice here.
             */
 
-            z_lib_stream_manager.decompressData(chunk.m_chunk_data, decompressed_data);
+            utils::tracing::TraceScope inflate_trace { utils::tracing::TraceStage::INFLATE, m_image_id };
+
+            z_lib_stream_manager.decompressData(chunk.m_chunk_data, decompressed_data, decode_stats, &m_decode_options);
         }
     }
 
+    // PLTE and tRNS are both before the first IDAT, so the whole palette is known by now.
+    if (m_color_type == utils::typings::INDEXED_COLOR_TYPE) { fillPaletteRGBA(); }
+
     // Create the scanlines structures to be defiltered
+    const bool reduce_to_8_bits { reducesTo8Bits() };
+    const bool swap_byte_pairs
+    {
+        m_ihdr.bit_depth == 16 and not reduce_to_8_bits
+        and m_decode_options.byte_order != utils::typings::ByteOrder::BIG
+    };
+
     m_scanlines = Scanlines
     (
         getImageScanlineSize(),
         getImageScanlinesSize(),
-        stride
+        stride,
+        swap_byte_pairs,
+        reduce_to_8_bits
     );
 
     /*!
      * Defilter each scanline, leaving them in a state where they can be further processed
      * or returned as is after decompression.
     */
-    m_scanlines.defilterData(decompressed_data, m_defiltered_data);
-} // PNGFormat::PNGFormat
+    utils::tracing::TraceScope defilter_trace { utils::tracing::TraceStage::DEFILTER, m_image_id };
 
-PNGFormat::~PNGFormat()
-{
-    m_image_stream.close();
-} // PNGFormat::~PNGFormat
+    const bool detect_content { m_decode_options.detect_content or m_decode_options.reduce_channels };
+    utils::kernels::SampleStats sample_stats {};
+    std::array<bool, 256> used_palette_entries {};
+    std::function<void(const utils::typings::Byte* row)> detect_row_content;
+
+    if (detect_content)
+    {
+        detect_row_content = [&, bit_depth = reduce_to_8_bits ? uint8_t { 8 } : m_ihdr.bit_depth]
+            (const utils::typings::Byte* row)
+        {
+            detectRowContent(row, bit_depth, sample_stats, used_palette_entries);
+        };
+    }
+
+    m_scanlines.defilterData(decompressed_data, m_defiltered_data, decode_stats, &m_decode_options, detect_row_content);
+    m_memory_accounting.recordBuffer(utils::BufferKind::DEFILTERED, m_defiltered_data.capacity());
+
+    if (swap_byte_pairs) { m_byte_order = utils::typings::ByteOrder::LITTLE; }
+
+    m_image_content.original_color_type = m_color_type;
+
+    if (detect_content) { finishImageContent(sample_stats, used_palette_entries); }
+
+    // From here on the image is 8 bit deep, every size and conversion follows from it.
+    if (reduce_to_8_bits)
+    {
+        m_ihdr.bit_depth = 8;
+
+        // Several 16 bit colors round to the same 8 bit one, all of them end up transparent.
+        if (m_transparent_color)
+        {
+            for (auto& sample : *m_transparent_color) { sample = static_cast<uint16_t>((sample * 255u + 32895u) >> 16); }
+        }
+    }
+
+    if (m_decode_options.reduce_channels)
+    {
+        // Freed first, so the reduced copy fits in what the inflated data took and stays within the decode's budget.
+        utils::typings::Bytes (decompressed_data.get_allocator()).swap(decompressed_data);
+
+        reduceChannels();
+    }
+} // PNGFormat::decodeImage
 
 void PNGFormat::readNBytes(utils::typings::Bytes& data, std::streamsize n_bytes)
 {
@@ -137,19 +253,43 @@ bool PNGFormat::readNextChunk(Chunk& chunk)
     uint32_t length { 0 };
     uint32_t crc { 0 };
     uint32_t data_crc { 0 };
+    utils::DecodeStats* decode_stats { decodeStats() };
+
+    if (decode_stats) { ++decode_stats->chunks; }
+
+    {
+        utils::StageTimer io_timer { decode_stats ? &decode_stats->io : nullptr };
+        utils::tracing::TraceScope chunk_read_trace { utils::tracing::TraceStage::CHUNK_READ, m_image_id };
+
+        readNBytes(&length, CHUNK_LENGTH_FIELD_BYTES_SIZE);
+        readNBytes(chunk.m_chunk_type, CHUNK_TYPE_FIELD_BYTES_SIZE);
+
+        length = utils::convertFromNetworkByteOrder(length);
+
+        if (utils::matches(chunk.m_chunk_type, "IEND"))
+        {
+            if (decode_stats) { decode_stats->io_bytes += CHUNK_LENGTH_FIELD_BYTES_SIZE + CHUNK_TYPE_FIELD_BYTES_SIZE; }
 
-    readNBytes(&length, CHUNK_LENGTH_FIELD_BYTES_SIZE);
-    readNBytes(chunk.m_chunk_type, CHUNK_TYPE_FIELD_BYTES_SIZE);
+            return false;
+        }
 
-    length = utils::convertFromNetworkByteOrder(length);
+        enforceMemoryBudget(length, "chunk");
+        chunk.m_chunk_data.resize(length);
+        readNBytes(chunk.m_chunk_data, length);
+        readNBytes(&crc, CRC_FIELD_BYTES_SIZE);
 
-    if (utils::matches(chunk.m_chunk_type, "IEND")) { return false; }
+        crc = utils::convertFromNetworkByteOrder(crc);
+    }
 
-    chunk.m_chunk_data.resize(length);
-    readNBytes(chunk.m_chunk_data, length);
-    readNBytes(&crc, CRC_FIELD_BYTES_SIZE);
+    if (decode_stats)
+    {
+        decode_stats->io_bytes +=
+            CHUNK_LENGTH_FIELD_BYTES_SIZE + CHUNK_TYPE_FIELD_BYTES_SIZE + length + CRC_FIELD_BYTES_SIZE;
+        decode_stats->crc_bytes += CHUNK_TYPE_FIELD_BYTES_SIZE + length;
+    }
 
-    crc = utils::convertFromNetworkByteOrder(crc);
+    utils::StageTimer crc_timer { decode_stats ? &decode_stats->crc : nullptr };
+    utils::tracing::TraceScope crc_trace { utils::tracing::TraceStage::CRC, m_image_id };
 
     /*!
      * We first calculate the crc of the first 4 bytes (the chunk type)
@@ -207,6 +347,50 @@ void PNGFormat::fillPLTEData(utils::typings::Bytes& data)
     m_palette = std::move(data);
 } // PNGFormat::fillPLTEData
 
+void PNGFormat::fillTRNSData(utils::typings::Bytes& data)
+{
+    if (m_color_type == utils::typings::INDEXED_COLOR_TYPE)
+    {
+        if (data.size() > 256)
+        {
+            throw std::runtime_error
+            (
+                __func__
+                + std::string("\ntRNS chunk have unsupported size for indexed images: ")
+                + std::to_string(data.size()) + "\n"
+            );
+        }
+
+        m_palette_alphas = std::move(data);
+
+        return;
+    }
+
+    const bool grayscale { m_color_type == utils::typings::GRAYSCALE_COLOR_TYPE };
+
+    if (not grayscale and m_color_type != utils::typings::RGB_COLOR_TYPE) { return; }
+
+    if (data.size() != (grayscale ? 2u : 6u))
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\ntRNS chunk have unsupported size: ")
+            + std::to_string(data.size()) + "\n"
+        );
+    }
+
+    // Samples are always two bytes big endian, whatever the bit depth.
+    std::array<uint16_t, 3> color {};
+
+    for (size_t i = 0; i < data.size() / 2; ++i)
+    {
+        color[i] = static_cast<uint16_t>(static_cast<uint16_t>(data[2 * i]) << 8 | static_cast<uint16_t>(data[2 * i + 1]));
+    }
+
+    m_transparent_color = color;
+} // PNGFormat::fillTRNSData
+
 void PNGFormat::unpackData
 (
     utils::typings::CBytes& src,
@@ -233,25 +417,29 @@ void PNGFormat::unpackData
         );
     }
 
+    if (m_color_type == utils::typings::INDEXED_COLOR_TYPE)
+    {
+        expandIndexedData(src, dest, 3);
+
+        return;
+    }
+
     /*!
      * Only indexed color images and grayscale supports less than 8 bit depth,
-     * and only indexed color uses three channels, grayscale will always use just one.
+     * indexed color images were expanded above, what's left is grayscale which always uses just one channel.
     */
     const uint8_t bit_depth { m_ihdr.bit_depth };
     const uint32_t width { getImageWidth() };
     const uint32_t height { getImageHeight() };
-    const uint32_t scanline_size { getImageScanlineSize() };
+    const uint64_t scanline_size { getImageScanlineSize() };
     const uint8_t samples_per_byte = 8 / m_ihdr.bit_depth;
     const double scaling_factor = (255.0 / ((1 << m_ihdr.bit_depth) - 1));
     const uint8_t mask = (1 << m_ihdr.bit_depth) - 1;
 
-    if (m_color_type == utils::typings::INDEXED_COLOR_TYPE)
-    {
-        dest.reserve(width * height * 3);
-    } else
-    {
-        dest.reserve(width * height);
-    }
+    // Sized once, every byte is then written by index (the allocator doesn't zero them first).
+    dest.resize(uint64_t { width } * height);
+
+    utils::typings::Byte* output { dest.data() };
 
     /*!
      * When constructing the scanlines above, we had to account for padding bits for the last byte,
@@ -295,33 +483,17 @@ void PNGFormat::unpackData
              * gives us the exact index of the bit(s) relative to their respective position within the image's width,
              * then we just scale this index by the number of pixels we are working with inside each bytes.
             */
-            const uint32_t byte_index = (row * scanline_size) + (column / samples_per_byte);
+            const uint64_t byte_index = (row * scanline_size) + (column / samples_per_byte);
             const uint32_t bits_offset = (samples_per_byte - 1 - (column % samples_per_byte)) * bit_depth;
 
             /*!
-             * This may be a index for indexed color type, or a color, for grayscale color type.
+             * The grayscale color of the pixel.
              *
              * The mask has the width of the bit_set, it correctly isolates just the samples within the byte we want.
             */
             const uint8_t data = static_cast<uint8_t>(src[byte_index] >> bits_offset) & mask;
 
-            if (m_color_type == utils::typings::INDEXED_COLOR_TYPE)
-            {
-                /*!
-                 * The index is relative to colors, and not bytes, as every color inside the palette is in rgb format
-                 * it always have three bytes for color (even for grayscale (just two colors) indexed images),
-                 * so we must account for it to index the right color/right channel.
-                */
-                dest.emplace_back(m_palette[data * 3]);         // red
-                dest.emplace_back(m_palette[(data * 3) + 1]);   // green
-                dest.emplace_back(m_palette[(data * 3) + 2]);   // blue
-
-                continue;
-            }
-
             /*!
-             * If the image is not of the indexed type, rest just the grayscale image to unpack.
-             *
              * As the bit depth at most 4 which translate at maximum value of 15,
              * we have to scale this 1, 2, 4 bit depth colors back to 8 bit depth.
              *
@@ -332,11 +504,209 @@ void PNGFormat::unpackData
              * max_value_for_bit_depth = 2ⁿ-1
              * scaling_factor = rounded_up(max_8_bit_color / max_value_for_bit_depth)
             */
-            dest.emplace_back(utils::typings::Byte(std::round(data * scaling_factor)));
+            *output++ = utils::typings::Byte(std::round(data * scaling_factor));
         }
     }
 }
 
+void PNGFormat::expandIndexedData
+(
+    utils::typings::CBytes& src,
+    utils::typings::Bytes& dest,
+    uint8_t channels
+) const
+{
+    const uint32_t width { getImageWidth() };
+    const uint32_t height { getImageHeight() };
+    const uint64_t scanline_size { getImageScanlineSize() };
+    const uint64_t row_size { uint64_t { width } * channels };
+
+    if (src.size() < scanline_size * height)
+    {
+        throw std::out_of_range(std::string("Out of range iterators: ") + __func__);
+    }
+
+    // Sized once, every byte is then written by the expansion (the allocator doesn't zero them first).
+    dest.resize(row_size * height);
+
+    for (uint64_t row = 0; row < height; ++row)
+    {
+        utils::kernels::expandPaletteIndices
+        (
+            src.data() + row * scanline_size,
+            m_ihdr.bit_depth,
+            width,
+            m_palette_rgba,
+            dest.data() + row * row_size,
+            channels
+        );
+    }
+} // PNGFormat::expandIndexedData
+
+template<typename Sample>
+void PNGFormat::expandRow
+(
+    const utils::typings::Byte* src,
+    Sample* dest,
+    uint8_t channels
+) const
+{
+    using utils::typings::Byte;
+
+    const uint32_t width { getImageWidth() };
+    const uint8_t bit_depth { m_ihdr.bit_depth };
+    // 16 bit samples may have been swapped to little endian.
+    const size_t high { (m_byte_order == utils::typings::ByteOrder::LITTLE) ? 1u : 0u };
+    const uint32_t opaque { (bit_depth == 16) ? 0xFFFFu : 0xFFu }; // Before toSample.
+    const uint32_t no_key { 0x10000 }; // Never matches a sample.
+    const std::array<uint32_t, 3> key
+    {
+        m_transparent_color ? (*m_transparent_color)[0] : no_key,
+        m_transparent_color ? (*m_transparent_color)[1] : no_key,
+        m_transparent_color ? (*m_transparent_color)[2] : no_key
+    };
+
+    const auto sample16 = [src, high](size_t index) -> uint32_t
+    {
+        return static_cast<uint32_t>(src[2 * index + high]) << 8 | static_cast<uint32_t>(src[2 * index + 1 - high]);
+    };
+    const auto toSample = [bit_depth](uint32_t sample) -> Sample
+    {
+        // round(sample * 255 / 65535) for 16 bit samples (see utils::kernels::reduce16To8).
+        if constexpr (std::is_same_v<Sample, Byte>)
+        {
+            return (bit_depth == 16) ? Byte((sample * 255 + 32895) >> 16) : Byte(sample);
+        } else
+        {
+            return static_cast<Sample>(sample);
+        }
+    };
+    const auto write = [&dest, channels](Sample red, Sample green, Sample blue, Sample alpha)
+    {
+        dest[0] = red;
+        dest[1] = green;
+        dest[2] = blue;
+
+        if (channels == 4) { dest[3] = alpha; }
+
+        dest += channels;
+    };
+
+    if constexpr (std::is_same_v<Sample, Byte>)
+    {
+        if (m_color_type == utils::typings::INDEXED_COLOR_TYPE)
+        {
+            utils::kernels::expandPaletteIndices(src, bit_depth, width, m_palette_rgba, dest, channels);
+
+            return;
+        }
+    }
+
+    if (bit_depth < 8)
+    {
+        // Same unpacking as unpackData, a row at a time, grayscale scaled by 255 / (2ⁿ - 1) which is exact.
+        const uint8_t samples_per_byte = 8 / bit_depth;
+        const uint8_t mask = static_cast<uint8_t>((1 << bit_depth) - 1);
+        const uint8_t scale = static_cast<uint8_t>(255 / mask);
+
+        for (uint32_t column = 0; column < width; ++column)
+        {
+            const uint32_t bits_offset = (samples_per_byte - 1 - (column % samples_per_byte)) * bit_depth;
+            const uint8_t data = static_cast<uint8_t>(src[column / samples_per_byte] >> bits_offset) & mask;
+            const Sample gray { toSample(data * scale) };
+
+            write(gray, gray, gray, toSample((data == key[0]) ? 0 : opaque));
+        }
+
+        return;
+    }
+
+    const bool wide { bit_depth == 16 };
+    const auto sample = [&](size_t index) -> uint32_t
+    {
+        return wide ? sample16(index) : static_cast<uint32_t>(src[index]);
+    };
+
+    for (size_t column = 0; column < width; ++column)
+    {
+        switch (m_color_type)
+        {
+            case utils::typings::GRAYSCALE_COLOR_TYPE:
+            {
+                const uint32_t gray { sample(column) };
+                const uint32_t alpha { (gray == key[0]) ? 0 : opaque };
+
+                write(toSample(gray), toSample(gray), toSample(gray), toSample(alpha));
+                break;
+            }
+            case utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE:
+            {
+                const Sample gray { toSample(sample(column * 2)) };
+
+                write(gray, gray, gray, toSample(sample(column * 2 + 1)));
+                break;
+            }
+            case utils::typings::RGB_COLOR_TYPE:
+            {
+                const uint32_t red { sample(column * 3) };
+                const uint32_t green { sample(column * 3 + 1) };
+                const uint32_t blue { sample(column * 3 + 2) };
+                const bool transparent { red == key[0] and green == key[1] and blue == key[2] };
+                const uint32_t alpha { transparent ? 0 : opaque };
+
+                write(toSample(red), toSample(green), toSample(blue), toSample(alpha));
+                break;
+            }
+            default:
+                write
+                (
+                    toSample(sample(column * 4)),
+                    toSample(sample(column * 4 + 1)),
+                    toSample(sample(column * 4 + 2)),
+                    toSample(sample(column * 4 + 3))
+                );
+                break;
+        }
+    }
+} // PNGFormat::expandRow
+
+void PNGFormat::convertRow
+(
+    const utils::typings::Byte* src,
+    utils::typings::Byte* dest,
+    uint8_t channels
+) const
+{
+    if (m_ihdr.bit_depth != 16)
+    {
+        expandRow(src, dest, channels);
+
+        return;
+    }
+
+    expandRow(src, reinterpret_cast<uint16_t*>(dest), channels);
+
+    if (m_byte_order != utils::typings::ByteOrder::NATIVE)
+    {
+        utils::kernels::swapBytePairs(dest, uint64_t { getImageWidth() } * channels * 2);
+    }
+} // PNGFormat::convertRow
+
+void PNGFormat::fillPaletteRGBA() noexcept
+{
+    for (size_t i = 0; i < m_palette_rgba.size(); ++i)
+    {
+        std::array<utils::typings::Byte, 4> color { {} };
+
+        if (i * 3 + 2 < m_palette.size()) { std::copy_n(m_palette.begin() + i * 3, 3, color.begin()); }
+
+        color[3] = (i < m_palette_alphas.size()) ? m_palette_alphas[i] : utils::typings::Byte { 0xFF };
+
+        // Packed in memory order, so copying an entry's first bytes gives rgb or rgba whatever the host's byte order.
+        std::memcpy(&m_palette_rgba[i], color.data(), color.size());
+    }
+} // PNGFormat::fillPaletteRGBA
+
 void PNGFormat::convertDataToRGB
 (
     utils::typings::CBytes& src,
@@ -349,28 +719,28 @@ void PNGFormat::convertDataToRGB
     const uint32_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
     const uint32_t height = utils::convertFromNetworkByteOrder(m_ihdr.height);
 
+    /*!
+     * width * height * channel_size * three_channels
+     *
+     * Sized once, every byte is then written by index (the allocator doesn't zero them first).
+    */
+    dest.resize(uint64_t { width } * height * (bit_depth / 8) * 3);
+
+    utils::typings::Byte* output { dest.data() };
+
     if (m_color_type == utils::typings::RGBA_COLOR_TYPE)
     {
-        dest.reserve(width * height * (bit_depth / 8) * 3);
-
         if (m_ihdr.bit_depth == 16)
         {
-            for (uint32_t i = 0; i < src.size(); i += 8)
+            for (size_t i = 0; i < src.size(); i += 8, output += 6)
             {
-                const uint8_t first_byte_red = static_cast<uint8_t>(src[i]);
-                const uint8_t second_byte_red = static_cast<uint8_t>(src[i + 1]);
-                const uint8_t first_byte_green = static_cast<uint8_t>(src[i + 2]);
-                const uint8_t second_byte_green = static_cast<uint8_t>(src[i + 3]);
-                const uint8_t first_byte_blue = static_cast<uint8_t>(src[i + 4]);
-                const uint8_t second_byte_blue = static_cast<uint8_t>(src[i + 5]);
                 // Alpha skipped
-
-                dest.emplace_back(utils::typings::Byte(first_byte_red));
-                dest.emplace_back(utils::typings::Byte(second_byte_red));
-                dest.emplace_back(utils::typings::Byte(first_byte_green));
-                dest.emplace_back(utils::typings::Byte(second_byte_green));
-                dest.emplace_back(utils::typings::Byte(first_byte_blue));
-                dest.emplace_back(utils::typings::Byte(second_byte_blue));
+                output[0] = src[i];         // red
+                output[1] = src[i + 1];
+                output[2] = src[i + 2];     // green
+                output[3] = src[i + 3];
+                output[4] = src[i + 4];     // blue
+                output[5] = src[i + 5];
             }
 
             return;
@@ -378,16 +748,12 @@ void PNGFormat::convertDataToRGB
 
         if (m_ihdr.bit_depth == 8)
         {
-            for (uint8_t i = 0; i < src.size(); i += 4)
+            for (size_t i = 0; i < src.size(); i += 4, output += 3)
             {
-                const uint8_t red = static_cast<uint8_t>(src[i]);
-                const uint8_t green = static_cast<uint8_t>(src[i + 1]);
-                const uint8_t blue = static_cast<uint8_t>(src[i + 2]);
                 // Alpha skipped
-
-                dest.emplace_back(utils::typings::Byte(red));
-                dest.emplace_back(utils::typings::Byte(green));
-                dest.emplace_back(utils::typings::Byte(blue));
+                output[0] = src[i];         // red
+                output[1] = src[i + 1];     // green
+                output[2] = src[i + 2];     // blue
             }
 
             return;
@@ -411,17 +777,17 @@ void PNGFormat::convertDataToRGB
     {
         if (m_ihdr.bit_depth == 16)
         {
-            for (auto it = src.begin(); it != src.end(); it += 2)
+            for (size_t i = 0; i < src.size(); i += 2, output += 6)
             {
                 // red
-                dest.emplace_back(*it);
-                dest.emplace_back(*(it+1));
+                output[0] = src[i];
+                output[1] = src[i + 1];
                 // green
-                dest.emplace_back(*it);
-                dest.emplace_back(*(it+1));
+                output[2] = src[i];
+                output[3] = src[i + 1];
                 // blue
-                dest.emplace_back(*it);
-                dest.emplace_back(*(it+1));
+                output[4] = src[i];
+                output[5] = src[i + 1];
             }
 
             return;
@@ -431,23 +797,25 @@ void PNGFormat::convertDataToRGB
         {
             for (auto byte : src)
             {
-                dest.emplace_back(byte); // red
-                dest.emplace_back(byte); // green
-                dest.emplace_back(byte); // blue
+                output[0] = byte; // red
+                output[1] = byte; // green
+                output[2] = byte; // blue
+                output += 3;
             }
 
             return;
         }
 
-        utils::typings::Bytes temp_dest;
+        utils::typings::Bytes temp_dest { dest.get_allocator() };
 
         unpackData(src, temp_dest);
 
         for (auto byte : temp_dest)
         {
-            dest.emplace_back(byte); // red
-            dest.emplace_back(byte); // green
-            dest.emplace_back(byte); // blue
+            output[0] = byte; // red
+            output[1] = byte; // green
+            output[2] = byte; // blue
+            output += 3;
         }
 
         return;
@@ -457,17 +825,17 @@ void PNGFormat::convertDataToRGB
     {
         if (m_ihdr.bit_depth == 16)
         {
-            for (auto it = src.begin(); it != src.end(); it += 4)
+            for (size_t i = 0; i < src.size(); i += 4, output += 6)
             {
                 // red
-                dest.emplace_back(*it);
-                dest.emplace_back(*(it+1));
+                output[0] = src[i];
+                output[1] = src[i + 1];
                 // green
-                dest.emplace_back(*it);
-                dest.emplace_back(*(it+1));
+                output[2] = src[i];
+                output[3] = src[i + 1];
                 // blue
-                dest.emplace_back(*it);
-                dest.emplace_back(*(it+1));
+                output[4] = src[i];
+                output[5] = src[i + 1];
             }
 
             return;
@@ -475,11 +843,11 @@ void PNGFormat::convertDataToRGB
 
         if (m_ihdr.bit_depth == 8)
         {
-            for (auto it = src.begin(); it != src.end(); it += 2)
+            for (size_t i = 0; i < src.size(); i += 2, output += 3)
             {
-                dest.emplace_back(*it); // red
-                dest.emplace_back(*it); // green
-                dest.emplace_back(*it); // blue
+                output[0] = src[i]; // red
+                output[1] = src[i]; // green
+                output[2] = src[i]; // blue
             }
 
             return;
@@ -488,15 +856,16 @@ void PNGFormat::convertDataToRGB
         /*!
          * Case the bit depth is less than 8 bits, unpackData will handle it
         */
-        utils::typings::Bytes temp_dest;
+        utils::typings::Bytes temp_dest { dest.get_allocator() };
 
         unpackData(src, temp_dest);
 
         for (auto byte : temp_dest)
         {
-            dest.emplace_back(byte); // red
-            dest.emplace_back(byte); // green
-            dest.emplace_back(byte); // blue
+            output[0] = byte; // red
+            output[1] = byte; // green
+            output[2] = byte; // blue
+            output += 3;
         }
 
         return;
@@ -518,113 +887,77 @@ void PNGFormat::convertDataToRGBA
 {
     if (m_color_type == utils::typings::RGBA_COLOR_TYPE) { return; }
 
-    utils::typings::Bytes temp_dest;
-    const uint8_t bit_depth = m_ihdr.bit_depth == 16 ? 16 : 8;
+    const uint32_t height { getImageHeight() };
+    const uint64_t scanline_size { getImageScanlineSize() };
+    const uint64_t row_size { getImageRGBAScanlineSize() };
 
-    if (dest.empty())
+    if (src.size() < scanline_size * height)
     {
-        const uint32_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
-        const uint32_t height = utils::convertFromNetworkByteOrder(m_ihdr.height);
-
-        /*!
-         * width * height * channel_size * four_channels
-        */
-        dest.reserve(width * height * (bit_depth / 8) * 4);
+        throw std::out_of_range(std::string("Out of range iterators: ") + __func__);
     }
 
-    /*!
-     * Performance wise it would be better to parse the source data here
-     * and add the alpha next, but it would be too much boilerplate and error prone
-     * to write everything again, so let's use the convertDataToRGB instead.
-    */
-    convertDataToRGB(src, temp_dest);
-
-    /*!
-     * If the data already is in rgb, no conversion is necessary,
-     * use the source vector data instead.
-    */
-    utils::typings::CBytes& rgb_data = (not temp_dest.empty()) ? temp_dest : src;
-
-    /*!
-     * Handles the 16 bit depth.
-    */
-    if (bit_depth == 16)
-    {
-        for (uint32_t i = 0; i < rgb_data.size(); i += 6)
-        {
-            // red
-            dest.emplace_back(rgb_data[i]);
-            dest.emplace_back(rgb_data[i + 1]);
-            // green
-            dest.emplace_back(rgb_data[i + 2]);
-            dest.emplace_back(rgb_data[i + 3]);
-            // blue
-            dest.emplace_back(rgb_data[i + 4]);
-            dest.emplace_back(rgb_data[i + 5]);
-            // alpha 0xFFFF
-            dest.emplace_back(utils::typings::Byte(0xFF));
-            dest.emplace_back(utils::typings::Byte(0xFF));
-        }
-
-        return;
-    }
+    // Sized once, every byte is then written by the expansion (the allocator doesn't zero them first).
+    dest.resize(row_size * height);
 
     /*!
-     * Handles the bit 8 bit depth.
+     * A row at a time, so the alpha comes from wherever the color type keeps it (the alpha channel,
+     * the palette or the tRNS key), and no intermediate rgb copy of the whole image is needed.
     */
-    for (uint32_t i = 0; i < rgb_data.size(); i += 3)
+    for (uint64_t row = 0; row < height; ++row)
     {
-        dest.emplace_back(rgb_data[i]);                 // red
-        dest.emplace_back(rgb_data[i + 1]);             // green
-        dest.emplace_back(rgb_data[i + 2]);             // blue
-        dest.emplace_back(utils::typings::Byte(0xFF));  // alpha 0xFF
+        convertRow(src.data() + row * scanline_size, dest.data() + row * row_size, 4);
     }
 } // PNGFormat::convertDataToRGBA
 
-uint32_t PNGFormat::getImageScanlineSize() const noexcept
+uint64_t PNGFormat::getImageScanlineSize() const noexcept
 {
-    const uint32_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
+    const uint64_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
 
     return ((width * m_ihdr.bit_depth * m_number_of_samples + 7) / 8);
 } // PNGFormat::getScanlinesSize
 
-uint32_t PNGFormat::getImageScanlinesSize() const noexcept
+uint64_t PNGFormat::getImageScanlinesSize() const noexcept
 {
     const uint32_t height = utils::convertFromNetworkByteOrder(m_ihdr.height);
 
     return getImageScanlineSize() * height;
 } // PNGFormat::getScanlinesSize
 
-uint32_t PNGFormat::getImageRGBScanlineSize() const noexcept
+uint64_t PNGFormat::getImageRGBScanlineSize() const noexcept
 {
-    const uint32_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
+    const uint64_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
     const uint8_t bit_depth = (m_ihdr.bit_depth <= 8) ? 8 : 16;
 
     return (width * bit_depth * 3 / 8);
 } // PNGFormat::getImageRGBScanlineSize
 
-uint32_t PNGFormat::getImageRGBScanlinesSize() const noexcept
+uint64_t PNGFormat::getImageRGBScanlinesSize() const noexcept
 {
     const uint32_t height = utils::convertFromNetworkByteOrder(m_ihdr.height);
 
     return getImageRGBScanlineSize() * height;
 } // PNGFormat::getImageRGBScanlineSize
 
-uint32_t PNGFormat::getImageRGBAScanlineSize() const noexcept
+uint64_t PNGFormat::getImageRGBAScanlineSize() const noexcept
 {
-    const uint32_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
+    const uint64_t width = utils::convertFromNetworkByteOrder(m_ihdr.width);
     const uint8_t bit_depth = (m_ihdr.bit_depth <= 8) ? 8 : 16;
 
     return (width * bit_depth * 4 / 8);
 } // PNGFormat::getImageRGBAScanlineSize
 
-uint32_t PNGFormat::getImageRGBAScanlinesSize() const noexcept
+uint64_t PNGFormat::getImageRGBAScanlinesSize() const noexcept
 {
     const uint32_t height = utils::convertFromNetworkByteOrder(m_ihdr.height);
 
     return getImageRGBAScanlineSize() * height;
 } // PNGFormat::getImageRGBAScanlineSize
 
+uint64_t PNGFormat::getImagePlaneRowSize() const noexcept
+{
+    return uint64_t { getImageWidth() } * ((m_ihdr.bit_depth == 16) ? 2 : 1);
+} // PNGFormat::getImagePlaneRowSize
+
 
 utils::typings::CBytes& PNGFormat::getRawDataConstRef() noexcept
 {
@@ -641,74 +974,881 @@ uint8_t* PNGFormat::getRawDataBuffer() noexcept
     return std::bit_cast<uint8_t*>(m_defiltered_data.data());
 } // PNGFormat::getRawDataPtr
 
-utils::typings::Bytes PNGFormat::getRawDataRGB() noexcept
+utils::typings::Bytes PNGFormat::getRawDataRGB()
 {
     if (m_color_type == utils::typings::RGB_COLOR_TYPE)
     {
         return m_defiltered_data;
     }
 
-    if (not m_defiltered_data_rgb.empty())
-    {
-        return m_defiltered_data_rgb;
-    }
-
-    convertDataToRGB(m_defiltered_data, m_defiltered_data_rgb);
+    fillRGBCache();
 
     return m_defiltered_data_rgb;
 } // PNGFormat::getRawDataRGB
 
-uint8_t* PNGFormat::getRawDataRGBBuffer() noexcept
+uint8_t* PNGFormat::getRawDataRGBBuffer()
 {
     if (m_color_type == utils::typings::RGB_COLOR_TYPE)
     {
         return std::bit_cast<uint8_t*>(m_defiltered_data.data());
     }
 
-    if (not m_defiltered_data_rgb.empty())
-    {
-        return std::bit_cast<uint8_t*>(m_defiltered_data_rgb.data());
-    }
-
-    convertDataToRGB(m_defiltered_data, m_defiltered_data_rgb);
+    fillRGBCache();
 
     return std::bit_cast<uint8_t*>(m_defiltered_data_rgb.data());
 } // PNGFormat::getRawDataRGBBuffer
 
-utils::typings::Bytes PNGFormat::getRawDataRGBA() noexcept
+utils::typings::Bytes PNGFormat::getRawDataRGBA()
 {
     if (m_color_type == utils::typings::RGBA_COLOR_TYPE)
     {
         return m_defiltered_data;
     }
 
-    if (not m_defiltered_data_rgba.empty())
-    {
-        return m_defiltered_data_rgba;
-    }
-
-    convertDataToRGBA(m_defiltered_data, m_defiltered_data_rgba);
+    fillRGBACache();
 
     return m_defiltered_data_rgba;
 } // PNGFormat::getRawDataRGBA
 
-uint8_t* PNGFormat::getRawDataRGBABuffer() noexcept
+uint8_t* PNGFormat::getRawDataRGBABuffer()
 {
     if (m_color_type == utils::typings::RGBA_COLOR_TYPE)
     {
         return std::bit_cast<uint8_t*>(m_defiltered_data.data());
     }
 
-    if (not m_defiltered_data_rgba.empty())
-    {
-        return std::bit_cast<uint8_t*>(m_defiltered_data_rgba.data());
-    }
-
-    convertDataToRGBA(m_defiltered_data, m_defiltered_data_rgba);
+    fillRGBACache();
 
     return std::bit_cast<uint8_t*>(m_defiltered_data_rgba.data());
 } // PNGFormat::getRawDataRGBABuffer
 
+utils::typings::BytesView PNGFormat::getRawDataView() noexcept
+{
+    return m_defiltered_data;
+} // PNGFormat::getRawDataView
+
+utils::typings::BytesView PNGFormat::getRawDataRGBView()
+{
+    if (m_color_type == utils::typings::RGB_COLOR_TYPE)
+    {
+        return m_defiltered_data;
+    }
+
+    fillRGBCache();
+
+    return m_defiltered_data_rgb;
+} // PNGFormat::getRawDataRGBView
+
+utils::typings::BytesView PNGFormat::getRawDataRGBAView()
+{
+    if (m_color_type == utils::typings::RGBA_COLOR_TYPE)
+    {
+        return m_defiltered_data;
+    }
+
+    fillRGBACache();
+
+    return m_defiltered_data_rgba;
+} // PNGFormat::getRawDataRGBAView
+
+utils::AlignedBuffer PNGFormat::getRawDataAligned(const utils::RowLayout& row_layout)
+{
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to copy.\n"));
+    }
+
+    return copyRowsAligned(getRawDataView(), getImageScanlineSize(), row_layout);
+} // PNGFormat::getRawDataAligned
+
+utils::AlignedBuffer PNGFormat::getRawDataRGBAligned(const utils::RowLayout& row_layout)
+{
+    return convertRowsAligned(3, row_layout);
+} // PNGFormat::getRawDataRGBAligned
+
+utils::AlignedBuffer PNGFormat::getRawDataRGBAAligned(const utils::RowLayout& row_layout)
+{
+    return convertRowsAligned(4, row_layout);
+} // PNGFormat::getRawDataRGBAAligned
+
+void PNGFormat::convertRawDataInto
+(
+    utils::typings::PixelFormat pixel_format,
+    utils::typings::MutableBytesView dest,
+    uint64_t stride
+)
+{
+    const uint64_t width { getImageWidth() };
+    const uint64_t height { getImageHeight() };
+    const uint64_t row_size { width * 4 };
+
+    if (not stride) { stride = row_size; }
+
+    if (stride < row_size)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nStride of ") + std::to_string(stride)
+            + " bytes is smaller than a row of " + std::to_string(row_size) + " bytes.\n"
+        );
+    }
+
+    if (height and (dest.size() < row_size or (height > 1 and (dest.size() - row_size) / (height - 1) < stride)))
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nBuffer of ") + std::to_string(dest.size())
+            + " bytes is too small for " + std::to_string(height) + " rows of " + std::to_string(row_size)
+            + " bytes, " + std::to_string(stride) + " bytes apart.\n"
+        );
+    }
+
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to convert.\n"));
+    }
+
+    utils::tracing::TraceScope conversion_trace { utils::tracing::TraceStage::CONVERSION, m_image_id };
+
+    const uint64_t scanline_size { getImageScanlineSize() };
+    const bool rgba_rows { m_ihdr.bit_depth == 8 and m_color_type == utils::typings::RGBA_COLOR_TYPE };
+    const bool rgb_rows
+    {
+        m_ihdr.bit_depth == 8 and m_color_type == utils::typings::RGB_COLOR_TYPE and not m_transparent_color
+    };
+
+    // Any other row is first expanded to rgba here, it's still in cache when it gets swizzled.
+    utils::typings::Bytes rgba_row(rgba_rows or rgb_rows ? 0 : row_size);
+
+    for (uint64_t row = 0; row < height; ++row)
+    {
+        const utils::typings::Byte* scanline { m_defiltered_data.data() + row * scanline_size };
+        utils::typings::Byte* output { dest.data() + row * stride };
+
+        if (rgba_rows)
+        {
+            utils::kernels::rgbaToPixelFormat(scanline, output, width, pixel_format);
+        } else if (rgb_rows)
+        {
+            utils::kernels::rgbToPixelFormat(scanline, output, width, pixel_format);
+        } else
+        {
+            expandRow(scanline, rgba_row.data());
+            utils::kernels::rgbaToPixelFormat(rgba_row.data(), output, width, pixel_format);
+        }
+    }
+} // PNGFormat::convertRawDataInto
+
+utils::typings::Bytes PNGFormat::getRawDataPixelFormat(utils::typings::PixelFormat pixel_format)
+{
+    utils::typings::Bytes pixels(uint64_t { getImageWidth() } * getImageHeight() * 4);
+
+    convertRawDataInto(pixel_format, pixels);
+
+    return pixels;
+} // PNGFormat::getRawDataPixelFormat
+
+utils::AlignedBuffer PNGFormat::getRawDataPixelFormatAligned
+(
+    utils::typings::PixelFormat pixel_format,
+    const utils::RowLayout& row_layout
+)
+{
+    utils::AlignedBuffer pixels { uint64_t { getImageWidth() } * 4, getImageHeight(), row_layout };
+
+    convertRawDataInto(pixel_format, { pixels.data(), pixels.size() }, pixels.stride());
+
+    return pixels;
+} // PNGFormat::getRawDataPixelFormatAligned
+
+uint64_t PNGFormat::getImageTensorSize(const utils::typings::TensorOptions& tensor_options) const noexcept
+{
+    const uint64_t element_size { (tensor_options.data_type == utils::typings::TensorDataType::FLOAT32) ? 4u : 2u };
+    const uint64_t width { tensor_options.width ? tensor_options.width : getImageWidth() };
+    const uint64_t height { tensor_options.height ? tensor_options.height : getImageHeight() };
+
+    return width * height * tensor_options.channels * element_size;
+} // PNGFormat::getImageTensorSize
+
+void PNGFormat::convertRawDataToTensor
+(
+    const utils::typings::TensorOptions& tensor_options,
+    utils::typings::MutableBytesView dest
+)
+{
+    const uint8_t channels { tensor_options.channels };
+
+    if (channels != 3 and channels != 4)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nTensors have 3 or 4 channels, not ") + std::to_string(static_cast<uint32_t>(channels)) + ".\n"
+        );
+    }
+
+    const uint64_t image_width { getImageWidth() };
+    const uint64_t image_height { getImageHeight() };
+    const uint64_t width { tensor_options.width ? tensor_options.width : image_width };
+    const uint64_t height { tensor_options.height ? tensor_options.height : image_height };
+
+    if ((width != image_width or height != image_height) and tensor_options.fit == utils::typings::TensorFit::EXACT)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nThe image is ") + std::to_string(image_width) + "x" + std::to_string(image_height)
+            + ", not " + std::to_string(width) + "x" + std::to_string(height) + " like the tensor.\n"
+        );
+    }
+
+    const bool float32 { tensor_options.data_type == utils::typings::TensorDataType::FLOAT32 };
+    const uint64_t element_size { float32 ? 4u : 2u };
+
+    if (dest.size() < getImageTensorSize(tensor_options)
+        or std::bit_cast<std::uintptr_t>(dest.data()) % element_size)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nBuffer of ") + std::to_string(dest.size()) + " bytes is too small for a tensor of "
+            + std::to_string(getImageTensorSize(tensor_options)) + " bytes, or isn't aligned to its elements.\n"
+        );
+    }
+
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to convert.\n"));
+    }
+
+    utils::tracing::TraceScope conversion_trace { utils::tracing::TraceStage::CONVERSION, m_image_id };
+
+    // The part of the image copied, centered in the tensor, an odd difference leaves the extra column or row
+    // on the right or at the bottom, of the tensor when padding and of the image when cropping.
+    const uint64_t copied_width { std::min(width, image_width) };
+    const uint64_t copied_height { std::min(height, image_height) };
+    const uint64_t image_x { (image_width - copied_width) / 2 };
+    const uint64_t image_y { (image_height - copied_height) / 2 };
+    const uint64_t tensor_x { (width - copied_width) / 2 };
+    const uint64_t tensor_y { (height - copied_height) / 2 };
+
+    const uint64_t scanline_size { getImageScanlineSize() };
+    const bool wide { m_ihdr.bit_depth == 16 };
+    const uint64_t sample_size { wide ? 2u : 1u };
+    const bool chw { tensor_options.layout == utils::typings::TensorLayout::CHW };
+
+    // HWC is a single plane of pixels with every channel, CHW a plane per channel with one element per pixel.
+    const uint64_t planes_count { chw ? channels : 1u };
+    const uint64_t pixel_elements { chw ? 1u : channels };
+    const uint64_t copied_elements { copied_width * pixel_elements };
+
+    // The samples are normalized to [0, 1] before the caller's scale, so it doesn't depend on the bit depth.
+    std::array<float, 4> scale { tensor_options.scale };
+
+    for (auto& factor : scale) { factor /= wide ? 65535.0f : 255.0f; }
+
+    // Padding is written as is, a float or its 16 bit conversion.
+    std::array<utils::typings::Byte, 2> pad_half {};
+
+    if (not float32)
+    {
+        utils::kernels::convertFloats(&tensor_options.pad_value, pad_half.data(), 1, tensor_options.data_type);
+    }
+
+    const auto pad
+    {
+        [&](uint64_t first_element, uint64_t elements)
+        {
+            utils::typings::Byte* start { dest.data() + first_element * element_size };
+
+            if (float32)
+            {
+                std::fill_n(reinterpret_cast<float*>(start), elements, tensor_options.pad_value);
+            } else
+            {
+                std::fill_n(reinterpret_cast<uint16_t*>(start), elements, std::bit_cast<uint16_t>(pad_half));
+            }
+        }
+    };
+
+    // Rows already holding the channels asked for, in the host's byte order, are converted in place.
+    const bool direct_rows
+    {
+        (m_ihdr.bit_depth == 8 or (wide and m_byte_order == utils::typings::ByteOrder::NATIVE))
+        and ((channels == 4 and m_color_type == utils::typings::RGBA_COLOR_TYPE)
+            or (channels == 3 and m_color_type == utils::typings::RGB_COLOR_TYPE and not m_transparent_color))
+    };
+    // Rows stay in cache from one step to the next: expanded, split into planes (CHW), converted to floats.
+    utils::typings::Bytes samples_row(direct_rows ? 0 : image_width * channels * sample_size);
+    utils::typings::Bytes planes_row(chw ? copied_width * channels * sample_size : 0);
+    std::vector<float> floats_row(float32 ? 0 : copied_elements);
+
+    for (uint64_t row = 0; row < height; ++row)
+    {
+        if (row < tensor_y or row >= tensor_y + copied_height)
+        {
+            for (uint64_t plane = 0; plane < planes_count; ++plane)
+            {
+                pad((plane * height + row) * width * pixel_elements, width * pixel_elements);
+            }
+
+            continue;
+        }
+
+        if (copied_width != width)
+        {
+            for (uint64_t plane = 0; plane < planes_count; ++plane)
+            {
+                const uint64_t row_element { (plane * height + row) * width * pixel_elements };
+
+                pad(row_element, tensor_x * pixel_elements);
+                pad
+                (
+                    row_element + tensor_x * pixel_elements + copied_elements,
+                    (width - copied_width - tensor_x) * pixel_elements
+                );
+            }
+        }
+
+        const utils::typings::Byte* samples { m_defiltered_data.data() + (image_y + row - tensor_y) * scanline_size };
+
+        if (not direct_rows and wide)
+        {
+            expandRow(samples, reinterpret_cast<uint16_t*>(samples_row.data()), channels);
+            samples = samples_row.data();
+        } else if (not direct_rows)
+        {
+            expandRow(samples, samples_row.data(), channels);
+            samples = samples_row.data();
+        }
+
+        samples += image_x * channels * sample_size;
+
+        if (not chw)
+        {
+            utils::typings::Byte* output { dest.data() + (row * width + tensor_x) * channels * element_size };
+            float* floats { float32 ? reinterpret_cast<float*>(output) : floats_row.data() };
+
+            utils::kernels::samplesToFloats(samples, wide, floats, copied_elements, channels, scale, tensor_options.offset);
+
+            if (not float32) { utils::kernels::convertFloats(floats, output, copied_elements, tensor_options.data_type); }
+
+            continue;
+        }
+
+        std::array<utils::typings::Byte*, 4> planes {};
+
+        for (uint8_t channel = 0; channel < channels; ++channel)
+        {
+            planes[channel] = planes_row.data() + channel * copied_width * sample_size;
+        }
+
+        utils::kernels::deinterleaveSamples(samples, sample_size, channels, copied_width, planes);
+
+        for (uint8_t channel = 0; channel < channels; ++channel)
+        {
+            utils::typings::Byte* output { dest.data() + ((channel * height + row) * width + tensor_x) * element_size };
+            float* floats { float32 ? reinterpret_cast<float*>(output) : floats_row.data() };
+
+            utils::kernels::samplesToFloats
+            (
+                planes[channel],
+                wide,
+                floats,
+                copied_width,
+                1,
+                { scale[channel] },
+                { tensor_options.offset[channel] }
+            );
+
+            if (not float32) { utils::kernels::convertFloats(floats, output, copied_width, tensor_options.data_type); }
+        }
+    }
+} // PNGFormat::convertRawDataToTensor
+
+void PNGFormat::convertRawDataIntoPlanes
+(
+    const std::array<utils::typings::MutableBytesView, 4>& planes,
+    uint8_t channels,
+    uint64_t stride
+)
+{
+    if (channels != 3 and channels != 4)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nPlanar data has 3 or 4 channels, not ") + std::to_string(static_cast<uint32_t>(channels))
+            + ".\n"
+        );
+    }
+
+    const uint64_t width { getImageWidth() };
+    const uint64_t height { getImageHeight() };
+    const uint64_t row_size { getImagePlaneRowSize() };
+
+    if (not stride) { stride = row_size; }
+
+    if (stride < row_size)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nStride of ") + std::to_string(stride)
+            + " bytes is smaller than a row of " + std::to_string(row_size) + " bytes.\n"
+        );
+    }
+
+    for (uint8_t channel = 0; channel < channels; ++channel)
+    {
+        const uint64_t size { planes[channel].size() };
+
+        if (height and (size < row_size or (height > 1 and (size - row_size) / (height - 1) < stride)))
+        {
+            throw std::runtime_error
+            (
+                __func__
+                + std::string("\nPlane ") + std::to_string(static_cast<uint32_t>(channel)) + " of "
+                + std::to_string(size) + " bytes is too small for " + std::to_string(height) + " rows of "
+                + std::to_string(row_size) + " bytes, " + std::to_string(stride) + " bytes apart.\n"
+            );
+        }
+    }
+
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to convert.\n"));
+    }
+
+    utils::tracing::TraceScope conversion_trace { utils::tracing::TraceStage::CONVERSION, m_image_id };
+
+    const uint64_t scanline_size { getImageScanlineSize() };
+    const bool wide { m_ihdr.bit_depth == 16 };
+    const uint64_t sample_size { wide ? 2u : 1u };
+
+    // Rows already holding the channels asked for are split as they are, whatever their byte order.
+    const bool direct_rows
+    {
+        m_ihdr.bit_depth >= 8
+        and ((channels == 4 and m_color_type == utils::typings::RGBA_COLOR_TYPE)
+            or (channels == 3 and m_color_type == utils::typings::RGB_COLOR_TYPE and not m_transparent_color))
+    };
+    // Expanded 16 bit samples are in the host's byte order, they're swapped back to the image's before being split.
+    const bool swap_expanded { wide and not direct_rows and m_byte_order != utils::typings::ByteOrder::NATIVE };
+    // Any other row is first expanded here, it's still in cache when it gets split.
+    utils::typings::Bytes samples_row(direct_rows ? 0 : width * channels * sample_size);
+
+    for (uint64_t row = 0; row < height; ++row)
+    {
+        const utils::typings::Byte* samples { m_defiltered_data.data() + row * scanline_size };
+
+        if (not direct_rows and wide)
+        {
+            expandRow(samples, reinterpret_cast<uint16_t*>(samples_row.data()), channels);
+            samples = samples_row.data();
+        } else if (not direct_rows)
+        {
+            expandRow(samples, samples_row.data(), channels);
+            samples = samples_row.data();
+        }
+
+        if (swap_expanded) { utils::kernels::swapBytePairs(samples_row.data(), samples_row.size()); }
+
+        std::array<utils::typings::Byte*, 4> rows {};
+
+        for (uint8_t channel = 0; channel < channels; ++channel)
+        {
+            rows[channel] = planes[channel].data() + row * stride;
+        }
+
+        utils::kernels::deinterleaveSamples(samples, sample_size, channels, width, rows);
+    }
+} // PNGFormat::convertRawDataIntoPlanes
+
+std::vector<utils::AlignedBuffer> PNGFormat::getRawDataPlanes(uint8_t channels, const utils::RowLayout& row_layout)
+{
+    std::vector<utils::AlignedBuffer> planes;
+    std::array<utils::typings::MutableBytesView, 4> views {};
+
+    planes.reserve(channels);
+
+    for (uint8_t channel = 0; channel < channels and channel < views.size(); ++channel)
+    {
+        planes.emplace_back(getImagePlaneRowSize(), getImageHeight(), row_layout);
+        views[channel] = { planes.back().data(), planes.back().size() };
+    }
+
+    // Every plane has the same layout, so the same stride.
+    convertRawDataIntoPlanes(views, channels, planes.empty() ? 0 : planes.front().stride());
+
+    return planes;
+} // PNGFormat::getRawDataPlanes
+
+utils::typings::Bytes PNGFormat::takeRawData()
+{
+    // The buffer comes straight from the upstream, so it only has to stop being accounted before handing it over.
+    m_memory_accounting.releaseBuffer(utils::BufferKind::DEFILTERED, m_defiltered_data.capacity());
+
+    utils::typings::Bytes raw_data { std::move(m_defiltered_data) };
+
+    utils::typings::Bytes(m_defiltered_data.get_allocator()).swap(m_defiltered_data);
+
+    return raw_data;
+} // PNGFormat::takeRawData
+
+void PNGFormat::fillRGBCache()
+{
+    // Fast path, once filled the cache is only read, no lock needed.
+    if (m_rgb_cache_filled.load(std::memory_order_acquire)) { return; }
+
+    const std::lock_guard<std::mutex> lock(m_rgb_cache_mutex);
+
+    // Another thread may have filled it while we waited for the lock.
+    if (m_rgb_cache_filled.load(std::memory_order_relaxed)) { return; }
+
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to convert.\n"));
+    }
+
+    utils::tracing::TraceScope cache_fill_trace { utils::tracing::TraceStage::CACHE_FILL, m_image_id };
+    utils::DecodeStats* decode_stats { decodeStats() };
+
+    {
+        utils::StageTimer conversion_timer { decode_stats ? &decode_stats->rgb_conversion : nullptr };
+        utils::tracing::TraceScope conversion_trace { utils::tracing::TraceStage::CONVERSION, m_image_id };
+
+        if (not isOutOfCore()) { enforceMemoryBudget(getImageRGBScanlinesSize(), "rgb cache"); }
+        convertDataToRGB(m_defiltered_data, m_defiltered_data_rgb);
+    }
+
+    if (decode_stats) { decode_stats->rgb_converted_bytes += m_defiltered_data_rgb.size(); }
+
+    m_rgb_cache_filled.store(true, std::memory_order_release);
+} // PNGFormat::fillRGBCache
+
+void PNGFormat::fillRGBACache()
+{
+    // Fast path, once filled the cache is only read, no lock needed.
+    if (m_rgba_cache_filled.load(std::memory_order_acquire)) { return; }
+
+    const std::lock_guard<std::mutex> lock(m_rgba_cache_mutex);
+
+    // Another thread may have filled it while we waited for the lock.
+    if (m_rgba_cache_filled.load(std::memory_order_relaxed)) { return; }
+
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to convert.\n"));
+    }
+
+    utils::tracing::TraceScope cache_fill_trace { utils::tracing::TraceStage::CACHE_FILL, m_image_id };
+    utils::DecodeStats* decode_stats { decodeStats() };
+
+    {
+        utils::StageTimer conversion_timer { decode_stats ? &decode_stats->rgba_conversion : nullptr };
+        utils::tracing::TraceScope conversion_trace { utils::tracing::TraceStage::CONVERSION, m_image_id };
+
+        if (not isOutOfCore()) { enforceMemoryBudget(getImageRGBAScanlinesSize(), "rgba cache"); }
+        convertDataToRGBA(m_defiltered_data, m_defiltered_data_rgba);
+    }
+
+    if (decode_stats) { decode_stats->rgba_converted_bytes += m_defiltered_data_rgba.size(); }
+
+    m_rgba_cache_filled.store(true, std::memory_order_release);
+} // PNGFormat::fillRGBACache
+
+utils::DecodeStats* PNGFormat::decodeStats() noexcept
+{
+    return m_decode_options.collect_decode_stats ? &m_decode_stats : nullptr;
+} // PNGFormat::decodeStats
+
+uint64_t PNGFormat::enforceDecodeLimits() const
+{
+    const uint64_t width { getImageWidth() };
+    const uint64_t height { getImageHeight() };
+
+    /*!
+     * Sizes are 64 bits wide, but the largest buffer, the rgba cache at up to eight bytes per pixel,
+     * must still be addressable by the vectors holding it (and the product must not wrap around).
+    */
+    if (height and getImageRGBAScanlineSize() + 1 > static_cast<uint64_t>(PTRDIFF_MAX) / height)
+    {
+        throw std::runtime_error
+        (
+            "The file exceeds the reasonable limits of sanity. Please rethink your life choices."
+        );
+    }
+
+    const uint64_t pixels { width * height };
+    const uint64_t scanlines_size { getImageScanlinesSize() };
+    const uint64_t inflated_size { scanlines_size + height };
+
+    // Reduced images are defiltered into two 16 bit rows and only kept at half the size.
+    const uint64_t defiltered_size
+    {
+        reducesTo8Bits() ? scanlines_size / 2 + 2 * getImageScanlineSize() : scanlines_size
+    };
+
+    if (m_decode_options.max_pixels and pixels > m_decode_options.max_pixels)
+    {
+        throw utils::DecodeLimitExceeded
+        (
+            __func__
+            + std::string("\nImage has ") + std::to_string(pixels)
+            + " pixels, the limit is " + std::to_string(m_decode_options.max_pixels) + ".\n"
+        );
+    }
+
+    // The inflated data is only freed after it's defiltered, so both are held at once (in files when out of core).
+    enforceMemoryBudget(isOutOfCore() ? 0 : inflated_size + defiltered_size, "decode");
+
+    return inflated_size;
+} // PNGFormat::enforceDecodeLimits
+
+void PNGFormat::enforceMemoryBudget(uint64_t additional_bytes, const char* what) const
+{
+    if (not m_decode_options.memory_budget_bytes) { return; }
+
+    const utils::MemoryStats memory_stats { m_memory_accounting.getMemoryStats() };
+    uint64_t held_bytes { memory_stats.total.current_bytes };
+
+    // Memory mapped buffers live in files, not on the heap.
+    if (isOutOfCore())
+    {
+        for (const auto buffer_kind : OUT_OF_CORE_BUFFER_KINDS)
+        {
+            held_bytes -= memory_stats.buffers[static_cast<std::size_t>(buffer_kind)].current_bytes;
+        }
+    }
+
+    if (held_bytes + additional_bytes > m_decode_options.memory_budget_bytes)
+    {
+        throw utils::DecodeLimitExceeded
+        (
+            __func__
+            + std::string("\n") + what + " needs " + std::to_string(additional_bytes)
+            + " bytes on top of the " + std::to_string(held_bytes)
+            + " already held, the budget is " + std::to_string(m_decode_options.memory_budget_bytes) + " bytes.\n"
+        );
+    }
+} // PNGFormat::enforceMemoryBudget
+
+bool PNGFormat::isOutOfCore() const noexcept
+{
+    return not m_decode_options.out_of_core_directory.empty();
+} // PNGFormat::isOutOfCore
+
+std::pmr::memory_resource* PNGFormat::defilteredDataResource() const
+{
+    return isOutOfCore() ? utils::mappedFileResource(m_decode_options.out_of_core_directory) : m_memory_accounting.upstream();
+} // PNGFormat::defilteredDataResource
+
+bool PNGFormat::reducesTo8Bits() const noexcept
+{
+    return m_ihdr.bit_depth == 16 and m_decode_options.reduce_to_8_bits;
+} // PNGFormat::reducesTo8Bits
+
+void PNGFormat::detectRowContent
+(
+    const utils::typings::Byte* row,
+    uint8_t bit_depth,
+    utils::kernels::SampleStats& sample_stats,
+    std::array<bool, 256>& used_palette_entries
+) const noexcept
+{
+    const uint32_t width { getImageWidth() };
+
+    if (bit_depth >= 8 and m_color_type != utils::typings::INDEXED_COLOR_TYPE)
+    {
+        utils::kernels::accumulateSampleStats(row, bit_depth / 8, m_number_of_samples, width, sample_stats);
+
+        return;
+    }
+
+    // Indices and gray samples of less than 8 bits are packed from the most significant bits of each byte.
+    const uint32_t mask { (1u << bit_depth) - 1 };
+    uint32_t max_sample { sample_stats.max_sample };
+
+    for (uint32_t column = 0; column < width; ++column)
+    {
+        const uint64_t bit { uint64_t { column } * bit_depth };
+        const uint32_t sample { (std::to_integer<uint32_t>(row[bit / 8]) >> (8 - bit_depth - bit % 8)) & mask };
+
+        if (m_color_type == utils::typings::INDEXED_COLOR_TYPE)
+        {
+            used_palette_entries[sample] = true;
+        } else
+        {
+            max_sample = std::max(max_sample, sample);
+        }
+    }
+
+    sample_stats.max_sample = static_cast<uint16_t>(max_sample);
+} // PNGFormat::detectRowContent
+
+void PNGFormat::finishImageContent
+(
+    const utils::kernels::SampleStats& sample_stats,
+    const std::array<bool, 256>& used_palette_entries
+) noexcept
+{
+    if (m_color_type != utils::typings::INDEXED_COLOR_TYPE)
+    {
+        m_image_content.opaque = sample_stats.opaque and not m_transparent_color;
+        m_image_content.gray = sample_stats.gray;
+        m_image_content.max_sample = sample_stats.max_sample;
+
+        return;
+    }
+
+    utils::kernels::SampleStats palette_stats {};
+
+    for (size_t i = 0; i < used_palette_entries.size(); ++i)
+    {
+        if (not used_palette_entries[i]) { continue; }
+
+        const auto* color { reinterpret_cast<const utils::typings::Byte*>(&m_palette_rgba[i]) };
+
+        utils::kernels::accumulateSampleStats(color, 1, 4, 1, palette_stats);
+    }
+
+    m_image_content.opaque = palette_stats.opaque;
+    m_image_content.gray = palette_stats.gray;
+    m_image_content.max_sample = palette_stats.max_sample;
+} // PNGFormat::finishImageContent
+
+void PNGFormat::reduceChannels()
+{
+    if (m_ihdr.bit_depth < 8 or m_transparent_color) { return; }
+
+    const bool opaque { m_image_content.opaque };
+    const bool gray { m_image_content.gray };
+    utils::typings::ImageColorType color_type { m_color_type };
+
+    if (m_color_type == utils::typings::RGBA_COLOR_TYPE)
+    {
+        color_type = opaque
+            ? (gray ? utils::typings::GRAYSCALE_COLOR_TYPE : utils::typings::RGB_COLOR_TYPE)
+            : (gray ? utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE : utils::typings::RGBA_COLOR_TYPE);
+    } else if (m_color_type == utils::typings::RGB_COLOR_TYPE and gray)
+    {
+        color_type = utils::typings::GRAYSCALE_COLOR_TYPE;
+    } else if (m_color_type == utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE and opaque)
+    {
+        color_type = utils::typings::GRAYSCALE_COLOR_TYPE;
+    }
+
+    if (color_type == m_color_type) { return; }
+
+    const uint8_t samples
+    {
+        static_cast<uint8_t>
+        (
+            (color_type == utils::typings::GRAYSCALE_COLOR_TYPE) ? 1 :
+            (color_type == utils::typings::RGB_COLOR_TYPE)       ? 3 :
+                                                                   2
+        )
+    };
+
+    // Source sample of each one kept, gray is red (all three are equal) and alpha stays last.
+    std::array<uint8_t, 3> kept_samples { 0, 1, 2 };
+
+    if (color_type == utils::typings::GRAYSCALE_AND_ALPHA_COLOR_TYPE) { kept_samples[1] = m_number_of_samples - 1; }
+
+    const size_t sample_size { m_ihdr.bit_depth / 8u };
+    const size_t src_pixel_size { sample_size * m_number_of_samples };
+    const size_t dest_pixel_size { sample_size * samples };
+    const uint64_t pixels { uint64_t { getImageWidth() } * getImageHeight() };
+
+    utils::typings::Bytes reduced_data(pixels * dest_pixel_size, m_defiltered_data.get_allocator());
+
+    m_memory_accounting.recordBuffer(utils::BufferKind::DEFILTERED, reduced_data.capacity());
+
+    const utils::typings::Byte* src { m_defiltered_data.data() };
+    utils::typings::Byte* dest { reduced_data.data() };
+
+    for (uint64_t i = 0; i < pixels; ++i, src += src_pixel_size, dest += dest_pixel_size)
+    {
+        for (uint8_t sample = 0; sample < samples; ++sample)
+        {
+            std::memcpy(dest + sample * sample_size, src + kept_samples[sample] * sample_size, sample_size);
+        }
+    }
+
+    m_memory_accounting.releaseBuffer(utils::BufferKind::DEFILTERED, m_defiltered_data.capacity());
+    m_defiltered_data = std::move(reduced_data);
+    m_color_type = color_type;
+    m_ihdr.color_type =
+        (color_type == utils::typings::GRAYSCALE_COLOR_TYPE) ? 0x0 :
+        (color_type == utils::typings::RGB_COLOR_TYPE)       ? 0x2 :
+                                                               0x4 ;
+    m_number_of_samples = samples;
+    m_number_of_channels = samples;
+} // PNGFormat::reduceChannels
+
+utils::AlignedBuffer PNGFormat::copyRowsAligned
+(
+    utils::typings::BytesView src,
+    uint64_t row_size,
+    const utils::RowLayout& row_layout
+) const
+{
+    const uint32_t height { getImageHeight() };
+    utils::AlignedBuffer aligned_buffer { static_cast<std::size_t>(row_size), height, row_layout };
+
+    if (src.size() < row_size * height)
+    {
+        throw std::out_of_range(std::string("Out of range rows: ") + __func__);
+    }
+
+    // Packed rows are copied at once, padded ones a row at a time.
+    if (aligned_buffer.stride() == row_size)
+    {
+        std::copy_n(src.begin(), aligned_buffer.size(), aligned_buffer.data());
+
+        return aligned_buffer;
+    }
+
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        std::copy_n(src.begin() + row * row_size, row_size, aligned_buffer.row(row).begin());
+    }
+
+    return aligned_buffer;
+} // PNGFormat::copyRowsAligned
+
+utils::AlignedBuffer PNGFormat::convertRowsAligned(uint8_t channels, const utils::RowLayout& row_layout) const
+{
+    if (m_defiltered_data.empty())
+    {
+        throw std::runtime_error(__func__ + std::string("\nThe raw data was taken, nothing to convert.\n"));
+    }
+
+    const uint64_t row_size { (channels == 3) ? getImageRGBScanlineSize() : getImageRGBAScanlineSize() };
+
+    // Already in the channels asked, the rows are copied as they are.
+    if (m_color_type == ((channels == 3) ? utils::typings::RGB_COLOR_TYPE : utils::typings::RGBA_COLOR_TYPE))
+    {
+        return copyRowsAligned(m_defiltered_data, row_size, row_layout);
+    }
+
+    utils::tracing::TraceScope conversion_trace { utils::tracing::TraceStage::CONVERSION, m_image_id };
+
+    const uint32_t height { getImageHeight() };
+    const uint64_t scanline_size { getImageScanlineSize() };
+    utils::AlignedBuffer aligned_buffer { static_cast<std::size_t>(row_size), height, row_layout };
+
+    for (uint32_t row = 0; row < height; ++row)
+    {
+        convertRow(m_defiltered_data.data() + row * scanline_size, aligned_buffer.row(row).data(), channels);
+    }
+
+    return aligned_buffer;
+} // PNGFormat::convertRowsAligned
+
 uint32_t PNGFormat::getImageWidth() const noexcept
 {
     return utils::convertFromNetworkByteOrder(m_ihdr.width);
@@ -719,6 +1859,11 @@ uint32_t PNGFormat::getImageHeight() const noexcept
     return utils::convertFromNetworkByteOrder(m_ihdr.height);
 } // PNGFormat::getImageHeight
 
+utils::typings::ByteOrder PNGFormat::getImageByteOrder() const noexcept
+{
+    return m_byte_order;
+} // PNGFormat::getImageByteOrder
+
 uint8_t PNGFormat::getImageBitDepth() const noexcept
 {
     return m_ihdr.bit_depth;
@@ -734,29 +1879,74 @@ uint8_t PNGFormat::getImageNumberOfChannels() const
     return m_number_of_channels;
 } // PNGFormat::getImageNumberOfChannels
 
+utils::MemoryStats PNGFormat::getMemoryStats() const noexcept
+{
+    return m_memory_accounting.getMemoryStats();
+} // PNGFormat::getMemoryStats
+
+utils::DecodeStats PNGFormat::getDecodeStats() const noexcept
+{
+    // The conversion stats are written while holding the lock of their cache.
+    const std::scoped_lock lock(m_rgb_cache_mutex, m_rgba_cache_mutex);
+
+    return m_decode_stats;
+} // PNGFormat::getDecodeStats
+
+utils::typings::ImageContent PNGFormat::getImageContent() const noexcept
+{
+    return m_image_content;
+} // PNGFormat::getImageContent
+
 void PNGFormat::resetCachedData() noexcept
 {
-    utils::typings::Bytes ().swap(m_defiltered_data_rgb);
+    /*!
+     * Swapping vectors with different memory resources is undefined behavior,
+     * so the empty vectors must use the same memory resource as the caches.
+    */
+    utils::typings::Bytes (m_defiltered_data_rgb.get_allocator()).swap(m_defiltered_data_rgb);
     //m_defiltered_data_rgb.shrink_to_fit();
-    utils::typings::Bytes ().swap(m_defiltered_data_rgba);
+    utils::typings::Bytes (m_defiltered_data_rgba.get_allocator()).swap(m_defiltered_data_rgba);
     //m_defiltered_data_rgba.shrink_to_fit();
+
+    m_rgb_cache_filled.store(false, std::memory_order_relaxed);
+    m_rgba_cache_filled.store(false, std::memory_order_relaxed);
 } // PNGFormat::resetCachedData
 
 void PNGFormat::swapBytesOrder() noexcept
 {
     if (m_ihdr.bit_depth < 16) { return; }
 
-    for (auto it = m_defiltered_data.begin(); it != m_defiltered_data.end(); it += 2)
+    utils::kernels::swapBytePairsParallel(m_defiltered_data.data(), m_defiltered_data.size());
+
+    // Caches already filled were converted in the old order, they're swapped along so every view agrees.
+    if (m_rgb_cache_filled.load(std::memory_order_acquire))
+    {
+        utils::kernels::swapBytePairsParallel(m_defiltered_data_rgb.data(), m_defiltered_data_rgb.size());
+    }
+
+    if (m_rgba_cache_filled.load(std::memory_order_acquire))
     {
-        std::swap(*it, *(it+1));
+        utils::kernels::swapBytePairsParallel(m_defiltered_data_rgba.data(), m_defiltered_data_rgba.size());
     }
+
+    m_byte_order = (m_byte_order == utils::typings::ByteOrder::BIG) ? utils::typings::ByteOrder::LITTLE
+                                                                     : utils::typings::ByteOrder::BIG;
 } // PNGFormat::swapBytesOrder
 
+void PNGFormat::setImageByteOrder(utils::typings::ByteOrder byte_order) noexcept
+{
+    if (m_ihdr.bit_depth < 16 or byte_order == m_byte_order) { return; }
+
+    swapBytesOrder();
+} // PNGFormat::setImageByteOrder
+
 Scanlines::Scanlines
 (
-    uint32_t scanline_size,
-    uint32_t scanlines_size,
-    uint8_t stride
+    uint64_t scanline_size,
+    uint64_t scanlines_size,
+    uint8_t stride,
+    bool swap_byte_pairs,
+    bool reduce_to_8_bits
 )
 {
     /*!
@@ -777,28 +1967,58 @@ Scanlines::Scanlines
     m_stride = stride;
     m_scanline_size = scanline_size;
     m_scanlines_size = scanlines_size;
+    m_swap_byte_pairs = swap_byte_pairs;
+    m_reduce_to_8_bits = reduce_to_8_bits;
 } // Scalines::Scalines
 
-void Scanlines::defilterData(utils::typings::CBytes& filtered_data, utils::typings::Bytes& defiltered_data)
+void Scanlines::defilterData
+(
+    utils::typings::CBytes& filtered_data,
+    utils::typings::Bytes& defiltered_data,
+    utils::DecodeStats* decode_stats,
+    const utils::typings::DecodeOptions* decode_options,
+    const std::function<void(const utils::typings::Byte* row)>& row_visitor
+)
 {
-    // Initialize and resize all the space needed to accommodate all scanlines
-    defiltered_data.resize(m_scanlines_size);
+    utils::StageTimer defilter_timer { decode_stats ? &decode_stats->defilter : nullptr };
+
+    // Resize to all the space needed to accommodate all scanlines, left uninitialized as every row gets written
+    defiltered_data.resize(m_reduce_to_8_bits ? m_scanlines_size / 2 : m_scanlines_size);
+
+    /*!
+     * Reduced rows are defiltered in turns into the two halves of this buffer, the filters still need
+     * the previous row at 16 bit, from there each one is reduced into defiltered_data.
+     * They're scratch space of the filtered data, so they're allocated the same way it is.
+    */
+    utils::typings::Bytes rows_to_reduce
+    (
+        m_reduce_to_8_bits ? 2 * static_cast<uint64_t>(m_scanline_size) : 0,
+        filtered_data.get_allocator()
+    );
+    auto& defiltered_rows { m_reduce_to_8_bits ? rows_to_reduce : defiltered_data };
 
     const auto it = filtered_data.cbegin();
     const auto it_end = filtered_data.cend();
-    const auto it_defiltered = defiltered_data.cbegin();
-    const auto it_defiltered_end = defiltered_data.cend();
+    const auto it_defiltered = defiltered_rows.cbegin();
+    const auto it_defiltered_end = defiltered_rows.cend();
 
     /*!
      * As every scanline starts with an extra byte for the filter type, we must
      * sum the size of a scanline plus the extra byte.
     */
-    for (uint32_t row = 0; row < filtered_data.size(); row += m_scanline_size + 1)
+    for (size_t row = 0; row < filtered_data.size(); row += m_scanline_size + 1)
     {
         const auto extra_filter_bytes_accumulated = (row / (m_scanline_size + 1));
+
+        if (decode_options and extra_filter_bytes_accumulated % ROWS_PER_INTERRUPTION_CHECK == 0)
+        {
+            utils::throwIfInterrupted(*decode_options, __func__);
+        }
         const auto filtered_scanline_begin = filtered_data.begin() + row + 1;
         const auto filtered_scanline_end = filtered_data.begin() + row + m_scanline_size + 1;
-        const auto defiltered_scanline_begin = defiltered_data.begin() + row - extra_filter_bytes_accumulated;
+        const auto defiltered_scanline_begin = m_reduce_to_8_bits
+            ? rows_to_reduce.begin() + (extra_filter_bytes_accumulated % 2) * m_scanline_size
+            : defiltered_data.begin() + row - extra_filter_bytes_accumulated;
 
         if (not utils::isWithinBoundaries(it, it_end, filtered_scanline_begin, filtered_scanline_end)
             or not utils::isWithinBoundaries
@@ -807,14 +2027,28 @@ void Scanlines::defilterData(utils::typings::CBytes& filtered_data, utils::typin
                 it_defiltered_end,
                 static_cast<utils::typings::Bytes::const_iterator>(defiltered_scanline_begin)
             )
+            or (m_reduce_to_8_bits
+                and (extra_filter_bytes_accumulated + 1) * static_cast<uint64_t>(m_scanline_size / 2)
+                    > defiltered_data.size())
         ) { throw std::out_of_range(std::string("Out of range iterators: ") + __func__); }
 
         const auto filter_type = static_cast<uint8_t>(filtered_data[row]);
-        auto previous_defiltered_scanline_begin = defiltered_data.cend();
-        auto previous_defiltered_scanline_end = defiltered_data.cend();
+
+        if (decode_stats and filter_type < decode_stats->filter_type_rows.size())
+        {
+            ++decode_stats->filter_type_rows[filter_type];
+        }
+
+        auto previous_defiltered_scanline_begin = defiltered_rows.cend();
+        auto previous_defiltered_scanline_end = defiltered_rows.cend();
 
         // It means we have a previous scanline
-        if (row > 0)
+        if (row > 0 and m_reduce_to_8_bits)
+        {
+            previous_defiltered_scanline_begin = rows_to_reduce.cbegin()
+                + ((extra_filter_bytes_accumulated + 1) % 2) * m_scanline_size;
+            previous_defiltered_scanline_end = previous_defiltered_scanline_begin + m_scanline_size;
+        } else if (row > 0)
         {
             previous_defiltered_scanline_begin = defiltered_scanline_begin - m_scanline_size;
             previous_defiltered_scanline_end = defiltered_scanline_begin + m_scanline_size;
@@ -1004,7 +2238,55 @@ void Scanlines::defilterData(utils::typings::CBytes& filtered_data, utils::typin
                 throw std::runtime_error("Filter mode is invalid.\n");
                 break;
         };
+
+        // The previous row was just read for the last time by the filters, it's still in cache.
+        if (m_swap_byte_pairs and row > 0)
+        {
+            utils::kernels::swapBytePairs(&*(defiltered_scanline_begin - m_scanline_size), m_scanline_size);
+        }
+
+        if (m_reduce_to_8_bits)
+        {
+            utils::typings::Byte* reduced_row
+            {
+                defiltered_data.data() + extra_filter_bytes_accumulated * (m_scanline_size / 2)
+            };
+
+            utils::kernels::reduce16To8(&*defiltered_scanline_begin, reduced_row, m_scanline_size / 2);
+
+            if (row_visitor) { row_visitor(reduced_row); }
+        } else if (row_visitor)
+        {
+            // Visited before it's swapped, while it's still in cache.
+            row_visitor(&*defiltered_scanline_begin);
+        }
     }
+
+    // Rows missing from a truncated image were never written, they're zeroed instead of left uninitialized.
+    const uint64_t written_size
+    {
+        filtered_data.size() / static_cast<uint64_t>(m_scanline_size + 1)
+        * static_cast<uint64_t>(m_reduce_to_8_bits ? m_scanline_size / 2 : m_scanline_size)
+    };
+
+    if (written_size < defiltered_data.size())
+    {
+        std::fill(defiltered_data.begin() + written_size, defiltered_data.end(), utils::typings::Byte { 0 });
+
+        const uint64_t row_size { static_cast<uint64_t>(m_reduce_to_8_bits ? m_scanline_size / 2 : m_scanline_size) };
+
+        for (uint64_t offset = written_size; row_visitor and offset < defiltered_data.size(); offset += row_size)
+        {
+            row_visitor(defiltered_data.data() + offset);
+        }
+    }
+
+    if (m_swap_byte_pairs and written_size)
+    {
+        utils::kernels::swapBytePairs(defiltered_data.data() + written_size - m_scanline_size, m_scanline_size);
+    }
+
+    if (decode_stats) { decode_stats->defiltered_bytes += defiltered_data.size(); }
 } // Scalines::defilterData
 
 void Scanlines::defilterSubFilter
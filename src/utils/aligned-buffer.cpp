@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include "utils/aligned-buffer.hpp"
+
+namespace utils
+{
+
+AlignedBuffer::AlignedBuffer(std::size_t row_size, std::size_t rows, const RowLayout& row_layout)
+    : m_row_size(row_size), m_rows(rows)
+{
+    if (not std::has_single_bit(row_layout.row_alignment))
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nRow alignment must be a power of two, got ")
+            + std::to_string(row_layout.row_alignment) + ".\n"
+        );
+    }
+
+    const std::size_t alignment_mask { row_layout.row_alignment - 1 };
+
+    if (row_size > SIZE_MAX - row_layout.row_padding - alignment_mask)
+    {
+        throw std::runtime_error(__func__ + std::string("\nRow size too large.\n"));
+    }
+
+    m_stride = (row_size + row_layout.row_padding + alignment_mask) & ~alignment_mask;
+
+    if (rows and m_stride > static_cast<std::size_t>(PTRDIFF_MAX) / rows)
+    {
+        throw std::runtime_error(__func__ + std::string("\nBuffer too large.\n"));
+    }
+
+    const std::size_t size { m_stride * rows };
+    const bool huge_pages { row_layout.huge_pages and size >= HUGE_PAGE_SIZE };
+
+    // Huge pages are only used by the kernel for ranges aligned to them.
+    m_alignment = std::max({ row_layout.row_alignment, CACHE_LINE_SIZE, huge_pages ? HUGE_PAGE_SIZE : 0 });
+
+    if (not size) { return; }
+
+    m_data = static_cast<std::byte*>(::operator new(size, std::align_val_t { m_alignment }));
+
+#ifdef MADV_HUGEPAGE
+    // Only a hint, the buffer works the same when the kernel doesn't honor it.
+    if (huge_pages) { madvise(m_data, size, MADV_HUGEPAGE); }
+#endif
+
+    if (m_stride != m_row_size)
+    {
+        for (std::size_t i = 0; i < rows; ++i)
+        {
+            std::memset(m_data + i * m_stride + m_row_size, 0, m_stride - m_row_size);
+        }
+    }
+} // AlignedBuffer::AlignedBuffer
+
+AlignedBuffer::~AlignedBuffer()
+{
+    release();
+} // AlignedBuffer::~AlignedBuffer
+
+AlignedBuffer::AlignedBuffer(AlignedBuffer&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_row_size(std::exchange(other.m_row_size, 0)),
+      m_stride(std::exchange(other.m_stride, 0)),
+      m_rows(std::exchange(other.m_rows, 0)),
+      m_alignment(std::exchange(other.m_alignment, 0))
+{
+} // AlignedBuffer::AlignedBuffer
+
+AlignedBuffer& AlignedBuffer::operator=(AlignedBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+
+        m_data = std::exchange(other.m_data, nullptr);
+        m_row_size = std::exchange(other.m_row_size, 0);
+        m_stride = std::exchange(other.m_stride, 0);
+        m_rows = std::exchange(other.m_rows, 0);
+        m_alignment = std::exchange(other.m_alignment, 0);
+    }
+
+    return *this;
+} // AlignedBuffer::operator=
+
+void AlignedBuffer::release() noexcept
+{
+    if (m_data) { ::operator delete(m_data, std::align_val_t { m_alignment }); }
+
+    m_data = nullptr;
+} // AlignedBuffer::release
+} // namespace utils
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) or defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "utils/mapped-file-resource.hpp"
+
+namespace utils
+{
+namespace
+{
+#if defined(__unix__) or defined(__APPLE__)
+std::size_t mappingSize(std::size_t bytes) noexcept
+{
+    static const std::size_t page_size { static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) };
+
+    // mmap refuses empty mappings, so even a zero sized allocation takes a page.
+    return std::max<std::size_t>((bytes + page_size - 1) / page_size, 1) * page_size;
+} // mappingSize
+
+int createTemporaryFile(const std::filesystem::path& directory)
+{
+#ifdef O_TMPFILE
+    const int fd { open(directory.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600) };
+
+    // Not every file system supports O_TMPFILE, those fall back to a named file unlinked right away.
+    if (fd != -1 or (errno != EOPNOTSUPP and errno != EISDIR and errno != EINVAL)) { return fd; }
+#endif
+
+    std::string filepath { (directory / "eid-XXXXXX").string() };
+    const int named_fd { mkstemp(filepath.data()) };
+
+    if (named_fd != -1) { unlink(filepath.c_str()); }
+
+    return named_fd;
+} // createTemporaryFile
+#endif
+} // namespace
+
+MappedFileResource::MappedFileResource(std::filesystem::path directory)
+    : m_directory(std::move(directory))
+{
+} // MappedFileResource::MappedFileResource
+
+const std::filesystem::path& MappedFileResource::directory() const noexcept
+{
+    return m_directory;
+} // MappedFileResource::directory
+
+void* MappedFileResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+#if defined(__unix__) or defined(__APPLE__)
+    const std::size_t size { mappingSize(bytes) };
+
+    // Mappings start at a page boundary, which covers any alignment a buffer asks for.
+    if (alignment > size) { throw std::bad_alloc(); }
+
+    const int fd { createTemporaryFile(m_directory) };
+
+    if (fd == -1)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nFailed to create a temporary file in ") + m_directory.string()
+            + ": " + std::strerror(errno) + "\n"
+        );
+    }
+
+    // Growing the file with ftruncate leaves a hole, the disk is only used as pages get written.
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1)
+    {
+        const int error { errno };
+
+        close(fd);
+
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nFailed to grow the temporary file to ") + std::to_string(size)
+            + " bytes: " + std::strerror(error) + "\n"
+        );
+    }
+
+    void* ptr { mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+    const int error { errno };
+
+    // The mapping keeps the file alive, the descriptor isn't needed anymore.
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        throw std::runtime_error
+        (
+            __func__
+            + std::string("\nFailed to map ") + std::to_string(size)
+            + " bytes of the temporary file: " + std::strerror(error) + "\n"
+        );
+    }
+
+    return ptr;
+#else
+    (void)bytes;
+    (void)alignment;
+
+    throw std::runtime_error(__func__ + std::string("\nMemory mapped files aren't supported on this platform.\n"));
+#endif
+} // MappedFileResource::do_allocate
+
+void MappedFileResource::do_deallocate(void* ptr, std::size_t bytes, [[maybe_unused]] std::size_t alignment)
+{
+#if defined(__unix__) or defined(__APPLE__)
+    munmap(ptr, mappingSize(bytes));
+#else
+    (void)ptr;
+    (void)bytes;
+#endif
+} // MappedFileResource::do_deallocate
+
+bool MappedFileResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    // Unmapping doesn't depend on where the file was created, any instance can free any other's memory.
+    return dynamic_cast<const MappedFileResource*>(&other) != nullptr;
+} // MappedFileResource::do_is_equal
+
+std::pmr::memory_resource* mappedFileResource(const std::filesystem::path& directory)
+{
+    static std::mutex mutex;
+    // Leaked on purpose, buffers in static storage may still be freed after it would have been destroyed.
+    static auto* resources { new std::map<std::filesystem::path, std::unique_ptr<MappedFileResource>>() };
+
+    const std::scoped_lock lock { mutex };
+    auto& resource { (*resources)[directory] };
+
+    if (not resource) { resource = std::make_unique<MappedFileResource>(directory); }
+
+    return resource.get();
+} // mappedFileResource
+} // namespace utils
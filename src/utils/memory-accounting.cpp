@@ -0,0 +1,139 @@
+#include "utils/memory-accounting.hpp"
+
+namespace utils
+{
+
+MemoryAccounting::MemoryAccounting(std::pmr::memory_resource* upstream)
+    : m_upstream(upstream)
+{
+    for (std::size_t i = 0; i < NUMBER_OF_BUFFER_KINDS; ++i)
+    {
+        m_resources[i].setup(m_upstream, &m_total, &m_counters[i]);
+    }
+} // MemoryAccounting::MemoryAccounting
+
+std::pmr::memory_resource* MemoryAccounting::resource(BufferKind buffer_kind) noexcept
+{
+    return &m_resources[static_cast<std::size_t>(buffer_kind)];
+} // MemoryAccounting::resource
+
+std::pmr::memory_resource* MemoryAccounting::upstream() const noexcept
+{
+    return m_upstream;
+} // MemoryAccounting::upstream
+
+std::pmr::memory_resource* MemoryAccounting::upstream(BufferKind buffer_kind) const noexcept
+{
+    return m_resources[static_cast<std::size_t>(buffer_kind)].upstream();
+} // MemoryAccounting::upstream
+
+void MemoryAccounting::setUpstream(BufferKind buffer_kind, std::pmr::memory_resource* upstream) noexcept
+{
+    const std::size_t i { static_cast<std::size_t>(buffer_kind) };
+
+    m_resources[i].setup(upstream, &m_total, &m_counters[i]);
+} // MemoryAccounting::setUpstream
+
+MemoryStats MemoryAccounting::getMemoryStats() const noexcept
+{
+    MemoryStats memory_stats {};
+
+    memory_stats.total = m_total.snapshot();
+
+    for (std::size_t i = 0; i < NUMBER_OF_BUFFER_KINDS; ++i)
+    {
+        memory_stats.buffers[i] = m_counters[i].snapshot();
+    }
+
+    return memory_stats;
+} // MemoryAccounting::getMemoryStats
+
+void MemoryAccounting::recordBuffer(BufferKind buffer_kind, std::size_t bytes) noexcept
+{
+    m_total.recordAllocation(bytes);
+    m_counters[static_cast<std::size_t>(buffer_kind)].recordAllocation(bytes);
+} // MemoryAccounting::recordBuffer
+
+void MemoryAccounting::releaseBuffer(BufferKind buffer_kind, std::size_t bytes) noexcept
+{
+    m_total.recordDeallocation(bytes);
+    m_counters[static_cast<std::size_t>(buffer_kind)].recordDeallocation(bytes);
+} // MemoryAccounting::releaseBuffer
+
+void MemoryAccounting::Counters::recordAllocation(std::size_t bytes) noexcept
+{
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+    m_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    const uint64_t current_bytes { m_current_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes };
+    uint64_t peak_bytes { m_peak_bytes.load(std::memory_order_relaxed) };
+
+    /*!
+     * Another thread may raise the peak between the load and the store,
+     * so we only store our value if the peak is still lower than it, retrying otherwise.
+    */
+    while (peak_bytes < current_bytes
+        and not m_peak_bytes.compare_exchange_weak(peak_bytes, current_bytes, std::memory_order_relaxed)) {}
+} // MemoryAccounting::Counters::recordAllocation
+
+void MemoryAccounting::Counters::recordDeallocation(std::size_t bytes) noexcept
+{
+    m_current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+} // MemoryAccounting::Counters::recordDeallocation
+
+BufferMemoryStats MemoryAccounting::Counters::snapshot() const noexcept
+{
+    return BufferMemoryStats
+    {
+        .allocations = m_allocations.load(std::memory_order_relaxed),
+        .allocated_bytes = m_allocated_bytes.load(std::memory_order_relaxed),
+        .current_bytes = m_current_bytes.load(std::memory_order_relaxed),
+        .peak_bytes = m_peak_bytes.load(std::memory_order_relaxed)
+    };
+} // MemoryAccounting::Counters::snapshot
+
+void MemoryAccounting::AccountedResource::setup
+(
+    std::pmr::memory_resource* upstream,
+    Counters* total,
+    Counters* own
+) noexcept
+{
+    m_upstream = upstream;
+    m_total = total;
+    m_own = own;
+} // MemoryAccounting::AccountedResource::setup
+
+std::pmr::memory_resource* MemoryAccounting::AccountedResource::upstream() const noexcept
+{
+    return m_upstream;
+} // MemoryAccounting::AccountedResource::upstream
+
+void* MemoryAccounting::AccountedResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    void* ptr = m_upstream->allocate(bytes, alignment);
+
+    // Only account for it once the upstream didn't throw
+    m_total->recordAllocation(bytes);
+    m_own->recordAllocation(bytes);
+
+    return ptr;
+} // MemoryAccounting::AccountedResource::do_allocate
+
+void MemoryAccounting::AccountedResource::do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+{
+    m_upstream->deallocate(ptr, bytes, alignment);
+
+    m_total->recordDeallocation(bytes);
+    m_own->recordDeallocation(bytes);
+} // MemoryAccounting::AccountedResource::do_deallocate
+
+bool MemoryAccounting::AccountedResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    /*!
+     * Memory allocated from one resource must be given back to the same resource,
+     * otherwise the counters of a buffer would drift, so only the resource itself compares equal.
+    */
+    return this == &other;
+} // MemoryAccounting::AccountedResource::do_is_equal
+} // namespace utils
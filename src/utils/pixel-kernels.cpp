@@ -0,0 +1,1656 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) or defined(__i386__)
+#include <immintrin.h>
+#define EID_X86_KERNELS 1
+#endif
+
+#include "utils/pixel-kernels.hpp"
+
+namespace utils::kernels
+{
+namespace
+{
+void swapBytePairsScalar(std::byte* data, std::size_t size) noexcept
+{
+    for (std::size_t i = 0; i + 1 < size; i += 2)
+    {
+        std::swap(data[i], data[i + 1]);
+    }
+} // swapBytePairsScalar
+
+void reduce16To8Scalar(const std::byte* src, std::byte* dest, std::size_t samples) noexcept
+{
+    for (std::size_t i = 0; i < samples; ++i)
+    {
+        const uint32_t sample { static_cast<uint32_t>(src[2 * i]) << 8 | static_cast<uint32_t>(src[2 * i + 1]) };
+
+        // The same as rounding sample * 255 / 65535 to the nearest integer.
+        dest[i] = static_cast<std::byte>((sample * 255 + 32895) >> 16);
+    }
+} // reduce16To8Scalar
+
+/*!
+ * Swizzle
+ *
+ * How a pixel format is built from rgba.
+ *
+ * order: Rgba channel (0 red to 3 alpha) each byte of a converted pixel comes from.
+ * rgba_shuffle, rgb_shuffle: The same for four pixels at once, as pshufb indices into 4 rgba or 4 rgb pixels,
+ * -1 (zeroed) where rgb pixels have no alpha.
+ * opaque: 0xFF where the bytes are forced to 0xFF (the alpha of rgb pixels, the padding of XRGB), ored in.
+*/
+struct Swizzle
+{
+    std::array<uint8_t, 4> order {};
+    bool premultiply { false };
+    bool force_opaque { false };
+    alignas(16) std::array<int8_t, 16> rgba_shuffle {};
+    alignas(16) std::array<int8_t, 16> rgb_shuffle {};
+    alignas(16) std::array<uint8_t, 16> rgb_opaque {};
+    alignas(16) std::array<uint8_t, 16> rgba_opaque {};
+}; // struct Swizzle
+
+Swizzle makeSwizzle(typings::PixelFormat pixel_format) noexcept
+{
+    using typings::PixelFormat;
+
+    Swizzle swizzle {};
+
+    switch (pixel_format)
+    {
+        case PixelFormat::BGRA:
+        case PixelFormat::BGRA_PREMULTIPLIED:   swizzle.order = { 2, 1, 0, 3 }; break;
+        case PixelFormat::ARGB:
+        case PixelFormat::XRGB:                 swizzle.order = { 3, 0, 1, 2 }; break;
+        default:                                swizzle.order = { 0, 1, 2, 3 }; break;
+    }
+
+    swizzle.premultiply = pixel_format == PixelFormat::RGBA_PREMULTIPLIED or pixel_format == PixelFormat::BGRA_PREMULTIPLIED;
+    swizzle.force_opaque = pixel_format == PixelFormat::XRGB;
+
+    for (uint8_t pixel = 0; pixel < 4; ++pixel)
+    {
+        for (uint8_t byte = 0; byte < 4; ++byte)
+        {
+            const uint8_t channel { swizzle.order[byte] };
+            const uint8_t index { static_cast<uint8_t>(pixel * 4 + byte) };
+            const bool opaque { channel == 3 and swizzle.force_opaque };
+
+            swizzle.rgba_shuffle[index] = static_cast<int8_t>(pixel * 4 + channel);
+            swizzle.rgb_shuffle[index] = (channel == 3) ? int8_t { -1 } : static_cast<int8_t>(pixel * 3 + channel);
+            swizzle.rgb_opaque[index] = (channel == 3) ? 0xFF : 0x00;
+            swizzle.rgba_opaque[index] = opaque ? 0xFF : 0x00;
+        }
+    }
+
+    return swizzle;
+} // makeSwizzle
+
+/*!
+ * multiplyAlpha
+ *
+ * @return: round(color * alpha / 255), exact for every color and alpha.
+*/
+constexpr uint32_t multiplyAlpha(uint32_t color, uint32_t alpha) noexcept
+{
+    const uint32_t t { color * alpha + 128 };
+
+    return (t + (t >> 8)) >> 8;
+} // multiplyAlpha
+
+void rgbaToPixelFormatScalar(const std::byte* src, std::byte* dest, std::size_t pixels, const Swizzle& swizzle) noexcept
+{
+    for (std::size_t i = 0; i < pixels; ++i, src += 4, dest += 4)
+    {
+        std::array<uint32_t, 4> channels
+        {
+            static_cast<uint32_t>(src[0]),
+            static_cast<uint32_t>(src[1]),
+            static_cast<uint32_t>(src[2]),
+            static_cast<uint32_t>(src[3])
+        };
+
+        if (swizzle.premultiply)
+        {
+            for (uint8_t channel = 0; channel < 3; ++channel)
+            {
+                channels[channel] = multiplyAlpha(channels[channel], channels[3]);
+            }
+        }
+
+        if (swizzle.force_opaque) { channels[3] = 0xFF; }
+
+        for (uint8_t byte = 0; byte < 4; ++byte)
+        {
+            dest[byte] = static_cast<std::byte>(channels[swizzle.order[byte]]);
+        }
+    }
+} // rgbaToPixelFormatScalar
+
+void rgbToPixelFormatScalar(const std::byte* src, std::byte* dest, std::size_t pixels, const Swizzle& swizzle) noexcept
+{
+    for (std::size_t i = 0; i < pixels; ++i, src += 3, dest += 4)
+    {
+        for (uint8_t byte = 0; byte < 4; ++byte)
+        {
+            const uint8_t channel { swizzle.order[byte] };
+
+            // Opaque, premultiplying changes nothing.
+            dest[byte] = (channel == 3) ? std::byte { 0xFF } : src[channel];
+        }
+    }
+} // rgbToPixelFormatScalar
+
+/*!
+ * SamplePattern
+ *
+ * The scale and offset of 24 samples in a row, a multiple of 1 to 4 channels and of 8 float lanes,
+ * so vector loops can load the pattern once and reuse it for every 24 samples.
+*/
+struct SamplePattern
+{
+    alignas(32) std::array<float, 24> scale {};
+    alignas(32) std::array<float, 24> offset {};
+}; // struct SamplePattern
+
+SamplePattern makeSamplePattern
+(
+    std::size_t channels,
+    const std::array<float, 4>& scale,
+    const std::array<float, 4>& offset
+) noexcept
+{
+    SamplePattern pattern {};
+
+    for (std::size_t i = 0; i < pattern.scale.size(); ++i)
+    {
+        pattern.scale[i] = scale[i % channels];
+        pattern.offset[i] = offset[i % channels];
+    }
+
+    return pattern;
+} // makeSamplePattern
+
+void samplesToFloatsScalar
+(
+    const std::byte* src,
+    bool wide,
+    float* dest,
+    std::size_t count,
+    const SamplePattern& pattern
+) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        uint16_t sample { static_cast<uint8_t>(src[i]) };
+
+        if (wide) { std::memcpy(&sample, src + 2 * i, sizeof(sample)); }
+
+        dest[i] = static_cast<float>(sample) * pattern.scale[i % 24] + pattern.offset[i % 24];
+    }
+} // samplesToFloatsScalar
+
+/*!
+ * floatToHalf
+ *
+ * @return: The IEEE half precision bits of value, rounded to the nearest even, NaNs stay NaNs.
+*/
+uint16_t floatToHalf(float value) noexcept
+{
+    constexpr uint32_t FLOAT_INFINITY { 255u << 23 };
+    constexpr uint32_t HALF_OVERFLOW { (127u + 16u) << 23 };
+    constexpr uint32_t HALF_NORMAL_MIN { 113u << 23 };
+    constexpr uint32_t SUBNORMAL_MAGIC { ((127u - 15u) + (23u - 10u) + 1u) << 23 };
+
+    uint32_t bits { std::bit_cast<uint32_t>(value) };
+    const uint32_t sign { bits & 0x80000000u };
+    uint32_t half { 0 };
+
+    bits ^= sign;
+
+    if (bits >= HALF_OVERFLOW)
+    {
+        half = (bits > FLOAT_INFINITY) ? 0x7E00u : 0x7C00u;
+    } else if (bits < HALF_NORMAL_MIN)
+    {
+        // Adding the magic number lets the fpu round the subnormal mantissa into the low bits.
+        half = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) + std::bit_cast<float>(SUBNORMAL_MAGIC))
+            - SUBNORMAL_MAGIC;
+    } else
+    {
+        const uint32_t odd_mantissa { (bits >> 13) & 1u };
+
+        bits += ((15u - 127u) << 23) + 0xFFFu + odd_mantissa;
+        half = bits >> 13;
+    }
+
+    return static_cast<uint16_t>(half | (sign >> 16));
+} // floatToHalf
+
+/*!
+ * floatToBFloat16
+ *
+ * @return: The upper 16 bits of value, rounded to the nearest even, NaNs stay NaNs.
+*/
+uint16_t floatToBFloat16(float value) noexcept
+{
+    const uint32_t bits { std::bit_cast<uint32_t>(value) };
+
+    if ((bits & 0x7FFFFFFFu) > 0x7F800000u) { return static_cast<uint16_t>((bits >> 16) | 0x40u); }
+
+    return static_cast<uint16_t>((bits + 0x7FFFu + ((bits >> 16) & 1u)) >> 16);
+} // floatToBFloat16
+
+void floatsToHalfsScalar(const float* src, std::byte* dest, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const uint16_t half { floatToHalf(src[i]) };
+
+        std::memcpy(dest + 2 * i, &half, sizeof(half));
+    }
+} // floatsToHalfsScalar
+
+void floatsToBFloat16sScalar(const float* src, std::byte* dest, std::size_t count) noexcept
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const uint16_t bfloat16 { floatToBFloat16(src[i]) };
+
+        std::memcpy(dest + 2 * i, &bfloat16, sizeof(bfloat16));
+    }
+} // floatsToBFloat16sScalar
+
+void deinterleaveSamplesScalar
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+    const std::size_t pixel_size { sample_size * channels };
+
+    if (channels == 1)
+    {
+        std::memcpy(planes[0], src, pixels * pixel_size);
+
+        return;
+    }
+
+    for (std::size_t channel = 0; channel < channels; ++channel)
+    {
+        const std::byte* sample { src + channel * sample_size };
+        std::byte* plane { planes[channel] };
+
+        for (std::size_t i = 0; i < pixels; ++i, sample += pixel_size, plane += sample_size)
+        {
+            std::memcpy(plane, sample, sample_size);
+        }
+    }
+} // deinterleaveSamplesScalar
+
+template<std::size_t BIT_DEPTH, std::size_t CHANNELS>
+void expandIndices
+(
+    const std::byte* src,
+    std::size_t pixels,
+    const std::array<uint32_t, 256>& palette,
+    std::byte* dest
+) noexcept
+{
+    constexpr std::size_t INDICES_PER_BYTE { 8 / BIT_DEPTH };
+    constexpr uint32_t MASK { (1u << BIT_DEPTH) - 1 };
+
+    const auto expand = [&palette, &dest](uint32_t byte, std::size_t index)
+    {
+        std::memcpy(dest, &palette[(byte >> (8 - BIT_DEPTH * (index + 1))) & MASK], CHANNELS);
+        dest += CHANNELS;
+    };
+
+    std::size_t i { 0 };
+
+    // Every index of a whole byte at once, the loop over them unrolls.
+    for (; i + INDICES_PER_BYTE <= pixels; i += INDICES_PER_BYTE, ++src)
+    {
+        const uint32_t byte { std::to_integer<uint32_t>(*src) };
+
+        for (std::size_t index = 0; index < INDICES_PER_BYTE; ++index) { expand(byte, index); }
+    }
+
+    // The last byte of a row may hold less indices, its low bits are padding.
+    for (std::size_t index = 0; i < pixels; ++i, ++index) { expand(std::to_integer<uint32_t>(*src), index); }
+} // expandIndices
+
+void expandPaletteIndicesScalar
+(
+    const std::byte* src,
+    std::size_t bit_depth,
+    std::size_t pixels,
+    const std::array<uint32_t, 256>& palette,
+    std::byte* dest,
+    std::size_t channels
+) noexcept
+{
+    using ExpandPaletteIndices = void (*)
+    (
+        const std::byte* src,
+        std::size_t pixels,
+        const std::array<uint32_t, 256>& palette,
+        std::byte* dest
+    ) noexcept;
+
+    // Indexed by [log2(bit_depth)][channels - 3].
+    static constexpr ExpandPaletteIndices EXPAND_PALETTE_INDICES[4][2]
+    {
+        { &expandIndices<1, 3>, &expandIndices<1, 4> },
+        { &expandIndices<2, 3>, &expandIndices<2, 4> },
+        { &expandIndices<4, 3>, &expandIndices<4, 4> },
+        { &expandIndices<8, 3>, &expandIndices<8, 4> }
+    };
+
+    if (not std::has_single_bit(bit_depth) or bit_depth > 8 or channels < 3 or channels > 4) { return; }
+
+    EXPAND_PALETTE_INDICES[std::countr_zero(bit_depth)][channels - 3](src, pixels, palette, dest);
+} // expandPaletteIndicesScalar
+
+void accumulateSampleStatsScalar
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    SampleStats& stats
+) noexcept
+{
+    const bool has_alpha { channels == 2 or channels == 4 };
+    const std::size_t colors { has_alpha ? channels - 1 : channels };
+    const uint32_t opaque_alpha { sample_size == 2 ? 0xFFFFu : 0xFFu };
+    const std::size_t pixel_size { sample_size * channels };
+
+    const auto sample = [sample_size](const std::byte* data)
+    {
+        return sample_size == 2
+            ? (std::to_integer<uint32_t>(data[0]) << 8) | std::to_integer<uint32_t>(data[1])
+            : std::to_integer<uint32_t>(data[0]);
+    };
+
+    bool opaque { stats.opaque };
+    bool gray { stats.gray };
+    uint32_t max_sample { stats.max_sample };
+
+    for (std::size_t i = 0; i < pixels; ++i, src += pixel_size)
+    {
+        const uint32_t first { sample(src) };
+
+        max_sample = std::max(max_sample, first);
+
+        if (colors == 3)
+        {
+            const uint32_t second { sample(src + sample_size) };
+            const uint32_t third { sample(src + 2 * sample_size) };
+
+            max_sample = std::max({ max_sample, second, third });
+            gray = gray and first == second and second == third;
+        }
+
+        if (has_alpha) { opaque = opaque and sample(src + colors * sample_size) == opaque_alpha; }
+    }
+
+    stats.opaque = opaque;
+    stats.gray = gray;
+    stats.max_sample = static_cast<uint16_t>(max_sample);
+} // accumulateSampleStatsScalar
+
+#ifdef EID_X86_KERNELS
+__attribute__((target("ssse3")))
+void swapBytePairsSSSE3(std::byte* data, std::size_t size) noexcept
+{
+    const __m128i shuffle { _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) };
+    std::size_t i { 0 };
+
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i* block { reinterpret_cast<__m128i*>(data + i) };
+
+        _mm_storeu_si128(block, _mm_shuffle_epi8(_mm_loadu_si128(block), shuffle));
+    }
+
+    swapBytePairsScalar(data + i, size - i);
+} // swapBytePairsSSSE3
+
+__attribute__((target("avx2")))
+void swapBytePairsAVX2(std::byte* data, std::size_t size) noexcept
+{
+    const __m256i shuffle
+    {
+        _mm256_setr_epi8
+        (
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+        )
+    };
+    std::size_t i { 0 };
+
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i* block { reinterpret_cast<__m256i*>(data + i) };
+
+        _mm256_storeu_si256(block, _mm256_shuffle_epi8(_mm256_loadu_si256(block), shuffle));
+    }
+
+    swapBytePairsSSSE3(data + i, size - i);
+} // swapBytePairsAVX2
+
+/*!
+ * round(v / 257) computed in 16 bit lanes as (t - (t >> 8)) >> 8 with t = v + 128, saturating t at 65535
+ * gives the same results, the samples it saturates round to 255 either way.
+*/
+__attribute__((target("ssse3")))
+__m128i reduce16To8Lanes(__m128i big_endian_samples) noexcept
+{
+    const __m128i shuffle { _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) };
+    const __m128i t { _mm_adds_epu16(_mm_shuffle_epi8(big_endian_samples, shuffle), _mm_set1_epi16(128)) };
+
+    return _mm_srli_epi16(_mm_sub_epi16(t, _mm_srli_epi16(t, 8)), 8);
+} // reduce16To8Lanes
+
+__attribute__((target("ssse3")))
+void reduce16To8SSSE3(const std::byte* src, std::byte* dest, std::size_t samples) noexcept
+{
+    std::size_t i { 0 };
+
+    for (; i + 16 <= samples; i += 16)
+    {
+        const __m128i low { reduce16To8Lanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i))) };
+        const __m128i high { reduce16To8Lanes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i + 16))) };
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(low, high));
+    }
+
+    reduce16To8Scalar(src + 2 * i, dest + i, samples - i);
+} // reduce16To8SSSE3
+
+__attribute__((target("avx2")))
+__m256i reduce16To8Lanes(__m256i big_endian_samples) noexcept
+{
+    const __m256i shuffle
+    {
+        _mm256_setr_epi8
+        (
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+        )
+    };
+    const __m256i t { _mm256_adds_epu16(_mm256_shuffle_epi8(big_endian_samples, shuffle), _mm256_set1_epi16(128)) };
+
+    return _mm256_srli_epi16(_mm256_sub_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+} // reduce16To8Lanes
+
+__attribute__((target("avx2")))
+void reduce16To8AVX2(const std::byte* src, std::byte* dest, std::size_t samples) noexcept
+{
+    std::size_t i { 0 };
+
+    for (; i + 32 <= samples; i += 32)
+    {
+        const __m256i low { reduce16To8Lanes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i))) };
+        const __m256i high { reduce16To8Lanes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i + 32))) };
+
+        // packus works within each 128 bit half, the permute puts the four quarters back in order.
+        _mm256_storeu_si256
+        (
+            reinterpret_cast<__m256i*>(dest + i),
+            _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8)
+        );
+    }
+
+    reduce16To8SSSE3(src + 2 * i, dest + i, samples - i);
+} // reduce16To8AVX2
+
+/*!
+ * Premultiplies two rgba pixels widened to 16 bit lanes, multiplying the alpha by 255 leaves it as is.
+*/
+__attribute__((target("ssse3")))
+__m128i multiplyAlphaLanes(__m128i pixels) noexcept
+{
+    const __m128i broadcast_alpha { _mm_setr_epi8(6, -1, 6, -1, 6, -1, -1, -1, 14, -1, 14, -1, 14, -1, -1, -1) };
+    const __m128i alpha_of_alpha { _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255) };
+    const __m128i alphas { _mm_or_si128(_mm_shuffle_epi8(pixels, broadcast_alpha), alpha_of_alpha) };
+    const __m128i t { _mm_add_epi16(_mm_mullo_epi16(pixels, alphas), _mm_set1_epi16(128)) };
+
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+} // multiplyAlphaLanes
+
+__attribute__((target("ssse3")))
+void rgbaToPixelFormatSSSE3(const std::byte* src, std::byte* dest, std::size_t pixels, const Swizzle& swizzle) noexcept
+{
+    const __m128i shuffle { _mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgba_shuffle.data())) };
+    const __m128i opaque { _mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgba_opaque.data())) };
+    const __m128i zero { _mm_setzero_si128() };
+    std::size_t i { 0 };
+
+    for (; i + 4 <= pixels; i += 4)
+    {
+        __m128i block { _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i)) };
+
+        if (swizzle.premultiply)
+        {
+            block = _mm_packus_epi16
+            (
+                multiplyAlphaLanes(_mm_unpacklo_epi8(block, zero)),
+                multiplyAlphaLanes(_mm_unpackhi_epi8(block, zero))
+            );
+        }
+
+        block = _mm_or_si128(_mm_shuffle_epi8(block, shuffle), opaque);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4 * i), block);
+    }
+
+    rgbaToPixelFormatScalar(src + 4 * i, dest + 4 * i, pixels - i, swizzle);
+} // rgbaToPixelFormatSSSE3
+
+__attribute__((target("avx2")))
+__m256i multiplyAlphaLanes(__m256i pixels) noexcept
+{
+    const __m256i broadcast_alpha
+    {
+        _mm256_setr_epi8
+        (
+            6, -1, 6, -1, 6, -1, -1, -1, 14, -1, 14, -1, 14, -1, -1, -1,
+            6, -1, 6, -1, 6, -1, -1, -1, 14, -1, 14, -1, 14, -1, -1, -1
+        )
+    };
+    const __m256i alpha_of_alpha { _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255) };
+    const __m256i alphas { _mm256_or_si256(_mm256_shuffle_epi8(pixels, broadcast_alpha), alpha_of_alpha) };
+    const __m256i t { _mm256_add_epi16(_mm256_mullo_epi16(pixels, alphas), _mm256_set1_epi16(128)) };
+
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+} // multiplyAlphaLanes
+
+__attribute__((target("avx2")))
+void rgbaToPixelFormatAVX2(const std::byte* src, std::byte* dest, std::size_t pixels, const Swizzle& swizzle) noexcept
+{
+    // Unpacking, packing and shuffling all stay within each 128 bit half, the pixels never change halves.
+    const __m256i shuffle
+    {
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgba_shuffle.data())))
+    };
+    const __m256i opaque
+    {
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgba_opaque.data())))
+    };
+    const __m256i zero { _mm256_setzero_si256() };
+    std::size_t i { 0 };
+
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m256i block { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i)) };
+
+        if (swizzle.premultiply)
+        {
+            block = _mm256_packus_epi16
+            (
+                multiplyAlphaLanes(_mm256_unpacklo_epi8(block, zero)),
+                multiplyAlphaLanes(_mm256_unpackhi_epi8(block, zero))
+            );
+        }
+
+        block = _mm256_or_si256(_mm256_shuffle_epi8(block, shuffle), opaque);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 4 * i), block);
+    }
+
+    rgbaToPixelFormatSSSE3(src + 4 * i, dest + 4 * i, pixels - i, swizzle);
+} // rgbaToPixelFormatAVX2
+
+__attribute__((target("ssse3")))
+void rgbToPixelFormatSSSE3(const std::byte* src, std::byte* dest, std::size_t pixels, const Swizzle& swizzle) noexcept
+{
+    const __m128i shuffle { _mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgb_shuffle.data())) };
+    const __m128i opaque { _mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgb_opaque.data())) };
+    std::size_t i { 0 };
+
+    // Four pixels are 12 bytes, but 16 are loaded, so the last pixels are left to the scalar loop.
+    for (; i + 6 <= pixels; i += 4)
+    {
+        const __m128i block { _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i)) };
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4 * i), _mm_or_si128(_mm_shuffle_epi8(block, shuffle), opaque));
+    }
+
+    rgbToPixelFormatScalar(src + 3 * i, dest + 4 * i, pixels - i, swizzle);
+} // rgbToPixelFormatSSSE3
+
+__attribute__((target("avx2")))
+void rgbToPixelFormatAVX2(const std::byte* src, std::byte* dest, std::size_t pixels, const Swizzle& swizzle) noexcept
+{
+    const __m256i shuffle
+    {
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgb_shuffle.data())))
+    };
+    const __m256i opaque
+    {
+        _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(swizzle.rgb_opaque.data())))
+    };
+    std::size_t i { 0 };
+
+    // Each half gets four pixels of its own, pshufb can't move bytes across halves.
+    for (; i + 10 <= pixels; i += 8)
+    {
+        const __m256i block
+        {
+            _mm256_inserti128_si256
+            (
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i + 12)),
+                1
+            )
+        };
+
+        _mm256_storeu_si256
+        (
+            reinterpret_cast<__m256i*>(dest + 4 * i),
+            _mm256_or_si256(_mm256_shuffle_epi8(block, shuffle), opaque)
+        );
+    }
+
+    rgbToPixelFormatSSSE3(src + 3 * i, dest + 4 * i, pixels - i, swizzle);
+} // rgbToPixelFormatAVX2
+
+/*!
+ * The multiply and add are kept apart (no fma), so every version gives the exact same floats.
+*/
+__attribute__((target("avx2")))
+void samplesToFloatsAVX2
+(
+    const std::byte* src,
+    bool wide,
+    float* dest,
+    std::size_t count,
+    const SamplePattern& pattern
+) noexcept
+{
+    const __m256 scale[3]
+    {
+        _mm256_load_ps(pattern.scale.data()),
+        _mm256_load_ps(pattern.scale.data() + 8),
+        _mm256_load_ps(pattern.scale.data() + 16)
+    };
+    const __m256 offset[3]
+    {
+        _mm256_load_ps(pattern.offset.data()),
+        _mm256_load_ps(pattern.offset.data() + 8),
+        _mm256_load_ps(pattern.offset.data() + 16)
+    };
+    std::size_t i { 0 };
+
+    for (; i + 24 <= count; i += 24)
+    {
+        for (std::size_t part = 0; part < 3; ++part)
+        {
+            const std::size_t index { i + part * 8 };
+            const __m256i samples
+            {
+                wide
+                ? _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * index)))
+                : _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + index)))
+            };
+
+            _mm256_storeu_ps
+            (
+                dest + index,
+                _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(samples), scale[part]), offset[part])
+            );
+        }
+    }
+
+    // 24 is a multiple of the channels, the scalar loop picks the pattern up from its start.
+    samplesToFloatsScalar(src + (wide ? 2 * i : i), wide, dest + i, count - i, pattern);
+} // samplesToFloatsAVX2
+
+__attribute__((target("avx2,f16c")))
+void floatsToHalfsF16C(const float* src, std::byte* dest, std::size_t count) noexcept
+{
+    std::size_t i { 0 };
+
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm_storeu_si128
+        (
+            reinterpret_cast<__m128i*>(dest + 2 * i),
+            _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT)
+        );
+    }
+
+    floatsToHalfsScalar(src + i, dest + 2 * i, count - i);
+} // floatsToHalfsF16C
+
+__attribute__((target("avx2")))
+void floatsToBFloat16sAVX2(const float* src, std::byte* dest, std::size_t count) noexcept
+{
+    const __m256i rounding { _mm256_set1_epi32(0x7FFF) };
+    const __m256i one { _mm256_set1_epi32(1) };
+    const __m256i quiet { _mm256_set1_epi32(0x400000) };
+    std::size_t i { 0 };
+
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i halves[2] {};
+
+        for (std::size_t part = 0; part < 2; ++part)
+        {
+            const __m256 floats { _mm256_loadu_ps(src + i + part * 8) };
+            const __m256i bits { _mm256_castps_si256(floats) };
+            const __m256i odd { _mm256_and_si256(_mm256_srli_epi32(bits, 16), one) };
+            const __m256i rounded { _mm256_add_epi32(_mm256_add_epi32(bits, rounding), odd) };
+            // NaNs aren't rounded (it could carry them into infinity), they're made quiet instead.
+            const __m256i nan { _mm256_castps_si256(_mm256_cmp_ps(floats, floats, _CMP_UNORD_Q)) };
+
+            halves[part] = _mm256_srli_epi32(_mm256_blendv_epi8(rounded, _mm256_or_si256(bits, quiet), nan), 16);
+        }
+
+        // packus works within each 128 bit half, the permute puts the four quarters back in order.
+        _mm256_storeu_si256
+        (
+            reinterpret_cast<__m256i*>(dest + 2 * i),
+            _mm256_permute4x64_epi64(_mm256_packus_epi32(halves[0], halves[1]), 0xD8)
+        );
+    }
+
+    floatsToBFloat16sScalar(src + i, dest + 2 * i, count - i);
+} // floatsToBFloat16sAVX2
+
+using DeinterleaveKernel = void (*)
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept;
+
+/*!
+ * deinterleaveRemainingSamples
+ *
+ * Splits with kernel the pixels left once the first done of them were split by a wider vector loop.
+*/
+void deinterleaveRemainingSamples
+(
+    DeinterleaveKernel kernel,
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes,
+    std::size_t done
+) noexcept
+{
+    std::array<std::byte*, 4> remaining_planes {};
+
+    for (std::size_t channel = 0; channel < channels; ++channel)
+    {
+        remaining_planes[channel] = planes[channel] + done * sample_size;
+    }
+
+    kernel(src + done * channels * sample_size, sample_size, channels, pixels - done, remaining_planes);
+} // deinterleaveRemainingSamples
+
+/*!
+ * DeinterleaveMasks
+ *
+ * Shuffles splitting 16 * CHANNELS bytes of interleaved samples, read 16 bytes at a time, into 16 bytes per plane.
+ * masks[channel][part] moves the bytes of that channel found in the part-th 16 bytes to their place in the plane
+ * and zeroes every other place (-128), so or-ing the shuffles of every part gives the whole plane.
+*/
+template<std::size_t CHANNELS>
+using DeinterleaveMasks = std::array<std::array<std::array<int8_t, 16>, CHANNELS>, CHANNELS>;
+
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+constexpr DeinterleaveMasks<CHANNELS> makeDeinterleaveMasks() noexcept
+{
+    DeinterleaveMasks<CHANNELS> masks {};
+
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel)
+    {
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            for (std::size_t i = 0; i < 16; ++i)
+            {
+                // Byte i of the plane is byte i % SAMPLE_SIZE of the sample of pixel i / SAMPLE_SIZE.
+                const std::size_t source { (i / SAMPLE_SIZE * CHANNELS + channel) * SAMPLE_SIZE + i % SAMPLE_SIZE };
+
+                masks[channel][part][i] = (source / 16 == part) ? static_cast<int8_t>(source % 16) : int8_t { -128 };
+            }
+        }
+    }
+
+    return masks;
+} // makeDeinterleaveMasks
+
+/*!
+ * DeinterleaveBlocks
+ *
+ * Vector loop splitting as many whole blocks of pixels as there are, the rest is left to a narrower kernel.
+ *
+ * @return: Number of pixels split.
+*/
+using DeinterleaveBlocks = std::size_t (*)
+(
+    const std::byte* src,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept;
+
+/*!
+ * deinterleaveBlocks
+ *
+ * @param blocks: Instances of a vector loop, indexed by [sample_size - 1][channels - 2].
+ * @return: Number of pixels split, 0 for sample sizes and channels without a vector loop.
+*/
+std::size_t deinterleaveBlocks
+(
+    const DeinterleaveBlocks (&blocks)[2][3],
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+    if (sample_size < 1 or sample_size > 2 or channels < 2 or channels > 4) { return 0; }
+
+    return blocks[sample_size - 1][channels - 2](src, pixels, planes);
+} // deinterleaveBlocks
+
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+__attribute__((target("ssse3")))
+std::size_t deinterleaveBlocksSSSE3
+(
+    const std::byte* src,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+    static constexpr auto MASKS { makeDeinterleaveMasks<SAMPLE_SIZE, CHANNELS>() };
+    constexpr std::size_t BLOCK_PIXELS { 16 / SAMPLE_SIZE };
+    __m128i masks[CHANNELS][CHANNELS];
+
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel)
+    {
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            masks[channel][part] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(MASKS[channel][part].data()));
+        }
+    }
+
+    std::size_t i { 0 };
+
+    for (; i + BLOCK_PIXELS <= pixels; i += BLOCK_PIXELS)
+    {
+        const std::byte* block { src + i * CHANNELS * SAMPLE_SIZE };
+        __m128i parts[CHANNELS];
+
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            parts[part] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * part));
+        }
+
+        for (std::size_t channel = 0; channel < CHANNELS; ++channel)
+        {
+            __m128i plane { _mm_shuffle_epi8(parts[0], masks[channel][0]) };
+
+            for (std::size_t part = 1; part < CHANNELS; ++part)
+            {
+                plane = _mm_or_si128(plane, _mm_shuffle_epi8(parts[part], masks[channel][part]));
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[channel] + i * SAMPLE_SIZE), plane);
+        }
+    }
+
+    return i;
+} // deinterleaveBlocksSSSE3
+
+constexpr DeinterleaveBlocks DEINTERLEAVE_BLOCKS_SSSE3[2][3]
+{
+    { &deinterleaveBlocksSSSE3<1, 2>, &deinterleaveBlocksSSSE3<1, 3>, &deinterleaveBlocksSSSE3<1, 4> },
+    { &deinterleaveBlocksSSSE3<2, 2>, &deinterleaveBlocksSSSE3<2, 3>, &deinterleaveBlocksSSSE3<2, 4> }
+};
+
+void deinterleaveSamplesSSSE3
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+    const std::size_t done { deinterleaveBlocks(DEINTERLEAVE_BLOCKS_SSSE3, src, sample_size, channels, pixels, planes) };
+
+    deinterleaveRemainingSamples(&deinterleaveSamplesScalar, src, sample_size, channels, pixels, planes, done);
+} // deinterleaveSamplesSSSE3
+
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+__attribute__((target("avx2")))
+std::size_t deinterleaveBlocksAVX2
+(
+    const std::byte* src,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+    static constexpr auto MASKS { makeDeinterleaveMasks<SAMPLE_SIZE, CHANNELS>() };
+    constexpr std::size_t BLOCK_PIXELS { 32 / SAMPLE_SIZE };
+    __m256i masks[CHANNELS][CHANNELS];
+
+    for (std::size_t channel = 0; channel < CHANNELS; ++channel)
+    {
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            masks[channel][part] = _mm256_broadcastsi128_si256
+            (
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(MASKS[channel][part].data()))
+            );
+        }
+    }
+
+    std::size_t i { 0 };
+
+    for (; i + BLOCK_PIXELS <= pixels; i += BLOCK_PIXELS)
+    {
+        const std::byte* block { src + i * CHANNELS * SAMPLE_SIZE };
+        __m256i parts[CHANNELS];
+
+        // Shuffles don't cross 128 bit halves, so the low half splits the first 16 * CHANNELS bytes
+        // and the high half the next ones, the two halves of each plane end up in order.
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            parts[part] = _mm256_inserti128_si256
+            (
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * part))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * (CHANNELS + part))),
+                1
+            );
+        }
+
+        for (std::size_t channel = 0; channel < CHANNELS; ++channel)
+        {
+            __m256i plane { _mm256_shuffle_epi8(parts[0], masks[channel][0]) };
+
+            for (std::size_t part = 1; part < CHANNELS; ++part)
+            {
+                plane = _mm256_or_si256(plane, _mm256_shuffle_epi8(parts[part], masks[channel][part]));
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(planes[channel] + i * SAMPLE_SIZE), plane);
+        }
+    }
+
+    return i;
+} // deinterleaveBlocksAVX2
+
+constexpr DeinterleaveBlocks DEINTERLEAVE_BLOCKS_AVX2[2][3]
+{
+    { &deinterleaveBlocksAVX2<1, 2>, &deinterleaveBlocksAVX2<1, 3>, &deinterleaveBlocksAVX2<1, 4> },
+    { &deinterleaveBlocksAVX2<2, 2>, &deinterleaveBlocksAVX2<2, 3>, &deinterleaveBlocksAVX2<2, 4> }
+};
+
+void deinterleaveSamplesAVX2
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+    const std::size_t done { deinterleaveBlocks(DEINTERLEAVE_BLOCKS_AVX2, src, sample_size, channels, pixels, planes) };
+
+    deinterleaveRemainingSamples(&deinterleaveSamplesSSSE3, src, sample_size, channels, pixels, planes, done);
+} // deinterleaveSamplesAVX2
+
+__attribute__((target("avx2")))
+void expandPaletteIndicesAVX2
+(
+    const std::byte* src,
+    std::size_t bit_depth,
+    std::size_t pixels,
+    const std::array<uint32_t, 256>& palette,
+    std::byte* dest,
+    std::size_t channels
+) noexcept
+{
+    // Gathers need a whole byte per index, narrower ones are unpacked a byte at a time instead.
+    if (bit_depth != 8)
+    {
+        expandPaletteIndicesScalar(src, bit_depth, pixels, palette, dest, channels);
+
+        return;
+    }
+
+    const int* colors { reinterpret_cast<const int*>(palette.data()) };
+    // Drops the alpha byte of each color, the four bytes left at the end of each half are zeroed.
+    const __m256i drop_alpha
+    {
+        _mm256_setr_epi8
+        (
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128,
+            0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128
+        )
+    };
+    std::size_t i { 0 };
+
+    if (channels == 4)
+    {
+        for (; i + 8 <= pixels; i += 8)
+        {
+            const __m256i indices { _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))) };
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 4 * i), _mm256_i32gather_epi32(colors, indices, 4));
+        }
+    } else if (channels == 3)
+    {
+        // Each half is stored as 16 bytes but only holds 12, the 4 past them are written over by the next pixels,
+        // so the loop stops while two more pixels are left.
+        for (; i + 10 <= pixels; i += 8)
+        {
+            const __m256i indices { _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))) };
+            const __m256i rgb { _mm256_shuffle_epi8(_mm256_i32gather_epi32(colors, indices, 4), drop_alpha) };
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 3 * i), _mm256_castsi256_si128(rgb));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 3 * i + 12), _mm256_extracti128_si256(rgb, 1));
+        }
+    }
+
+    expandPaletteIndicesScalar(src + i, bit_depth, pixels - i, palette, dest + channels * i, channels);
+} // expandPaletteIndicesAVX2
+
+/*!
+ * SampleStatsMasks
+ *
+ * Byte masks over the 16 * CHANNELS bytes of a block of pixels, read 16 bytes at a time, 0xFF where they apply.
+ *
+ * colors[part]: Bytes of red, green, blue or gray samples, every byte but the alpha ones.
+ * neighbors[part]: Bytes of red and green samples, each one is compared with the same byte of the next sample.
+*/
+template<std::size_t CHANNELS>
+struct SampleStatsMasks
+{
+    std::array<std::array<int8_t, 16>, CHANNELS> colors {};
+    std::array<std::array<int8_t, 16>, CHANNELS> neighbors {};
+}; // struct SampleStatsMasks
+
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+constexpr SampleStatsMasks<CHANNELS> makeSampleStatsMasks() noexcept
+{
+    SampleStatsMasks<CHANNELS> masks {};
+
+    for (std::size_t part = 0; part < CHANNELS; ++part)
+    {
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            const std::size_t channel { (part * 16 + i) / SAMPLE_SIZE % CHANNELS };
+            const bool is_alpha { (CHANNELS == 2 or CHANNELS == 4) and channel == CHANNELS - 1 };
+
+            masks.colors[part][i] = is_alpha ? int8_t { 0 } : int8_t { -1 };
+            masks.neighbors[part][i] = (CHANNELS >= 3 and channel < 2) ? int8_t { -1 } : int8_t { 0 };
+        }
+    }
+
+    return masks;
+} // makeSampleStatsMasks
+
+/*!
+ * mergeSampleStats
+ *
+ * Folds the accumulators of a vector loop into stats.
+ *
+ * @param opaque: And of every sample with the colors masked to 0xFF, all ones if the alphas are opaque.
+ * @param differences: Or of the differing bytes of neighbor samples, all zeros if the pixels are gray.
+ * @param max_samples: Largest color samples, bytes or 16 bit lanes biased by 0x8000 (signed compares).
+ * @param stats: Stats updated with the accumulators.
+*/
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+__attribute__((target("ssse3")))
+void mergeSampleStats(__m128i opaque, __m128i differences, __m128i max_samples, SampleStats& stats) noexcept
+{
+    if constexpr (CHANNELS == 2 or CHANNELS == 4)
+    {
+        stats.opaque = stats.opaque
+            and _mm_movemask_epi8(_mm_cmpeq_epi8(opaque, _mm_set1_epi8(-1))) == 0xFFFF;
+    }
+
+    if constexpr (CHANNELS >= 3)
+    {
+        stats.gray = stats.gray
+            and _mm_movemask_epi8(_mm_cmpeq_epi8(differences, _mm_setzero_si128())) == 0xFFFF;
+    }
+
+    alignas(16) std::array<uint16_t, 8> lanes {};
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes.data()), max_samples);
+
+    uint32_t max_sample { stats.max_sample };
+
+    for (const uint32_t lane : lanes)
+    {
+        if constexpr (SAMPLE_SIZE == 2)
+        {
+            max_sample = std::max(max_sample, lane ^ 0x8000u);
+        } else
+        {
+            max_sample = std::max({ max_sample, lane & 0xFFu, lane >> 8u });
+        }
+    }
+
+    stats.max_sample = static_cast<uint16_t>(max_sample);
+} // mergeSampleStats
+
+/*!
+ * SampleStatsBlocks
+ *
+ * Vector loop accumulating as many whole blocks of pixels as there are, the rest is left to a narrower kernel.
+ *
+ * @return: Number of pixels accumulated.
+*/
+using SampleStatsBlocks = std::size_t (*)(const std::byte* src, std::size_t pixels, SampleStats& stats) noexcept;
+
+/*!
+ * accumulateSampleStatsBlocks
+ *
+ * @param blocks: Instances of a vector loop, indexed by [sample_size - 1][channels - 1].
+ * @return: Number of pixels accumulated, 0 for sample sizes and channels without a vector loop.
+*/
+std::size_t accumulateSampleStatsBlocks
+(
+    const SampleStatsBlocks (&blocks)[2][4],
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    SampleStats& stats
+) noexcept
+{
+    if (sample_size < 1 or sample_size > 2 or channels < 1 or channels > 4) { return 0; }
+
+    return blocks[sample_size - 1][channels - 1](src, pixels, stats);
+} // accumulateSampleStatsBlocks
+
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+__attribute__((target("ssse3")))
+std::size_t accumulateSampleStatsBlocksSSSE3(const std::byte* src, std::size_t pixels, SampleStats& stats) noexcept
+{
+    static constexpr auto MASKS { makeSampleStatsMasks<SAMPLE_SIZE, CHANNELS>() };
+    constexpr std::size_t BLOCK_PIXELS { 16 / SAMPLE_SIZE };
+    __m128i colors[CHANNELS];
+    __m128i neighbors[CHANNELS];
+
+    for (std::size_t part = 0; part < CHANNELS; ++part)
+    {
+        colors[part] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(MASKS.colors[part].data()));
+        neighbors[part] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(MASKS.neighbors[part].data()));
+    }
+
+    const __m128i swap_mask { _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14) };
+    const __m128i bias { _mm_set1_epi16(static_cast<int16_t>(0x8000)) };
+    __m128i opaque { _mm_set1_epi8(-1) };
+    __m128i differences { _mm_setzero_si128() };
+    __m128i max_samples { SAMPLE_SIZE == 2 ? bias : _mm_setzero_si128() };
+    std::size_t i { 0 };
+
+    for (; i + BLOCK_PIXELS <= pixels; i += BLOCK_PIXELS)
+    {
+        const std::byte* block { src + i * CHANNELS * SAMPLE_SIZE };
+        __m128i parts[CHANNELS];
+
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            parts[part] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * part));
+        }
+
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            opaque = _mm_and_si128(opaque, _mm_or_si128(parts[part], colors[part]));
+
+            const __m128i color_samples { _mm_and_si128(parts[part], colors[part]) };
+
+            if constexpr (SAMPLE_SIZE == 2)
+            {
+                // Big endian samples are swapped to lanes, biased so unsigned samples compare as signed.
+                max_samples = _mm_max_epi16
+                (
+                    max_samples,
+                    _mm_xor_si128(_mm_shuffle_epi8(color_samples, swap_mask), bias)
+                );
+            } else
+            {
+                max_samples = _mm_max_epu8(max_samples, color_samples);
+            }
+
+            if constexpr (CHANNELS >= 3)
+            {
+                // The next sample of the last red or green byte of a part may start the next part.
+                const __m128i next_samples
+                {
+                    part + 1 < CHANNELS
+                        ? _mm_alignr_epi8(parts[part + 1], parts[part], SAMPLE_SIZE)
+                        : _mm_srli_si128(parts[part], SAMPLE_SIZE)
+                };
+
+                differences = _mm_or_si128
+                (
+                    differences,
+                    _mm_and_si128(_mm_xor_si128(parts[part], next_samples), neighbors[part])
+                );
+            }
+        }
+    }
+
+    if (i) { mergeSampleStats<SAMPLE_SIZE, CHANNELS>(opaque, differences, max_samples, stats); }
+
+    return i;
+} // accumulateSampleStatsBlocksSSSE3
+
+constexpr SampleStatsBlocks SAMPLE_STATS_BLOCKS_SSSE3[2][4]
+{
+    {
+        &accumulateSampleStatsBlocksSSSE3<1, 1>, &accumulateSampleStatsBlocksSSSE3<1, 2>,
+        &accumulateSampleStatsBlocksSSSE3<1, 3>, &accumulateSampleStatsBlocksSSSE3<1, 4>
+    },
+    {
+        &accumulateSampleStatsBlocksSSSE3<2, 1>, &accumulateSampleStatsBlocksSSSE3<2, 2>,
+        &accumulateSampleStatsBlocksSSSE3<2, 3>, &accumulateSampleStatsBlocksSSSE3<2, 4>
+    }
+};
+
+void accumulateSampleStatsSSSE3
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    SampleStats& stats
+) noexcept
+{
+    const std::size_t done
+    {
+        accumulateSampleStatsBlocks(SAMPLE_STATS_BLOCKS_SSSE3, src, sample_size, channels, pixels, stats)
+    };
+
+    accumulateSampleStatsScalar(src + done * channels * sample_size, sample_size, channels, pixels - done, stats);
+} // accumulateSampleStatsSSSE3
+
+template<std::size_t SAMPLE_SIZE, std::size_t CHANNELS>
+__attribute__((target("avx2")))
+std::size_t accumulateSampleStatsBlocksAVX2(const std::byte* src, std::size_t pixels, SampleStats& stats) noexcept
+{
+    static constexpr auto MASKS { makeSampleStatsMasks<SAMPLE_SIZE, CHANNELS>() };
+    constexpr std::size_t BLOCK_PIXELS { 32 / SAMPLE_SIZE };
+    __m256i colors[CHANNELS];
+    __m256i neighbors[CHANNELS];
+
+    for (std::size_t part = 0; part < CHANNELS; ++part)
+    {
+        colors[part] = _mm256_broadcastsi128_si256
+        (
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(MASKS.colors[part].data()))
+        );
+        neighbors[part] = _mm256_broadcastsi128_si256
+        (
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(MASKS.neighbors[part].data()))
+        );
+    }
+
+    const __m256i swap_mask
+    {
+        _mm256_setr_epi8
+        (
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14
+        )
+    };
+    const __m256i bias { _mm256_set1_epi16(static_cast<int16_t>(0x8000)) };
+    __m256i opaque { _mm256_set1_epi8(-1) };
+    __m256i differences { _mm256_setzero_si256() };
+    __m256i max_samples { SAMPLE_SIZE == 2 ? bias : _mm256_setzero_si256() };
+    std::size_t i { 0 };
+
+    for (; i + BLOCK_PIXELS <= pixels; i += BLOCK_PIXELS)
+    {
+        const std::byte* block { src + i * CHANNELS * SAMPLE_SIZE };
+        __m256i parts[CHANNELS];
+
+        // Byte shifts don't cross 128 bit halves, so the low half holds the first 16 * CHANNELS bytes
+        // and the high half the next ones, each half lines up with the masks.
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            parts[part] = _mm256_inserti128_si256
+            (
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * part))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * (CHANNELS + part))),
+                1
+            );
+        }
+
+        for (std::size_t part = 0; part < CHANNELS; ++part)
+        {
+            opaque = _mm256_and_si256(opaque, _mm256_or_si256(parts[part], colors[part]));
+
+            const __m256i color_samples { _mm256_and_si256(parts[part], colors[part]) };
+
+            if constexpr (SAMPLE_SIZE == 2)
+            {
+                max_samples = _mm256_max_epi16
+                (
+                    max_samples,
+                    _mm256_xor_si256(_mm256_shuffle_epi8(color_samples, swap_mask), bias)
+                );
+            } else
+            {
+                max_samples = _mm256_max_epu8(max_samples, color_samples);
+            }
+
+            if constexpr (CHANNELS >= 3)
+            {
+                const __m256i next_samples
+                {
+                    part + 1 < CHANNELS
+                        ? _mm256_alignr_epi8(parts[part + 1], parts[part], SAMPLE_SIZE)
+                        : _mm256_srli_si256(parts[part], SAMPLE_SIZE)
+                };
+
+                differences = _mm256_or_si256
+                (
+                    differences,
+                    _mm256_and_si256(_mm256_xor_si256(parts[part], next_samples), neighbors[part])
+                );
+            }
+        }
+    }
+
+    if (i)
+    {
+        const __m128i low_max_samples { _mm256_castsi256_si128(max_samples) };
+        const __m128i high_max_samples { _mm256_extracti128_si256(max_samples, 1) };
+
+        mergeSampleStats<SAMPLE_SIZE, CHANNELS>
+        (
+            _mm_and_si128(_mm256_castsi256_si128(opaque), _mm256_extracti128_si256(opaque, 1)),
+            _mm_or_si128(_mm256_castsi256_si128(differences), _mm256_extracti128_si256(differences, 1)),
+            SAMPLE_SIZE == 2
+                ? _mm_max_epi16(low_max_samples, high_max_samples)
+                : _mm_max_epu8(low_max_samples, high_max_samples),
+            stats
+        );
+    }
+
+    return i;
+} // accumulateSampleStatsBlocksAVX2
+
+constexpr SampleStatsBlocks SAMPLE_STATS_BLOCKS_AVX2[2][4]
+{
+    {
+        &accumulateSampleStatsBlocksAVX2<1, 1>, &accumulateSampleStatsBlocksAVX2<1, 2>,
+        &accumulateSampleStatsBlocksAVX2<1, 3>, &accumulateSampleStatsBlocksAVX2<1, 4>
+    },
+    {
+        &accumulateSampleStatsBlocksAVX2<2, 1>, &accumulateSampleStatsBlocksAVX2<2, 2>,
+        &accumulateSampleStatsBlocksAVX2<2, 3>, &accumulateSampleStatsBlocksAVX2<2, 4>
+    }
+};
+
+void accumulateSampleStatsAVX2
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    SampleStats& stats
+) noexcept
+{
+    const std::size_t done
+    {
+        accumulateSampleStatsBlocks(SAMPLE_STATS_BLOCKS_AVX2, src, sample_size, channels, pixels, stats)
+    };
+
+    accumulateSampleStatsSSSE3(src + done * channels * sample_size, sample_size, channels, pixels - done, stats);
+} // accumulateSampleStatsAVX2
+#endif // EID_X86_KERNELS
+
+/*!
+ * pickKernel
+ *
+ * @return: The fastest of the versions of a kernel the cpu supports.
+*/
+template<typename Kernel>
+Kernel pickKernel([[maybe_unused]] Kernel avx2, [[maybe_unused]] Kernel ssse3, Kernel scalar) noexcept
+{
+#ifdef EID_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) { return avx2; }
+    if (__builtin_cpu_supports("ssse3")) { return ssse3; }
+#endif
+
+    return scalar;
+} // pickKernel
+} // namespace
+
+void swapBytePairs(std::byte* data, std::size_t size) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel { pickKernel(&swapBytePairsAVX2, &swapBytePairsSSSE3, &swapBytePairsScalar) };
+#else
+    static const auto kernel { &swapBytePairsScalar };
+#endif
+
+    kernel(data, size);
+} // swapBytePairs
+
+void swapBytePairsParallel(std::byte* data, std::size_t size, std::size_t max_threads) noexcept
+{
+    if (not max_threads) { max_threads = std::max(std::thread::hardware_concurrency(), 1u); }
+
+    const std::size_t number_of_chunks { std::clamp<std::size_t>(size / MIN_BYTES_PER_THREAD, 1, max_threads) };
+
+    if (number_of_chunks == 1)
+    {
+        swapBytePairs(data, size);
+
+        return;
+    }
+
+    // Chunks of whole samples, the last one takes the remainder.
+    const std::size_t chunk_size { size / number_of_chunks & ~std::size_t { 1 } };
+    std::vector<std::jthread> workers;
+    std::size_t chunk { 1 };
+
+    try
+    {
+        workers.reserve(number_of_chunks - 1);
+
+        for (; chunk < number_of_chunks; ++chunk)
+        {
+            const std::size_t offset { chunk * chunk_size };
+            const std::size_t length { (chunk + 1 == number_of_chunks) ? size - offset : chunk_size };
+
+            workers.emplace_back([=] { swapBytePairs(data + offset, length); });
+        }
+    } catch (...)
+    {
+        // Couldn't start another thread, the chunks left are swapped here instead.
+        for (; chunk < number_of_chunks; ++chunk)
+        {
+            const std::size_t offset { chunk * chunk_size };
+            const std::size_t length { (chunk + 1 == number_of_chunks) ? size - offset : chunk_size };
+
+            swapBytePairs(data + offset, length);
+        }
+    }
+
+    swapBytePairs(data, chunk_size);
+} // swapBytePairsParallel
+
+void reduce16To8(const std::byte* src, std::byte* dest, std::size_t samples) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel { pickKernel(&reduce16To8AVX2, &reduce16To8SSSE3, &reduce16To8Scalar) };
+#else
+    static const auto kernel { &reduce16To8Scalar };
+#endif
+
+    kernel(src, dest, samples);
+} // reduce16To8
+
+void rgbaToPixelFormat
+(
+    const std::byte* src,
+    std::byte* dest,
+    std::size_t pixels,
+    typings::PixelFormat pixel_format
+) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel { pickKernel(&rgbaToPixelFormatAVX2, &rgbaToPixelFormatSSSE3, &rgbaToPixelFormatScalar) };
+#else
+    static const auto kernel { &rgbaToPixelFormatScalar };
+#endif
+
+    kernel(src, dest, pixels, makeSwizzle(pixel_format));
+} // rgbaToPixelFormat
+
+void rgbToPixelFormat
+(
+    const std::byte* src,
+    std::byte* dest,
+    std::size_t pixels,
+    typings::PixelFormat pixel_format
+) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel { pickKernel(&rgbToPixelFormatAVX2, &rgbToPixelFormatSSSE3, &rgbToPixelFormatScalar) };
+#else
+    static const auto kernel { &rgbToPixelFormatScalar };
+#endif
+
+    kernel(src, dest, pixels, makeSwizzle(pixel_format));
+} // rgbToPixelFormat
+
+void samplesToFloats
+(
+    const std::byte* src,
+    bool wide,
+    float* dest,
+    std::size_t count,
+    std::size_t channels,
+    const std::array<float, 4>& scale,
+    const std::array<float, 4>& offset
+) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel { pickKernel(&samplesToFloatsAVX2, &samplesToFloatsScalar, &samplesToFloatsScalar) };
+#else
+    static const auto kernel { &samplesToFloatsScalar };
+#endif
+
+    kernel(src, wide, dest, count, makeSamplePattern(channels, scale, offset));
+} // samplesToFloats
+
+void convertFloats(const float* src, std::byte* dest, std::size_t count, typings::TensorDataType data_type) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto half_kernel
+    {
+        (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("f16c")) ? &floatsToHalfsF16C : &floatsToHalfsScalar
+    };
+    static const auto bfloat16_kernel
+    {
+        pickKernel(&floatsToBFloat16sAVX2, &floatsToBFloat16sScalar, &floatsToBFloat16sScalar)
+    };
+#else
+    static const auto half_kernel { &floatsToHalfsScalar };
+    static const auto bfloat16_kernel { &floatsToBFloat16sScalar };
+#endif
+
+    switch (data_type)
+    {
+        case typings::TensorDataType::FLOAT16:  half_kernel(src, dest, count); break;
+        case typings::TensorDataType::BFLOAT16: bfloat16_kernel(src, dest, count); break;
+        default:                                std::memcpy(dest, src, count * sizeof(float)); break;
+    }
+} // convertFloats
+
+void deinterleaveSamples
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    const std::array<std::byte*, 4>& planes
+) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel
+    {
+        pickKernel(&deinterleaveSamplesAVX2, &deinterleaveSamplesSSSE3, &deinterleaveSamplesScalar)
+    };
+#else
+    static const auto kernel { &deinterleaveSamplesScalar };
+#endif
+
+    kernel(src, sample_size, channels, pixels, planes);
+} // deinterleaveSamples
+
+void expandPaletteIndices
+(
+    const std::byte* src,
+    std::size_t bit_depth,
+    std::size_t pixels,
+    const std::array<uint32_t, 256>& palette,
+    std::byte* dest,
+    std::size_t channels
+) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel
+    {
+        pickKernel(&expandPaletteIndicesAVX2, &expandPaletteIndicesScalar, &expandPaletteIndicesScalar)
+    };
+#else
+    static const auto kernel { &expandPaletteIndicesScalar };
+#endif
+
+    kernel(src, bit_depth, pixels, palette, dest, channels);
+} // expandPaletteIndices
+
+void accumulateSampleStats
+(
+    const std::byte* src,
+    std::size_t sample_size,
+    std::size_t channels,
+    std::size_t pixels,
+    SampleStats& stats
+) noexcept
+{
+#ifdef EID_X86_KERNELS
+    static const auto kernel
+    {
+        pickKernel(&accumulateSampleStatsAVX2, &accumulateSampleStatsSSSE3, &accumulateSampleStatsScalar)
+    };
+#else
+    static const auto kernel { &accumulateSampleStatsScalar };
+#endif
+
+    kernel(src, sample_size, channels, pixels, stats);
+} // accumulateSampleStats
+} // namespace utils::kernels
@@ -0,0 +1,72 @@
+#include <algorithm>
+
+#include "utils/thread-pool.hpp"
+
+namespace utils
+{
+
+ThreadPool::ThreadPool(std::size_t number_of_threads)
+{
+    if (not number_of_threads)
+    {
+        number_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    m_workers.reserve(number_of_threads);
+
+    for (std::size_t i = 0; i < number_of_threads; ++i)
+    {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+} // ThreadPool::ThreadPool
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::scoped_lock lock { m_mutex };
+
+        m_stopping = true;
+    }
+
+    m_task_available.notify_all();
+
+    for (auto& worker : m_workers) { worker.join(); }
+} // ThreadPool::~ThreadPool
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::scoped_lock lock { m_mutex };
+
+        m_tasks.push_back(std::move(task));
+    }
+
+    m_task_available.notify_one();
+} // ThreadPool::submit
+
+std::size_t ThreadPool::size() const noexcept
+{
+    return m_workers.size();
+} // ThreadPool::size
+
+void ThreadPool::workerLoop() noexcept
+{
+    while (true)
+    {
+        std::function<void()> task;
+
+        {
+            std::unique_lock lock { m_mutex };
+
+            m_task_available.wait(lock, [this] { return m_stopping or not m_tasks.empty(); });
+
+            if (m_tasks.empty()) { return; }
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+    }
+} // ThreadPool::workerLoop
+} // namespace utils
@@ -0,0 +1,317 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "utils/tracing.hpp"
+
+namespace utils::tracing
+{
+namespace
+{
+constexpr std::array<const char*, 7> TRACE_STAGE_NAMES
+{
+    "decode",
+    "chunk read",
+    "crc",
+    "inflate",
+    "defilter",
+    "conversion",
+    "cache fill"
+};
+
+struct TraceEvent
+{
+    TraceStage stage { TraceStage::DECODE };
+    uint64_t image_id { 0 };
+    int64_t begin_nanoseconds { 0 };
+    int64_t end_nanoseconds { 0 };
+}; // struct TraceEvent
+
+/*!
+ * TraceBlock
+ *
+ * Fixed size block of events, only its owner thread writes to it,
+ * the size is published with a release store after the event is written, so a reader
+ * doing an acquire load of the size can read all the events before it without locking.
+ *
+ * Once full, a new block is chained to it, the events never move.
+*/
+struct TraceBlock
+{
+    static constexpr std::size_t CAPACITY { 4096 };
+
+    std::array<TraceEvent, CAPACITY> events {};
+    std::atomic<std::size_t> size { 0 };
+    std::atomic<TraceBlock*> next { nullptr };
+}; // struct TraceBlock
+
+class ThreadTraceBuffer
+{
+public:
+    ThreadTraceBuffer(uint32_t thread_id, uint64_t generation)
+        : m_thread_id(thread_id), m_generation(generation) {}
+
+    ~ThreadTraceBuffer()
+    {
+        TraceBlock* block = m_head.next.load(std::memory_order_acquire);
+
+        while (block)
+        {
+            TraceBlock* next = block->next.load(std::memory_order_acquire);
+            delete block;
+            block = next;
+        }
+    }
+
+    ThreadTraceBuffer(ThreadTraceBuffer&&) = delete;
+    ThreadTraceBuffer(const ThreadTraceBuffer&) = delete;
+    ThreadTraceBuffer& operator=(ThreadTraceBuffer&&) = delete;
+    ThreadTraceBuffer& operator=(const ThreadTraceBuffer&) = delete;
+
+    [[nodiscard]] uint32_t threadId() const noexcept { return m_thread_id; }
+    [[nodiscard]] uint64_t generation() const noexcept { return m_generation; }
+
+    /*!
+     * append
+     *
+     * Must only be called by the thread owning the buffer.
+     * If a new block can't be allocated the event is dropped.
+    */
+    void append(const TraceEvent& event) noexcept
+    {
+        std::size_t size = m_tail->size.load(std::memory_order_relaxed);
+
+        if (size == TraceBlock::CAPACITY)
+        {
+            auto* block = new (std::nothrow) TraceBlock;
+
+            if (not block) { return; }
+
+            m_tail->next.store(block, std::memory_order_release);
+            m_tail = block;
+            size = 0;
+        }
+
+        m_tail->events[size] = event;
+        m_tail->size.store(size + 1, std::memory_order_release);
+    }
+
+    /*!
+     * forEachEvent
+     *
+     * Can be called from any thread, while the owner thread keeps appending.
+    */
+    template <typename Function>
+    void forEachEvent(Function function) const
+    {
+        const TraceBlock* block = &m_head;
+
+        while (block)
+        {
+            const std::size_t size = block->size.load(std::memory_order_acquire);
+
+            for (std::size_t i = 0; i < size; ++i) { function(block->events[i]); }
+
+            block = block->next.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    uint32_t m_thread_id { 0 };
+    uint64_t m_generation { 0 };
+    TraceBlock m_head {};
+    TraceBlock* m_tail { &m_head };
+}; // class ThreadTraceBuffer
+
+/*!
+ * Every tracing session has its own generation, when a thread notices the generation changed
+ * it registers a new buffer, leaving the spans of the previous session behind.
+*/
+std::atomic<bool> g_tracing { false };
+std::atomic<uint64_t> g_generation { 0 };
+std::atomic<uint64_t> g_next_image_id { 1 };
+std::atomic<uint32_t> g_next_thread_id { 1 };
+
+std::mutex g_registry_mutex;
+std::vector<std::shared_ptr<ThreadTraceBuffer>> g_registry;
+std::filesystem::path g_output_filepath;
+
+int64_t nowNanoseconds() noexcept
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+} // nowNanoseconds
+
+ThreadTraceBuffer* threadTraceBuffer() noexcept
+{
+    thread_local const uint32_t thread_id { g_next_thread_id.fetch_add(1, std::memory_order_relaxed) };
+    thread_local std::shared_ptr<ThreadTraceBuffer> buffer;
+
+    const uint64_t generation { g_generation.load(std::memory_order_acquire) };
+
+    if (buffer and buffer->generation() == generation) { return buffer.get(); }
+
+    try
+    {
+        auto new_buffer = std::make_shared<ThreadTraceBuffer>(thread_id, generation);
+        const std::lock_guard<std::mutex> lock(g_registry_mutex);
+
+        // The session may have been restarted in between, the buffer would belong to no session then.
+        if (generation != g_generation.load(std::memory_order_relaxed)) { return nullptr; }
+
+        g_registry.push_back(new_buffer);
+        buffer = std::move(new_buffer);
+    } catch (const std::exception&)
+    {
+        return nullptr;
+    }
+
+    return buffer.get();
+} // threadTraceBuffer
+
+/*!
+ * writeMicroseconds
+ *
+ * Trace-event timestamps are in microseconds, we keep the nanoseconds as the fractional part.
+*/
+void writeMicroseconds(std::ofstream& stream, int64_t nanoseconds)
+{
+    stream << (nanoseconds / 1000) << "." << std::setw(3) << std::setfill('0') << (nanoseconds % 1000);
+} // writeMicroseconds
+
+void writeEvent(std::ofstream& stream, const TraceEvent& event, uint32_t thread_id, bool& first)
+{
+    stream
+    << (first ? "\n" : ",\n")
+    << R"({"name":")" << TRACE_STAGE_NAMES[static_cast<std::size_t>(event.stage)]
+    << R"(","cat":"eid","ph":"X","pid":1,"tid":)" << thread_id
+    << R"(,"ts":)";
+
+    writeMicroseconds(stream, event.begin_nanoseconds);
+
+    stream << R"(,"dur":)";
+
+    writeMicroseconds(stream, event.end_nanoseconds - event.begin_nanoseconds);
+
+    stream << R"(,"args":{"image_id":)" << event.image_id << "}}";
+
+    first = false;
+} // writeEvent
+} // namespace
+
+void startTracing(const std::filesystem::path& output_filepath)
+{
+    const std::lock_guard<std::mutex> lock(g_registry_mutex);
+
+    if (g_tracing.load(std::memory_order_relaxed))
+    {
+        throw std::runtime_error(__func__ + std::string("\nTracing is already on.\n"));
+    }
+
+    g_registry.clear();
+    g_output_filepath = output_filepath;
+    g_generation.fetch_add(1, std::memory_order_release);
+    g_tracing.store(true, std::memory_order_release);
+} // startTracing
+
+void stopTracing()
+{
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> registry;
+    std::filesystem::path output_filepath;
+
+    {
+        const std::lock_guard<std::mutex> lock(g_registry_mutex);
+
+        if (not g_tracing.load(std::memory_order_relaxed))
+        {
+            throw std::runtime_error(__func__ + std::string("\nTracing is already off.\n"));
+        }
+
+        g_tracing.store(false, std::memory_order_release);
+        registry = g_registry;
+        output_filepath = g_output_filepath;
+    }
+
+    std::ofstream stream(output_filepath, std::ios::trunc);
+
+    if (not stream.is_open())
+    {
+        throw std::runtime_error
+        (
+            __func__ + std::string("\nFailed to open trace file: ") + output_filepath.string() + "\n"
+        );
+    }
+
+    bool first { true };
+
+    stream << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+    for (const auto& buffer : registry)
+    {
+        // Metadata event, names the thread in the viewer.
+        stream
+        << (first ? "\n" : ",\n")
+        << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer->threadId()
+        << R"(,"args":{"name":"thread )" << buffer->threadId() << R"("}})";
+
+        first = false;
+
+        buffer->forEachEvent([&](const TraceEvent& event) { writeEvent(stream, event, buffer->threadId(), first); });
+    }
+
+    stream << "\n]}\n";
+
+    if (not stream.good())
+    {
+        throw std::runtime_error
+        (
+            __func__ + std::string("\nFailed to write trace file: ") + output_filepath.string() + "\n"
+        );
+    }
+} // stopTracing
+
+bool isTracing() noexcept
+{
+    return g_tracing.load(std::memory_order_relaxed);
+} // isTracing
+
+uint64_t nextImageId() noexcept
+{
+    return g_next_image_id.fetch_add(1, std::memory_order_relaxed);
+} // nextImageId
+
+TraceScope::TraceScope(TraceStage stage, uint64_t image_id) noexcept
+    : m_stage(stage), m_image_id(image_id)
+{
+    if (isTracing()) { m_begin_nanoseconds = nowNanoseconds(); }
+} // TraceScope::TraceScope
+
+TraceScope::~TraceScope()
+{
+    if (m_begin_nanoseconds < 0) { return; }
+
+    ThreadTraceBuffer* buffer = threadTraceBuffer();
+
+    if (not buffer) { return; }
+
+    buffer->append
+    (
+        TraceEvent
+        {
+            .stage = m_stage,
+            .image_id = m_image_id,
+            .begin_nanoseconds = m_begin_nanoseconds,
+            .end_nanoseconds = nowNanoseconds()
+        }
+    );
+} // TraceScope::~TraceScope
+} // namespace utils::tracing
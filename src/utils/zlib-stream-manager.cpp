@@ -1,11 +1,14 @@
 #include <stdexcept>
 
+#include "utils/decode-limits.hpp"
+#include "utils/interruption.hpp"
 #include "utils/utils.hpp"
 #include "utils/zlib-stream-manager.hpp"
 
 namespace utils {
 
-ZlibStreamManager::ZlibStreamManager(uint32_t buffer_size)
+ZlibStreamManager::ZlibStreamManager(uint32_t buffer_size, std::pmr::memory_resource* memory_resource)
+    : m_buffer(memory_resource)
 {
     int ret = inflateInit(&m_z_stream);
 
@@ -28,14 +31,25 @@ ZlibStreamManager& ZlibStreamManager::operator=(ZlibStreamManager&&) = default;
 void ZlibStreamManager::decompressData
 (
     typings::CBytes& compressed_data,
-    typings::Bytes& decompressed_data
+    typings::Bytes& decompressed_data,
+    DecodeStats* decode_stats,
+    const typings::DecodeOptions* decode_options
 )
 {
+    StageTimer inflate_timer { decode_stats ? &decode_stats->inflate : nullptr };
+    const std::size_t decompressed_data_size { decompressed_data.size() };
+    uint32_t rounds { 0 };
+
     m_z_stream.next_in = std::bit_cast<Bytef*>(compressed_data.data());
     m_z_stream.avail_in = compressed_data.size();
 
     while (m_z_stream.avail_in > 0) // there's no more data to be processed when avail_in is 0
     {
+        if (decode_options and rounds++ % INFLATE_ROUNDS_PER_INTERRUPTION_CHECK == 0)
+        {
+            throwIfInterrupted(*decode_options, __func__);
+        }
+
         m_z_stream.next_out = std::bit_cast<Bytef*>(m_buffer.data());
         m_z_stream.avail_out = m_buffer.size();
         int ret = inflate(&m_z_stream, Z_NO_FLUSH);
@@ -46,8 +60,28 @@ void ZlibStreamManager::decompressData
             throw std::runtime_error("Inflate error: " + std::to_string(ret) + "\n" + m_z_stream.msg + "\n");
         }
 
+        if (decompressed_data.size() + number_of_bytes_written > m_output_limit)
+        {
+            throw DecodeLimitExceeded
+            (
+                __func__
+                + std::string("\nMore image data than the ") + std::to_string(m_output_limit) + " bytes expected.\n"
+            );
+        }
+
         appendNBytes(m_buffer, decompressed_data, number_of_bytes_written);
     }
+
+    if (decode_stats)
+    {
+        decode_stats->compressed_bytes += compressed_data.size();
+        decode_stats->inflated_bytes += decompressed_data.size() - decompressed_data_size;
+    }
+}
+
+void ZlibStreamManager::setOutputLimit(std::size_t output_limit) noexcept
+{
+    m_output_limit = output_limit;
 }
 
 } //namespace utils
@@ -1,8 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "image-decoder-wrapper/image-decoder-wrapper.h"
 
+static void onDecodeRequestDone(DecodeRequestHandle* handle, const DecodeResult* result, void* user_data)
+{
+    (void)handle;
+
+    *(int*)user_data = result->status == 0;
+}
+
 int main(int argc, const char** argv)
 {
     uint32_t width = 0;
@@ -10,19 +18,29 @@ int main(int argc, const char** argv)
     ImageColorType image_color_type;
     uint8_t image_bit_depth = 0;
     uint8_t image_number_of_channels = 0;
-    uint32_t image_scanline_size = 0;
-    uint32_t image_scanlines_size = 0;
-    uint32_t image_rgb_scanline_size = 0;
-    uint32_t image_rgb_scanlines_size = 0;
-    uint32_t image_rgba_scanline_size = 0;
-    uint32_t image_rgba_scanlines_size = 0;
+    uint64_t image_scanline_size = 0;
+    uint64_t image_scanlines_size = 0;
+    uint64_t image_rgb_scanline_size = 0;
+    uint64_t image_rgb_scanlines_size = 0;
+    uint64_t image_rgba_scanline_size = 0;
+    uint64_t image_rgba_scanlines_size = 0;
 
     const char* error = NULL;
+    ImageDecoderOptions options = { 0 };
+    options.collect_decode_stats = 1;
+
+    if (startDecodeTracing("image-decoder-wrapper-tests-trace.json", &error) != 0)
+    {
+        printf("startDecodeTracing failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
 
     ImageDecoderWrapper* image_decoder_wrapper =
-    createImageDecoderInstance
+    createImageDecoderInstanceWithOptions
     (
         "../../input-images/indexed_1_bit_depth.png",
+        &options,
         &width,
         &height,
         &image_color_type,
@@ -45,7 +63,16 @@ int main(int argc, const char** argv)
         return EXIT_FAILURE;
     }
 
-    int ret = swapBytesOrder(image_decoder_wrapper, &error);
+    int ret = stopDecodeTracing(&error);
+
+    if (ret != 0)
+    {
+        printf("stopDecodeTracing failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    ret = swapBytesOrder(image_decoder_wrapper, &error);
 
     if (ret != 0)
     {
@@ -68,9 +95,533 @@ int main(int argc, const char** argv)
     printf("Image color type: %d\n", image_color_type);
     printf("Image bit depth: %d\n", image_bit_depth);
     printf("Image number of channels: %d\n", image_number_of_channels);
-    printf("Image scanline size: %d\n", image_scanline_size);
-    printf("Image scanlines size: %d\n", image_scanlines_size);
+    printf("Image scanline size: %llu\n", (unsigned long long)image_scanline_size);
+    printf("Image scanlines size: %llu\n", (unsigned long long)image_scanlines_size);
+
+    MemoryStats memory_stats;
+
+    ret = getMemoryStats(image_decoder_wrapper, &memory_stats, &error);
+
+    if (ret != 0)
+    {
+        printf("getMemoryStats failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    printf("Decoder allocations: %llu\n", (unsigned long long)memory_stats.total.allocations);
+    printf("Decoder peak bytes: %llu\n", (unsigned long long)memory_stats.total.peak_bytes);
+    printf("Decoder current bytes: %llu\n", (unsigned long long)memory_stats.total.current_bytes);
+
+    DecodeStats decode_stats;
+
+    ret = getDecodeStats(image_decoder_wrapper, &decode_stats, &error);
+
+    if (ret != 0)
+    {
+        printf("getDecodeStats failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    printf("Decode time (ns): %llu\n", (unsigned long long)decode_stats.total_decode_nanoseconds);
+    printf("Inflate time (ns): %llu\n", (unsigned long long)decode_stats.inflate_nanoseconds);
+    printf("Defilter time (ns): %llu\n", (unsigned long long)decode_stats.defilter_nanoseconds);
+    printf("Inflated bytes: %llu\n", (unsigned long long)decode_stats.inflated_bytes);
+
+    size_t borrowed_rgba_data_length = 0;
+    const uint8_t* borrowed_rgba_data =
+    borrowRawDataRGBABuffer(image_decoder_wrapper, &borrowed_rgba_data_length, &error);
+
+    if (! borrowed_rgba_data || borrowed_rgba_data_length != image_rgba_scanlines_size)
+    {
+        printf("borrowRawDataRGBABuffer failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    uint8_t* rgba_data = malloc(borrowed_rgba_data_length);
+    size_t written_size = 0;
+
+    ret = decodeImageInto
+    (
+        "../../input-images/indexed_1_bit_depth.png",
+        NULL,
+        RGBA_PIXEL_FORMAT,
+        rgba_data,
+        borrowed_rgba_data_length,
+        &written_size,
+        &error
+    );
+
+    if (ret != 0 || written_size != borrowed_rgba_data_length)
+    {
+        printf("decodeImageInto failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    if (memcmp(rgba_data, borrowed_rgba_data, written_size) != 0)
+    {
+        printf("Borrowed and decoded into rgba data differ\n");
+
+        return EXIT_FAILURE;
+    }
+
+    DecodeCancellationToken* cancellation_token = createDecodeCancellationToken(&error);
+
+    if (! cancellation_token)
+    {
+        printf("createDecodeCancellationToken failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    ImageDecoderOptions cancelled_options = { 0 };
+    cancelled_options.cancellation_token = cancellation_token;
+
+    cancelDecode(cancellation_token);
+
+    ret = decodeImageInto
+    (
+        "../../input-images/indexed_1_bit_depth.png",
+        &cancelled_options,
+        RGBA_PIXEL_FORMAT,
+        rgba_data,
+        borrowed_rgba_data_length,
+        NULL,
+        &error
+    );
+
+    if (ret != DECODE_CANCELLED)
+    {
+        printf("Cancelled decode didn't return DECODE_CANCELLED\n");
+
+        return EXIT_FAILURE;
+    }
+
+    destroyDecodeCancellationToken(cancellation_token);
+
+    ImageDecoderOptions limited_options = { 0 };
+    limited_options.max_pixels = 1;
+
+    ret = decodeImageInto
+    (
+        "../../input-images/indexed_1_bit_depth.png",
+        &limited_options,
+        RGBA_PIXEL_FORMAT,
+        rgba_data,
+        borrowed_rgba_data_length,
+        NULL,
+        &error
+    );
+
+    if (ret != LIMIT_EXCEEDED)
+    {
+        printf("Decode over the pixel limit didn't return LIMIT_EXCEEDED\n");
+
+        return EXIT_FAILURE;
+    }
+
+    ImageDecoderOptions budget_options = { 0 };
+    budget_options.memory_budget_bytes = 5550;
+
+    ImageDecoderWrapper* budget_image_decoder_wrapper = createImageDecoderInstanceWithOptions
+    (
+        "../../input-images/grayscale_1_bit_depth.png",
+        &budget_options,
+        &width,
+        &height,
+        &image_color_type,
+        &image_bit_depth,
+        &image_number_of_channels,
+        &image_scanline_size,
+        &image_scanlines_size,
+        &image_rgb_scanline_size,
+        &image_rgb_scanlines_size,
+        &image_rgba_scanline_size,
+        &image_rgba_scanlines_size,
+        &error
+    );
+
+    if (! budget_image_decoder_wrapper)
+    {
+        printf("createImageDecoderInstanceWithOptions within the memory budget failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    uint8_t* over_budget_rgba_data = getRawDataRGBABuffer(budget_image_decoder_wrapper, &error);
+
+    if (over_budget_rgba_data != NULL)
+    {
+        printf("Conversion over the memory budget succeeded\n");
+
+        return EXIT_FAILURE;
+    }
+
+    freeRawDataBuffer(over_budget_rgba_data);
+    destroyImageDecoderInstance(budget_image_decoder_wrapper);
+
+    ImageDecoderOptions out_of_core_options = { 0 };
+    out_of_core_options.out_of_core_directory = ".";
+
+    ret = decodeImageInto
+    (
+        "../../input-images/indexed_1_bit_depth.png",
+        &out_of_core_options,
+        RGBA_PIXEL_FORMAT,
+        rgba_data,
+        borrowed_rgba_data_length,
+        NULL,
+        &error
+    );
+
+    if (ret != 0)
+    {
+        printf("decodeImageInto out of core failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    if (memcmp(rgba_data, borrowed_rgba_data, borrowed_rgba_data_length) != 0)
+    {
+        printf("Out of core and in memory rgba data differ\n");
+
+        return EXIT_FAILURE;
+    }
+
+    ImageDecoderOptions reduced_options = { 0 };
+    reduced_options.reduce_to_8_bits = 1;
+
+    ImageDecoderWrapper* reduced_image_decoder_wrapper = createImageDecoderInstanceWithOptions
+    (
+        "../../input-images/rgba_16_bit_depth.png",
+        &reduced_options,
+        &width,
+        &height,
+        &image_color_type,
+        &image_bit_depth,
+        &image_number_of_channels,
+        &image_scanline_size,
+        &image_scanlines_size,
+        &image_rgb_scanline_size,
+        &image_rgb_scanlines_size,
+        &image_rgba_scanline_size,
+        &image_rgba_scanlines_size,
+        &error
+    );
+
+    if (! reduced_image_decoder_wrapper)
+    {
+        printf("createImageDecoderInstanceWithOptions reduced to 8 bits failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    if (image_bit_depth != 8 || image_rgba_scanlines_size != (uint64_t)width * height * 4)
+    {
+        printf("16 bit image wasn't reduced to 8 bits\n");
+
+        return EXIT_FAILURE;
+    }
+
+    destroyImageDecoderInstance(reduced_image_decoder_wrapper);
+
+    ImageDecoderOptions content_options = { 0 };
+    content_options.reduce_channels = 1;
+
+    ImageDecoderWrapper* content_image_decoder_wrapper = createImageDecoderInstanceWithOptions
+    (
+        "../../input-images/rgba_16_bit_depth.png",
+        &content_options,
+        &width,
+        &height,
+        &image_color_type,
+        &image_bit_depth,
+        &image_number_of_channels,
+        &image_scanline_size,
+        &image_scanlines_size,
+        &image_rgb_scanline_size,
+        &image_rgb_scanlines_size,
+        &image_rgba_scanline_size,
+        &image_rgba_scanlines_size,
+        &error
+    );
+
+    if (! content_image_decoder_wrapper)
+    {
+        printf("createImageDecoderInstanceWithOptions reducing channels failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    ImageContent image_content = { 0 };
+
+    ret = getImageContent(content_image_decoder_wrapper, &image_content, &error);
+
+    if (ret != 0)
+    {
+        printf("getImageContent failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    if
+    (
+        image_content.original_color_type != RGBA_COLOR_TYPE
+        || image_number_of_channels != (image_content.opaque ? 1 : 2) + (image_content.gray ? 0 : 2)
+    )
+    {
+        printf("Channels weren't reduced to the detected content\n");
+
+        return EXIT_FAILURE;
+    }
+
+    destroyImageDecoderInstance(content_image_decoder_wrapper);
+
+    uint8_t* bgra_data = malloc(borrowed_rgba_data_length);
+
+    ret = decodeImageInto
+    (
+        "../../input-images/indexed_1_bit_depth.png",
+        NULL,
+        BGRA_PREMULTIPLIED_PIXEL_FORMAT,
+        bgra_data,
+        borrowed_rgba_data_length,
+        NULL,
+        &error
+    );
+
+    if (ret != 0)
+    {
+        printf("decodeImageInto premultiplied bgra failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    int bgra_matches = 1;
+
+    // The image is opaque, premultiplying leaves the colors as they are.
+    for (size_t i = 0; i < borrowed_rgba_data_length; i += 4)
+    {
+        bgra_matches &= bgra_data[i] == borrowed_rgba_data[i + 2]
+            && bgra_data[i + 1] == borrowed_rgba_data[i + 1]
+            && bgra_data[i + 2] == borrowed_rgba_data[i]
+            && bgra_data[i + 3] == borrowed_rgba_data[i + 3];
+    }
+
+    if (! bgra_matches)
+    {
+        printf("Premultiplied bgra isn't the rgba data swizzled\n");
+
+        return EXIT_FAILURE;
+    }
+
+    free(bgra_data);
+
+    uint8_t trns_rgba_data[16];
+    const uint8_t expected_trns_rgba_data[16] = { 0, 0, 0, 255, 64, 64, 64, 0, 128, 128, 128, 255, 255, 255, 255, 255 };
+
+    ret = decodeImageInto
+    (
+        "../../input-images/grayscale_8_bit_depth_trns.png",
+        NULL,
+        RGBA_PIXEL_FORMAT,
+        trns_rgba_data,
+        sizeof(trns_rgba_data),
+        NULL,
+        &error
+    );
+
+    if (ret != 0)
+    {
+        printf("decodeImageInto with a transparent color failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    if (memcmp(trns_rgba_data, expected_trns_rgba_data, sizeof(trns_rgba_data)) != 0)
+    {
+        printf("Transparent color wasn't keyed out of the rgba data\n");
+
+        return EXIT_FAILURE;
+    }
+
+    uint8_t* rgba_planes[4] = { NULL, NULL, NULL, NULL };
+    size_t plane_size = borrowed_rgba_data_length / 4;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        rgba_planes[i] = malloc(plane_size);
+    }
+
+    ret = decodeImagePlanesInto
+    (
+        "../../input-images/indexed_1_bit_depth.png",
+        NULL,
+        4,
+        rgba_planes,
+        plane_size,
+        NULL,
+        &error
+    );
+
+    if (ret != 0)
+    {
+        printf("decodeImagePlanesInto failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    int planes_match = 1;
+
+    for (size_t i = 0; i < borrowed_rgba_data_length; ++i)
+    {
+        planes_match &= rgba_planes[i % 4][i / 4] == borrowed_rgba_data[i];
+    }
+
+    if (! planes_match)
+    {
+        printf("Planes aren't the rgba data split by channel\n");
+
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        free(rgba_planes[i]);
+    }
+
+    FILE* image_file = fopen("../../input-images/indexed_1_bit_depth.png", "rb");
+
+    if (! image_file)
+    {
+        printf("Failed to open the image\n");
+
+        return EXIT_FAILURE;
+    }
+
+    fseek(image_file, 0, SEEK_END);
+
+    size_t image_data_size = (size_t)ftell(image_file);
+    uint8_t* image_data = malloc(image_data_size);
+
+    fseek(image_file, 0, SEEK_SET);
+
+    if (fread(image_data, 1, image_data_size, image_file) != image_data_size)
+    {
+        printf("Failed to read the image\n");
+
+        return EXIT_FAILURE;
+    }
+
+    fclose(image_file);
+
+    DecodeThreadPool* decode_thread_pool = createDecodeThreadPool(2, &error);
+
+    if (! decode_thread_pool)
+    {
+        printf("createDecodeThreadPool failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    uint8_t* batch_buffers[2] = { malloc(written_size), malloc(written_size) };
+    DecodeRequest requests[2] = { { 0 }, { 0 } };
+    DecodeResult results[2];
+
+    requests[0].image_filepath = "../../input-images/indexed_1_bit_depth.png";
+    requests[1].image_data = image_data;
+    requests[1].image_data_size = image_data_size;
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        requests[i].pixel_format = RGBA_PIXEL_FORMAT;
+        requests[i].buffer = batch_buffers[i];
+        requests[i].buffer_size = written_size;
+    }
+
+    ret = decodeImageBatch(decode_thread_pool, requests, results, 2, &error);
+
+    if (ret != 0)
+    {
+        printf("decodeImageBatch failed: %s (%s, %s)\n", error, results[0].error, results[1].error);
+
+        return EXIT_FAILURE;
+    }
+
+    if
+    (
+        memcmp(batch_buffers[0], rgba_data, written_size) != 0
+        || memcmp(batch_buffers[1], rgba_data, written_size) != 0
+    )
+    {
+        printf("Batch decoded from file and from memory differ\n");
+
+        return EXIT_FAILURE;
+    }
+
+    int callback_succeeded = 0;
+    DecodeRequest request = { 0 };
+
+    request.image_data = image_data;
+    request.image_data_size = image_data_size;
+    request.pixel_format = RGBA_PIXEL_FORMAT;
+
+    DecodeRequestHandle* handle =
+    submitDecodeRequest(decode_thread_pool, &request, onDecodeRequestDone, &callback_succeeded, &error);
+
+    if (! handle)
+    {
+        printf("submitDecodeRequest failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    DecodeResult result;
+
+    ret = waitDecodeRequest(handle, &result, &error);
+
+    if (ret != 0 || result.status != 0)
+    {
+        printf("waitDecodeRequest failed: %s\n", ret != 0 ? error : result.error);
+
+        return EXIT_FAILURE;
+    }
+
+    size_t submitted_pixels_length = 0;
+    const uint8_t* submitted_pixels = borrowDecodeRequestPixels(handle, &submitted_pixels_length, &error);
+
+    if (! submitted_pixels || submitted_pixels_length != written_size)
+    {
+        printf("borrowDecodeRequestPixels failed: %s\n", error);
+
+        return EXIT_FAILURE;
+    }
+
+    if (memcmp(submitted_pixels, rgba_data, written_size) != 0)
+    {
+        printf("Submitted and decoded into rgba data differ\n");
+
+        return EXIT_FAILURE;
+    }
+
+    releaseDecodeRequest(handle);
+    // Waits for the callback to return.
+    destroyDecodeThreadPool(decode_thread_pool);
+
+    if (! callback_succeeded)
+    {
+        printf("Decode request callback failed\n");
+
+        return EXIT_FAILURE;
+    }
 
+    free(batch_buffers[0]);
+    free(batch_buffers[1]);
+    free(image_data);
+    free(rgba_data);
     freeRawDataBuffer(raw_data);
     destroyImageDecoderInstance(image_decoder_wrapper);
 
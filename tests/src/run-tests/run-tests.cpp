@@ -1,9 +1,17 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <future>
 #include <iostream>
+#include <latch>
+#include <thread>
 
 #include "image-decoder/image-decoder.hpp"
 #include "run-tests/utils.hpp"
+#include "utils/decode-limits.hpp"
+#include "utils/pixel-kernels.hpp"
 #include "utils/typings.hpp"
 
 int main(int argc, const char** argv)
@@ -37,8 +45,8 @@ int main(int argc, const char** argv)
         uint32_t heigth { decoder.getImageHeight() };
         uint8_t bit_depth { decoder.getImageBitDepth() };
         utils::typings::ImageColorType color_type { decoder.getImageColorType() };
-        uint32_t scanline_size { decoder.getImageScanlineSize() };
-        uint32_t scanlines_size { decoder.getImageScanlinesSize() };
+        uint64_t scanline_size { decoder.getImageScanlineSize() };
+        uint64_t scanlines_size { decoder.getImageScanlinesSize() };
         uint8_t number_of_channels { decoder.getImageNumberOfChannels() };
 
         utils::typings::Bytes raw_data { decoder.getRawDataRGBA() };
@@ -72,5 +80,530 @@ int main(int argc, const char** argv)
         std::cout << "------------------------------------------\n";
     }
 
+    // The same image decoded on the shared thread pool must match the synchronous decode.
+    image_decoder::ImageDecoder decoder(files.front());
+    image_decoder::ImageDecoder async_decoder { image_decoder::ImageDecoder::decodeAsync(files.front()).future().get() };
+
+    assert(std::ranges::equal(decoder.getRawDataView(), async_decoder.getRawDataView()));
+
+    // The result of an async decode is taken once, asking for it again throws instead of handing out a moved from one.
+    image_decoder::AsyncDecode async_decode { image_decoder::ImageDecoder::decodeAsync(files.front()) };
+    std::future<image_decoder::ImageDecoder> async_future { async_decode.future() };
+
+    for (const bool decoded : { false, true })
+    {
+        if (decoded) { (void)async_future.get(); }
+
+        bool already_retrieved { false };
+
+        try
+        {
+            (void)async_decode.future();
+        } catch (const std::future_error& e)
+        {
+            already_retrieved = e.code() == std::future_errc::future_already_retrieved;
+        }
+
+        assert(already_retrieved);
+    }
+
+    // A cache going over the memory budget throws, the decode itself fits in it.
+    utils::typings::DecodeOptions budget_options {};
+    budget_options.memory_budget_bytes = 5550;
+
+    image_decoder::ImageDecoder budget_decoder("../../input-images/grayscale_1_bit_depth.png", budget_options);
+    bool limit_exceeded { false };
+
+    try
+    {
+        (void)budget_decoder.getRawDataRGBA();
+    } catch (const utils::DecodeLimitExceeded&)
+    {
+        limit_exceeded = true;
+    }
+
+    assert(limit_exceeded);
+
+    // The raw data is handed over without a copy and outlives the decoder, converting it afterwards throws.
+    utils::typings::Bytes taken_raw_data {};
+
+    {
+        image_decoder::ImageDecoder taken_decoder(files.front());
+        const utils::typings::Byte* raw_data_ptr { taken_decoder.getRawDataView().data() };
+
+        taken_raw_data = taken_decoder.takeRawData();
+
+        assert(taken_raw_data.data() == raw_data_ptr);
+        assert
+        (
+            taken_decoder.getMemoryStats().buffers[static_cast<std::size_t>(utils::BufferKind::DEFILTERED)].current_bytes == 0
+        );
+
+        bool conversion_failed { false };
+
+        try
+        {
+            (void)taken_decoder.getRawDataRGBA();
+        } catch (const std::runtime_error&)
+        {
+            conversion_failed = true;
+        }
+
+        assert(conversion_failed);
+    }
+
+    assert(std::ranges::equal(taken_raw_data, decoder.getRawDataView()));
+
+    const auto equals
+    {
+        [](utils::typings::BytesView bytes, std::initializer_list<uint8_t> expected)
+        {
+            const auto to_integer { [](utils::typings::Byte byte) { return std::to_integer<uint8_t>(byte); } };
+
+            return std::ranges::equal(bytes, expected, {}, to_integer);
+        }
+    };
+
+    // Pixels matching the tRNS entries (or keys) are transparent, whichever way the image is converted to rgba.
+    image_decoder::ImageDecoder indexed_trns_decoder("../../input-images/indexed_8_bit_depth_trns.png");
+    image_decoder::ImageDecoder grayscale_trns_decoder("../../input-images/grayscale_8_bit_depth_trns.png");
+    image_decoder::ImageDecoder rgb_trns_decoder("../../input-images/rgb_16_bit_depth_trns.png");
+
+    assert
+    (
+        equals
+        (
+            indexed_trns_decoder.getRawDataRGBA(),
+            { 255, 0, 0, 0, 0, 255, 0, 128, 0, 0, 255, 255, 255, 255, 255, 255 }
+        )
+    );
+    assert(equals(indexed_trns_decoder.getRawDataRGB(), { 255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255 }));
+    assert
+    (
+        equals
+        (
+            grayscale_trns_decoder.getRawDataRGBA(),
+            { 0, 0, 0, 255, 64, 64, 64, 0, 128, 128, 128, 255, 255, 255, 255, 255 }
+        )
+    );
+    assert
+    (
+        equals
+        (
+            rgb_trns_decoder.getRawDataRGBAView(),
+            { 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0, 0, 0xFF, 0xFF, 0, 0, 0, 0, 0xFF, 0xFF }
+        )
+    );
+
+    for (auto* trns_decoder : { &indexed_trns_decoder, &grayscale_trns_decoder })
+    {
+        assert
+        (
+            std::ranges::equal
+            (
+                trns_decoder->getRawDataPixelFormat(utils::typings::PixelFormat::RGBA),
+                trns_decoder->getRawDataRGBAView()
+            )
+        );
+    }
+
+    rgb_trns_decoder.swapBytesOrder();
+
+    // Swapped to little endian, the alpha included.
+    assert
+    (
+        equals
+        (
+            rgb_trns_decoder.getRawDataRGBA(),
+            { 0x34, 0x12, 0x78, 0x56, 0xBC, 0x9A, 0, 0, 0xFF, 0xFF, 0, 0, 0, 0, 0xFF, 0xFF }
+        )
+    );
+
+    /*!
+     * Packed indices go through the same palette lookup, with the tRNS alphas in it, the entries past them opaque.
+     * The 5x2 image is red, green, blue, white and red, then white, blue, green, red and green,
+     * red being transparent and green half so.
+    */
+    image_decoder::ImageDecoder packed_trns_decoder("../../input-images/indexed_2_bit_depth_trns.png");
+
+    assert
+    (
+        equals
+        (
+            packed_trns_decoder.getRawDataRGBA(),
+            {
+                255, 0, 0, 0, 0, 255, 0, 128, 0, 0, 255, 255, 255, 255, 255, 255, 255, 0, 0, 0,
+                255, 255, 255, 255, 0, 0, 255, 255, 0, 255, 0, 128, 255, 0, 0, 0, 0, 255, 0, 128
+            }
+        )
+    );
+    assert
+    (
+        equals
+        (
+            packed_trns_decoder.getRawDataPixelFormat(utils::typings::PixelFormat::BGRA_PREMULTIPLIED),
+            {
+                0, 0, 0, 0, 0, 128, 0, 128, 255, 0, 0, 255, 255, 255, 255, 255, 0, 0, 0, 0,
+                255, 255, 255, 255, 255, 0, 0, 255, 0, 128, 0, 128, 0, 0, 0, 0, 0, 128, 0, 128
+            }
+        )
+    );
+
+    // Aligned rgb and rgba rows are converted straight from the defiltered data, without filling the caches.
+    std::vector<std::filesystem::path> aligned_files { files };
+
+    aligned_files.emplace_back("../../input-images/indexed_2_bit_depth_trns.png");
+    aligned_files.emplace_back("../../input-images/indexed_8_bit_depth_trns.png");
+    aligned_files.emplace_back("../../input-images/grayscale_8_bit_depth_trns.png");
+    aligned_files.emplace_back("../../input-images/rgb_16_bit_depth_trns.png");
+
+    for (const auto& filepath : aligned_files)
+    {
+        for (const bool swap_bytes_order : { false, true })
+        {
+            image_decoder::ImageDecoder aligned_decoder(filepath);
+
+            if (swap_bytes_order) { aligned_decoder.swapBytesOrder(); }
+
+            const utils::AlignedBuffer rgb_rows { aligned_decoder.getRawDataRGBAligned({ .row_padding = 5 }) };
+            const utils::AlignedBuffer rgba_rows { aligned_decoder.getRawDataRGBAAligned() };
+            const utils::MemoryStats memory_stats { aligned_decoder.getMemoryStats() };
+
+            assert(memory_stats.buffers[static_cast<std::size_t>(utils::BufferKind::RGB_CACHE)].allocations == 0);
+            assert(memory_stats.buffers[static_cast<std::size_t>(utils::BufferKind::RGBA_CACHE)].allocations == 0);
+
+            const utils::typings::BytesView rgb { aligned_decoder.getRawDataRGBView() };
+            const utils::typings::BytesView rgba { aligned_decoder.getRawDataRGBAView() };
+            const uint64_t rgb_row_size { aligned_decoder.getImageRGBScanlineSize() };
+            const uint64_t rgba_row_size { aligned_decoder.getImageRGBAScanlineSize() };
+
+            assert(rgb_rows.rows() == aligned_decoder.getImageHeight() and rgba_rows.rows() == rgb_rows.rows());
+
+            for (std::size_t row = 0; row < rgb_rows.rows(); ++row)
+            {
+                assert(std::ranges::equal(rgb_rows.row(row), rgb.subspan(row * rgb_row_size, rgb_row_size)));
+                assert(std::ranges::equal(rgba_rows.row(row), rgba.subspan(row * rgba_row_size, rgba_row_size)));
+            }
+        }
+    }
+
+    const auto near
+    {
+        [](std::span<const float> elements, std::initializer_list<float> expected)
+        {
+            return std::ranges::equal
+            (
+                elements,
+                expected,
+                [](float element, float value) { return std::abs(element - value) < 1e-5f; }
+            );
+        }
+    };
+
+    // Tensors of the grayscale tRNS fixture, samples 0, 64, 128 and 255, the 64 ones transparent.
+    const float gray_64 { 64.0f / 255.0f };
+    const float gray_128 { 128.0f / 255.0f };
+    utils::typings::TensorOptions tensor_options {};
+    tensor_options.channels = 4;
+    std::vector<float> tensor(grayscale_trns_decoder.getImageTensorSize(tensor_options) / sizeof(float));
+
+    grayscale_trns_decoder.convertRawDataToTensor(tensor_options, std::as_writable_bytes(std::span { tensor }));
+
+    assert(near(tensor, { 0, 0, 0, 1, gray_64, gray_64, gray_64, 0, gray_128, gray_128, gray_128, 1, 1, 1, 1, 1 }));
+
+    // Each plane gets the scale and offset of its own channel.
+    tensor_options.channels = 3;
+    tensor_options.layout = utils::typings::TensorLayout::CHW;
+    tensor_options.scale = { 2.0f, 2.0f, 2.0f, 1.0f };
+    tensor_options.offset = { -1.0f, 0.0f, 1.0f, 0.0f };
+    tensor.resize(grayscale_trns_decoder.getImageTensorSize(tensor_options) / sizeof(float));
+
+    grayscale_trns_decoder.convertRawDataToTensor(tensor_options, std::as_writable_bytes(std::span { tensor }));
+
+    assert
+    (
+        near
+        (
+            tensor,
+            {
+                -1, 2 * gray_64 - 1, 2 * gray_128 - 1, 1,
+                0, 2 * gray_64, 2 * gray_128, 2,
+                1, 2 * gray_64 + 1, 2 * gray_128 + 1, 3
+            }
+        )
+    );
+
+    // Half precision elements are rounded to the nearest even.
+    const std::array<std::pair<utils::typings::TensorDataType, std::array<uint16_t, 4>>, 2> half_data_types
+    {{
+        { utils::typings::TensorDataType::FLOAT16, { 0, 0x3404, 0x3804, 0x3C00 } },
+        { utils::typings::TensorDataType::BFLOAT16, { 0, 0x3E81, 0x3F01, 0x3F80 } }
+    }};
+    std::vector<uint16_t> half_tensor {};
+    tensor_options = {};
+
+    for (const auto& [data_type, expected] : half_data_types)
+    {
+        tensor_options.data_type = data_type;
+        half_tensor.resize(grayscale_trns_decoder.getImageTensorSize(tensor_options) / sizeof(uint16_t));
+
+        grayscale_trns_decoder.convertRawDataToTensor(tensor_options, std::as_writable_bytes(std::span { half_tensor }));
+
+        for (std::size_t element = 0; element < half_tensor.size(); ++element)
+        {
+            assert(half_tensor[element] == expected[element / 3]);
+        }
+    }
+
+    // 16 bit samples keep their precision, whichever byte order they're in.
+    tensor_options = {};
+    tensor_options.channels = 4;
+    tensor_options.layout = utils::typings::TensorLayout::CHW;
+
+    for (const bool swap_bytes_order : { false, true })
+    {
+        image_decoder::ImageDecoder tensor_decoder("../../input-images/rgb_16_bit_depth_trns.png");
+
+        if (swap_bytes_order) { tensor_decoder.swapBytesOrder(); }
+
+        tensor.resize(tensor_decoder.getImageTensorSize(tensor_options) / sizeof(float));
+        tensor_decoder.convertRawDataToTensor(tensor_options, std::as_writable_bytes(std::span { tensor }));
+
+        assert(near(tensor, { 0x1234 / 65535.0f, 1, 0x5678 / 65535.0f, 0, 0x9ABC / 65535.0f, 0, 0, 1 }));
+    }
+
+    // The 4x1 image is cropped to its two middle columns and padded above and below, the padding written as is.
+    tensor_options = {};
+    tensor_options.width = 2;
+    tensor_options.height = 3;
+    tensor_options.fit = utils::typings::TensorFit::CENTER_CROP_OR_PAD;
+    tensor_options.pad_value = -5.0f;
+    tensor.resize(grayscale_trns_decoder.getImageTensorSize(tensor_options) / sizeof(float));
+
+    grayscale_trns_decoder.convertRawDataToTensor(tensor_options, std::as_writable_bytes(std::span { tensor }));
+
+    assert
+    (
+        near
+        (
+            tensor,
+            {
+                -5, -5, -5, -5, -5, -5,
+                gray_64, gray_64, gray_64, gray_128, gray_128, gray_128,
+                -5, -5, -5, -5, -5, -5
+            }
+        )
+    );
+
+    // And padded on both sides of each plane, the padding converted to half precision too.
+    tensor_options.data_type = utils::typings::TensorDataType::FLOAT16;
+    tensor_options.layout = utils::typings::TensorLayout::CHW;
+    tensor_options.channels = 4;
+    tensor_options.width = 6;
+    tensor_options.height = 1;
+    tensor_options.pad_value = -1.0f;
+    half_tensor.resize(grayscale_trns_decoder.getImageTensorSize(tensor_options) / sizeof(uint16_t));
+
+    grayscale_trns_decoder.convertRawDataToTensor(tensor_options, std::as_writable_bytes(std::span { half_tensor }));
+
+    assert
+    (
+        std::ranges::equal
+        (
+            half_tensor,
+            std::initializer_list<uint16_t>
+            {
+                0xBC00, 0, 0x3404, 0x3804, 0x3C00, 0xBC00,
+                0xBC00, 0, 0x3404, 0x3804, 0x3C00, 0xBC00,
+                0xBC00, 0, 0x3404, 0x3804, 0x3C00, 0xBC00,
+                0xBC00, 0x3C00, 0, 0x3C00, 0x3C00, 0xBC00
+            }
+        )
+    );
+
+    const auto samples_equal
+    {
+        [](utils::typings::BytesView bytes, std::initializer_list<uint16_t> expected)
+        {
+            std::vector<uint16_t> samples(bytes.size() / sizeof(uint16_t));
+
+            std::memcpy(samples.data(), bytes.data(), bytes.size());
+
+            return std::ranges::equal(samples, expected);
+        }
+    };
+
+    // Decoded in the host's byte order, 16 bit samples read back as integers, and so do the caches made from them.
+    utils::typings::DecodeOptions native_options {};
+    native_options.byte_order = utils::typings::ByteOrder::NATIVE;
+
+    image_decoder::ImageDecoder native_decoder("../../input-images/rgb_16_bit_depth_trns.png", native_options);
+
+    assert(native_decoder.getImageByteOrder() == utils::typings::ByteOrder::NATIVE);
+    assert(samples_equal(native_decoder.getRawDataView(), { 0x1234, 0x5678, 0x9ABC, 0xFFFF, 0, 0 }));
+    assert(samples_equal(native_decoder.getRawDataRGBView(), { 0x1234, 0x5678, 0x9ABC, 0xFFFF, 0, 0 }));
+    assert(samples_equal(native_decoder.getRawDataRGBAView(), { 0x1234, 0x5678, 0x9ABC, 0, 0xFFFF, 0, 0, 0xFFFF }));
+
+    // Swapping swaps the caches already filled along, in place, twice goes back to the decoded order,
+    // and setting the current order again is a no-op.
+    const auto copy
+    {
+        [](utils::typings::BytesView bytes) { return std::vector<utils::typings::Byte>(bytes.begin(), bytes.end()); }
+    };
+    const auto swapped
+    {
+        [&copy](utils::typings::BytesView bytes)
+        {
+            std::vector<utils::typings::Byte> swapped { copy(bytes) };
+
+            for (std::size_t i = 0; i + 1 < swapped.size(); i += 2) { std::swap(swapped[i], swapped[i + 1]); }
+
+            return swapped;
+        }
+    };
+
+    const std::array<std::filesystem::path, 2> swapped_files
+    {
+        "../../input-images/grayscale_16_bit_depth.png",
+        "../../input-images/rgb_16_bit_depth_trns.png"
+    };
+
+    for (const auto& filepath : swapped_files)
+    {
+        image_decoder::ImageDecoder swapped_decoder(filepath);
+        const std::vector<utils::typings::Byte> big_raw_data { copy(swapped_decoder.getRawDataView()) };
+        const std::vector<utils::typings::Byte> big_rgb { copy(swapped_decoder.getRawDataRGBView()) };
+        const std::vector<utils::typings::Byte> big_rgba { copy(swapped_decoder.getRawDataRGBAView()) };
+        const utils::MemoryStats filled_stats { swapped_decoder.getMemoryStats() };
+
+        const auto byte_order_is
+        {
+            [&](utils::typings::ByteOrder byte_order)
+            {
+                const bool big { byte_order == utils::typings::ByteOrder::BIG };
+
+                return swapped_decoder.getImageByteOrder() == byte_order
+                    and std::ranges::equal(swapped_decoder.getRawDataView(), big ? big_raw_data : swapped(big_raw_data))
+                    and std::ranges::equal(swapped_decoder.getRawDataRGBView(), big ? big_rgb : swapped(big_rgb))
+                    and std::ranges::equal(swapped_decoder.getRawDataRGBAView(), big ? big_rgba : swapped(big_rgba));
+            }
+        };
+
+        swapped_decoder.swapBytesOrder();
+        assert(byte_order_is(utils::typings::ByteOrder::LITTLE));
+
+        swapped_decoder.swapBytesOrder();
+        assert(byte_order_is(utils::typings::ByteOrder::BIG));
+
+        swapped_decoder.setImageByteOrder(utils::typings::ByteOrder::LITTLE);
+        swapped_decoder.setImageByteOrder(utils::typings::ByteOrder::LITTLE);
+        assert(byte_order_is(utils::typings::ByteOrder::LITTLE));
+
+        for (const auto kind : { utils::BufferKind::RGB_CACHE, utils::BufferKind::RGBA_CACHE })
+        {
+            assert
+            (
+                swapped_decoder.getMemoryStats().buffers[static_cast<std::size_t>(kind)].allocations
+                    == filled_stats.buffers[static_cast<std::size_t>(kind)].allocations
+            );
+        }
+    }
+
+    // Large buffers are split across threads, the last chunk taking the remainder, every pair ends up swapped once.
+    std::vector<utils::typings::Byte> pairs(3 * utils::kernels::MIN_BYTES_PER_THREAD + 6);
+
+    for (std::size_t i = 0; i < pairs.size(); ++i) { pairs[i] = static_cast<utils::typings::Byte>(i % 251); }
+
+    utils::kernels::swapBytePairsParallel(pairs.data(), pairs.size(), 3);
+
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+    {
+        assert(pairs[i] == static_cast<utils::typings::Byte>((i ^ 1) % 251));
+    }
+
+    // Threads asking a shared decoder for the same caches at once see them filled a single time, with the same data.
+    image_decoder::ImageDecoder shared_decoder("../../input-images/grayscale_16_bit_depth.png");
+    image_decoder::ImageDecoder reference_decoder("../../input-images/grayscale_16_bit_depth.png");
+    constexpr std::size_t number_of_readers { 8 };
+    std::array<utils::typings::BytesView, number_of_readers> rgb_views {};
+    std::array<utils::typings::BytesView, number_of_readers> rgba_views {};
+    std::latch readers_ready { number_of_readers };
+
+    {
+        std::vector<std::jthread> readers;
+
+        for (std::size_t reader = 0; reader < number_of_readers; ++reader)
+        {
+            readers.emplace_back
+            (
+                [&, reader]
+                {
+                    readers_ready.arrive_and_wait();
+
+                    // Half of them ask for rgba first, so both caches are filled while the other one is.
+                    if (reader % 2)
+                    {
+                        rgba_views[reader] = shared_decoder.getRawDataRGBAView();
+                        rgb_views[reader] = shared_decoder.getRawDataRGBView();
+                    } else
+                    {
+                        rgb_views[reader] = shared_decoder.getRawDataRGBView();
+                        rgba_views[reader] = shared_decoder.getRawDataRGBAView();
+                    }
+                }
+            );
+        }
+    }
+
+    const utils::MemoryStats shared_stats { shared_decoder.getMemoryStats() };
+
+    assert(shared_stats.buffers[static_cast<std::size_t>(utils::BufferKind::RGB_CACHE)].allocations == 1);
+    assert(shared_stats.buffers[static_cast<std::size_t>(utils::BufferKind::RGBA_CACHE)].allocations == 1);
+
+    for (std::size_t reader = 0; reader < number_of_readers; ++reader)
+    {
+        assert(rgb_views[reader].data() == rgb_views.front().data());
+        assert(rgba_views[reader].data() == rgba_views.front().data());
+        assert(std::ranges::equal(rgb_views[reader], reference_decoder.getRawDataRGBView()));
+        assert(std::ranges::equal(rgba_views[reader], reference_decoder.getRawDataRGBAView()));
+    }
+
+    /*!
+     * An executor that never runs its tasks doesn't stall a batch, the calling thread decodes every image,
+     * and the tasks run once the batch returned find nothing left to do.
+    */
+    std::vector<std::function<void()>> stalled_tasks;
+    utils::typings::TensorOptions batch_options {};
+    batch_options.width = 16;
+    batch_options.height = 16;
+    batch_options.fit = utils::typings::TensorFit::CENTER_CROP_OR_PAD;
+
+    const std::span<const std::filesystem::path> batch_files { files.data(), 4 };
+    const uint64_t slice_size { image_decoder::ImageDecoder::getTensorBatchSize(1, batch_options) };
+    std::vector<utils::typings::Byte> batch(slice_size * batch_files.size());
+
+    image_decoder::ImageDecoder::decodeTensorBatch
+    (
+        batch_files,
+        batch_options,
+        batch,
+        {},
+        [&stalled_tasks](std::function<void()> task) { stalled_tasks.push_back(std::move(task)); }
+    );
+
+    assert(stalled_tasks.size() == batch_files.size() - 1);
+
+    for (std::size_t image = 0; image < batch_files.size(); ++image)
+    {
+        image_decoder::ImageDecoder tensor_decoder(batch_files[image]);
+        std::vector<utils::typings::Byte> tensor(slice_size);
+
+        tensor_decoder.convertRawDataToTensor(batch_options, tensor);
+
+        assert(std::ranges::equal(tensor, std::span { batch }.subspan(image * slice_size, slice_size)));
+    }
+
+    for (const auto& task : stalled_tasks) { task(); }
+
     return EXIT_SUCCESS;
 }